@@ -0,0 +1,53 @@
+// Copyright (c) 2016-2017 The Zerobitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "crypto/Lyra2Z/Lyra2.h"
+#include "crypto/Lyra2Z/Lyra2Z.h"
+
+#include <string.h>
+#include <vector>
+
+/* Hashes 1000 headers per iteration with the given row implementation */
+static void Lyra2ZHeaders(benchmark::State& state, const char* impl)
+{
+    std::vector<unsigned char> in(80, 0);
+    unsigned char out[32];
+    if (!lyra2_select_impl(impl)) {
+        // Not supported by this CPU, report a single empty run
+        while (state.KeepRunning()) {}
+        return;
+    }
+    while (state.KeepRunning()) {
+        for (uint32_t nNonce = 0; nNonce < 1000; nNonce++) {
+            memcpy(&in[76], &nNonce, sizeof(nNonce));
+            lyra2z_hash((const char*)&in[0], (char*)out);
+        }
+    }
+    lyra2_detect_simd();
+}
+
+/* Same 1000 headers, hashed with lyra2z_hash_batch as the miner does */
+static void Lyra2ZBatch(benchmark::State& state)
+{
+    std::vector<unsigned char> in(80 * 1000, 0);
+    std::vector<unsigned char> out(32 * 1000);
+    for (uint32_t nNonce = 0; nNonce < 1000; nNonce++)
+        memcpy(&in[nNonce * 80 + 76], &nNonce, sizeof(nNonce));
+    while (state.KeepRunning()) {
+        lyra2z_hash_batch((const char*)&in[0], 1000, (char*)&out[0]);
+    }
+}
+
+static void Lyra2ZGeneric(benchmark::State& state) { Lyra2ZHeaders(state, "generic"); }
+static void Lyra2ZSSE2(benchmark::State& state) { Lyra2ZHeaders(state, "sse2"); }
+static void Lyra2ZAVX2(benchmark::State& state) { Lyra2ZHeaders(state, "avx2"); }
+static void Lyra2ZAVX512(benchmark::State& state) { Lyra2ZHeaders(state, "avx512"); }
+
+BENCHMARK(Lyra2ZGeneric);
+BENCHMARK(Lyra2ZSSE2);
+BENCHMARK(Lyra2ZAVX2);
+BENCHMARK(Lyra2ZAVX512);
+BENCHMARK(Lyra2ZBatch);
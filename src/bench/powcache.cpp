@@ -0,0 +1,66 @@
+// Copyright (c) 2016-2017 The Zerobitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "hash.h"
+#include "primitives/powcache.h"
+
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+
+static const int POWCACHE_THREADS = 4;
+static const int POWCACHE_KEYS = 4096;
+
+static std::vector<uint256> MakeKeys(uint32_t nSeed)
+{
+    std::vector<uint256> keys;
+    keys.reserve(POWCACHE_KEYS);
+    for (int i = 0; i < POWCACHE_KEYS; i++)
+        keys.push_back(SerializeHash(std::make_pair(nSeed, i)));
+    return keys;
+}
+
+static void LookupAll(CPoWHashCache* cache, const std::vector<uint256>* keys, int nOffset)
+{
+    uint256 hashPoW;
+    for (size_t i = 0; i < keys->size(); i++) {
+        const uint256& key = (*keys)[(i + nOffset) % keys->size()];
+        if (!cache->Get(key, 1, hashPoW))
+            cache->Insert(key, 1, key);
+    }
+}
+
+static void RunThreads(CPoWHashCache& cache, const std::vector<uint256>& keys)
+{
+    boost::thread_group threads;
+    for (int i = 0; i < POWCACHE_THREADS; i++)
+        threads.create_thread(boost::bind(&LookupAll, &cache, &keys, i * POWCACHE_KEYS / POWCACHE_THREADS));
+    threads.join_all();
+}
+
+// All lookups hit: measures lock contention between concurrent readers
+static void PoWCacheHot(benchmark::State& state)
+{
+    CPoWHashCache cache;
+    std::vector<uint256> keys = MakeKeys(0);
+    LookupAll(&cache, &keys, 0);
+    while (state.KeepRunning()) {
+        RunThreads(cache, keys);
+    }
+}
+
+// Every lookup misses and inserts into a cache that only holds a fraction of the keys
+static void PoWCacheCold(benchmark::State& state)
+{
+    CPoWHashCache cache(64 << 10);
+    std::vector<uint256> keys = MakeKeys(1);
+    while (state.KeepRunning()) {
+        RunThreads(cache, keys);
+    }
+}
+
+BENCHMARK(PoWCacheHot);
+BENCHMARK(PoWCacheCold);
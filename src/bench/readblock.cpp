@@ -0,0 +1,86 @@
+// Copyright (c) 2016-2017 The Zerobitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "arith_uint256.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "main.h"
+#include "pow.h"
+#include "primitives/powcache.h"
+#include "random.h"
+#include "util.h"
+
+#include <boost/filesystem.hpp>
+
+// First height past the precomputed table, hashed with Lyra2Z
+static const int READBLOCK_HEIGHT = 20500;
+
+/** Writes a regtest block meeting the minimum difficulty to a scratch datadir */
+class ReadBlockSetup
+{
+public:
+    boost::filesystem::path pathTemp;
+    CBlock block;
+    CBlockIndex* pindex;
+
+    ReadBlockSetup()
+    {
+        SelectParams(CBaseChainParams::REGTEST);
+        pathTemp = boost::filesystem::temp_directory_path() / strprintf("bench_readblock_%lu_%i", (unsigned long)GetTime(), (int)GetRand(100000));
+        boost::filesystem::create_directories(pathTemp);
+        mapArgs["-datadir"] = pathTemp.string();
+        ClearDatadirCache();
+
+        const Consensus::Params& consensusParams = Params().GetConsensus();
+        block = Params().GenesisBlock();
+        block.nBits = UintToArith256(consensusParams.powLimit).GetCompact();
+        while (!CheckProofOfWork(block.GetPoWHash(READBLOCK_HEIGHT), block.nBits, consensusParams))
+            block.nNonce++;
+
+        CDiskBlockPos pos(0, 0);
+        WriteBlockToDisk(block, pos, Params().MessageStart());
+        pindex = new CBlockIndex(block);
+        pindex->phashBlock = new uint256(block.GetHash());
+        pindex->nHeight = READBLOCK_HEIGHT;
+        pindex->nFile = pos.nFile;
+        pindex->nDataPos = pos.nPos;
+        pindex->nStatus = BLOCK_HAVE_DATA;
+        pindex->RaiseValidity(BLOCK_VALID_SCRIPTS);
+    }
+
+    ~ReadBlockSetup()
+    {
+        delete pindex->phashBlock;
+        delete pindex;
+        ClearDatadirCache();
+        mapArgs.erase("-datadir");
+        boost::filesystem::remove_all(pathTemp);
+    }
+};
+
+// Fully validated block served to peers or RPC: header hash compared against the index
+static void ReadBlockTrusted(benchmark::State& state)
+{
+    ReadBlockSetup setup;
+    CBlock block;
+    while (state.KeepRunning()) {
+        assert(ReadBlockFromDisk(block, setup.pindex, Params().GetConsensus()));
+    }
+}
+
+// Reindex/import style read: Lyra2Z recomputed for every block
+static void ReadBlockFullCheck(benchmark::State& state)
+{
+    ReadBlockSetup setup;
+    CBlock block;
+    while (state.KeepRunning()) {
+        powHashCache.Clear();
+        assert(ReadBlockFromDisk(block, setup.pindex, Params().GetConsensus(), true));
+    }
+}
+
+BENCHMARK(ReadBlockTrusted);
+BENCHMARK(ReadBlockFullCheck);
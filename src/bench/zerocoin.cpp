@@ -0,0 +1,340 @@
+// Copyright (c) 2016-2017 The Zerobitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "libzerocoin/Zerocoin.h"
+#include "main.h"
+#include "random.h"
+#include "zerocoin.h"
+#include "zerocoin_params.h"
+
+static const libzerocoin::Params& BenchParams()
+{
+    return *ZerocoinParams();
+}
+
+/* g_n^e mod N with an exponent the size of the accumulator proof responses */
+static void ZerocoinPowModQRN(benchmark::State& state)
+{
+    const libzerocoin::AccumulatorAndProofParams& acc = BenchParams().accumulatorParams;
+    CBigNum e = CBigNum::randBignum(acc.accumulatorModulus * CBigNum(2).pow(acc.k_prime + acc.k_dprime));
+    while (state.KeepRunning()) {
+        acc.accumulatorQRNCommitmentGroup.g.pow_mod(e, acc.accumulatorModulus);
+    }
+}
+
+static void ZerocoinFixedBaseQRN(benchmark::State& state)
+{
+    const libzerocoin::AccumulatorAndProofParams& acc = BenchParams().accumulatorParams;
+    CBigNum e = CBigNum::randBignum(acc.accumulatorModulus * CBigNum(2).pow(acc.k_prime + acc.k_dprime));
+    while (state.KeepRunning()) {
+        acc.accumulatorQRNCommitmentGroup.powG(e, acc.accumulatorModulus);
+    }
+}
+
+/* h^e mod p in the serial number signature group, one per SoK iteration */
+static void ZerocoinPowModSoK(benchmark::State& state)
+{
+    const libzerocoin::IntegerGroupParams& sok = BenchParams().serialNumberSoKCommitmentGroup;
+    CBigNum e = CBigNum::randBignum(sok.groupOrder);
+    while (state.KeepRunning()) {
+        sok.h.pow_mod(e, sok.modulus);
+    }
+}
+
+static void ZerocoinFixedBaseSoK(benchmark::State& state)
+{
+    const libzerocoin::IntegerGroupParams& sok = BenchParams().serialNumberSoKCommitmentGroup;
+    CBigNum e = CBigNum::randBignum(sok.groupOrder);
+    while (state.KeepRunning()) {
+        sok.powH(e, sok.modulus);
+    }
+}
+
+/* A three-term product mod N as in the accumulator proof check values */
+static void ProductBasesExponents(std::vector<CBigNum>& bases, std::vector<CBigNum>& exponents)
+{
+    const libzerocoin::AccumulatorAndProofParams& acc = BenchParams().accumulatorParams;
+    for (int i = 0; i < 3; i++) {
+        bases.push_back(CBigNum::randBignum(acc.accumulatorModulus));
+        exponents.push_back(CBigNum::randBignum(acc.accumulatorModulus * CBigNum(2).pow(acc.k_prime + acc.k_dprime)));
+    }
+}
+
+static void ZerocoinPowModProduct(benchmark::State& state)
+{
+    const CBigNum& N = BenchParams().accumulatorParams.accumulatorModulus;
+    std::vector<CBigNum> bases, exponents;
+    ProductBasesExponents(bases, exponents);
+    while (state.KeepRunning()) {
+        (bases[0].pow_mod(exponents[0], N) * bases[1].pow_mod(exponents[1], N) * bases[2].pow_mod(exponents[2], N)) % N;
+    }
+}
+
+static void ZerocoinMultiPowMod(benchmark::State& state)
+{
+    const CBigNum& N = BenchParams().accumulatorParams.accumulatorModulus;
+    std::vector<CBigNum> bases, exponents;
+    ProductBasesExponents(bases, exponents);
+    while (state.KeepRunning()) {
+        CBigNum::multi_pow_mod(bases, exponents, N);
+    }
+}
+
+/* Accumulating one coin: value^coin mod N, with and without the cached Montgomery context */
+static void ZerocoinAccumulatePowMod(benchmark::State& state)
+{
+    const libzerocoin::AccumulatorAndProofParams& acc = BenchParams().accumulatorParams;
+    CBigNum value = acc.accumulatorBase;
+    CBigNum coin = CBigNum::randBignum(acc.maxCoinValue);
+    while (state.KeepRunning()) {
+        value = value.pow_mod(coin, acc.accumulatorModulus);
+    }
+}
+
+static void ZerocoinAccumulateMont(benchmark::State& state)
+{
+    const libzerocoin::AccumulatorAndProofParams& acc = BenchParams().accumulatorParams;
+    CBigNum value = acc.accumulatorBase;
+    CBigNum coin = CBigNum::randBignum(acc.maxCoinValue);
+    while (state.KeepRunning()) {
+        value = acc.accumulatorQRNCommitmentGroup.powMod(value, coin, acc.accumulatorModulus);
+    }
+}
+
+/* The parameter prefix of every proof hash, serialized or from the precomputed midstate */
+static void ZerocoinParamsHash(benchmark::State& state)
+{
+    const libzerocoin::Params& params = BenchParams();
+    while (state.KeepRunning()) {
+        CHashWriter hasher(0, 0);
+        hasher << params;
+        hasher.GetHash();
+    }
+}
+
+static void ZerocoinParamsTranscript(benchmark::State& state)
+{
+    const libzerocoin::Params& params = BenchParams();
+    while (state.KeepRunning()) {
+        CHashWriter hasher = params.getTranscript();
+        hasher.GetHash();
+    }
+}
+
+/* Witness of a mint at the start of a group of a few hundred coins minted one per block */
+static const int nBenchWitnessCoins = 300;
+
+static CZerocoinState* BenchWitnessState(CBigNum& mintedCoin)
+{
+    static CZerocoinState *zerocoinState = NULL;
+    static CBigNum firstCoin;
+    if (zerocoinState == NULL) {
+        const libzerocoin::Params& params = BenchParams();
+        const std::pair<int,int> denomAndId = std::make_pair((int)libzerocoin::ZQ_LOVELACE, 1);
+        libzerocoin::Accumulator accumulator(&params, libzerocoin::ZQ_LOVELACE);
+        zerocoinState = new CZerocoinState();
+        CBlockIndex *pprev = NULL;
+        for (int i = 0; i < nBenchWitnessCoins; i++) {
+            CBlockIndex *pindex = new CBlockIndex();
+            pindex->phashBlock = &mapBlockIndex.insert(std::make_pair(GetRandHash(), pindex)).first->first;
+            pindex->pprev = pprev;
+            pindex->nHeight = i + 1;
+            CBigNum pubCoin = CBigNum::randBignum(params.accumulatorParams.maxCoinValue);
+            accumulator += libzerocoin::PublicCoin(&params, pubCoin, libzerocoin::ZQ_LOVELACE);
+            CZerocoinBlockInfo info;
+            info.mintedPubCoins[denomAndId].push_back(pubCoin);
+            info.accumulatorChanges[denomAndId] = std::make_pair(accumulator.getValue(), 1);
+            ZerocoinSetBlockInfo(pindex, info);
+            zerocoinState->AddBlock(pindex);
+            if (i == 0)
+                firstCoin = pubCoin;
+            pprev = pindex;
+        }
+    }
+    mintedCoin = firstCoin;
+    return zerocoinState;
+}
+
+/* What a spend used to do: accumulate every later coin of the group */
+static void ZerocoinWitnessFromMint(benchmark::State& state)
+{
+    CBigNum pubCoin;
+    CZerocoinState *zerocoinState = BenchWitnessState(pubCoin);
+    while (state.KeepRunning()) {
+        CBigNum witnessValue;
+        uint256 witnessBlockHash;
+        zerocoinState->AdvanceWitness(INT_MAX, libzerocoin::ZQ_LOVELACE, 1, pubCoin, witnessValue, witnessBlockHash);
+    }
+}
+
+/* A spend with the wallet's witness already advanced to the tip */
+static void ZerocoinWitnessCached(benchmark::State& state)
+{
+    CBigNum pubCoin;
+    CZerocoinState *zerocoinState = BenchWitnessState(pubCoin);
+    CBigNum cachedValue;
+    uint256 cachedBlockHash;
+    zerocoinState->AdvanceWitness(INT_MAX, libzerocoin::ZQ_LOVELACE, 1, pubCoin, cachedValue, cachedBlockHash);
+    while (state.KeepRunning()) {
+        CBigNum witnessValue = cachedValue;
+        uint256 witnessBlockHash = cachedBlockHash;
+        zerocoinState->AdvanceWitness(INT_MAX, libzerocoin::ZQ_LOVELACE, 1, pubCoin, witnessValue, witnessBlockHash);
+    }
+}
+
+/* Spent serial and minted coin lookups in the zerocoin state, and sorting the mints of a block */
+static const int nBenchLookupCoins = 1000;
+
+static void BenchLookupState(CZerocoinState& zerocoinState, std::vector<CBigNum>& serials, std::vector<CBigNum>& pubCoins)
+{
+    const libzerocoin::Params& params = BenchParams();
+    CBlockIndex *pindex = new CBlockIndex();
+    pindex->phashBlock = &mapBlockIndex.insert(std::make_pair(GetRandHash(), pindex)).first->first;
+    pindex->nHeight = ZC_CHECK_BUG_FIXED_AT_BLOCK + 1;
+    for (int i = 0; i < nBenchLookupCoins; i++) {
+        serials.push_back(CBigNum::randBignum(params.coinCommitmentGroup.groupOrder));
+        pubCoins.push_back(CBigNum::randBignum(params.accumulatorParams.maxCoinValue));
+        CBigNum previousAccValue;
+        zerocoinState.AddMint(pindex, libzerocoin::ZQ_LOVELACE, pubCoins.back(), previousAccValue);
+        zerocoinState.AddSpend(serials.back());
+    }
+}
+
+static void ZerocoinSerialLookup(benchmark::State& state)
+{
+    CZerocoinState zerocoinState;
+    std::vector<CBigNum> serials, pubCoins;
+    BenchLookupState(zerocoinState, serials, pubCoins);
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        zerocoinState.IsUsedCoinSerial(serials[i++ % serials.size()]);
+    }
+}
+
+static void ZerocoinHasCoin(benchmark::State& state)
+{
+    CZerocoinState zerocoinState;
+    std::vector<CBigNum> serials, pubCoins;
+    BenchLookupState(zerocoinState, serials, pubCoins);
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        zerocoinState.HasCoin(pubCoins[i++ % pubCoins.size()]);
+    }
+}
+
+static void ZerocoinCoinHash(benchmark::State& state)
+{
+    const libzerocoin::Params& params = BenchParams();
+    CZerocoinState::CBigNumHasher hasher;
+    CBigNum pubCoin = CBigNum::randBignum(params.accumulatorParams.maxCoinValue);
+    while (state.KeepRunning()) {
+        hasher(pubCoin);
+    }
+}
+
+static void ZerocoinSortMints(benchmark::State& state)
+{
+    const libzerocoin::Params& params = BenchParams();
+    CZerocoinTxInfo unsorted;
+    for (int i = 0; i < 100; i++)
+        unsorted.mints.push_back(std::make_pair((int)libzerocoin::ZQ_LOVELACE, CBigNum::randBignum(params.accumulatorParams.maxCoinValue)));
+    while (state.KeepRunning()) {
+        CZerocoinTxInfo zerocoinTxInfo;
+        zerocoinTxInfo.mints = unsorted.mints;
+        zerocoinTxInfo.Complete();
+    }
+}
+
+/* Validation of a minted coin, with the primality test and as remembered from a previous validation */
+static void ZerocoinPubCoinIsPrime(benchmark::State& state)
+{
+    const libzerocoin::Params& params = BenchParams();
+    static libzerocoin::PrivateCoin coin(&params, libzerocoin::ZQ_LOVELACE);
+    while (state.KeepRunning()) {
+        assert(coin.getPublicCoin().getValue().isPrime(params.zkp_iterations));
+    }
+}
+
+static void ZerocoinPubCoinValidate(benchmark::State& state)
+{
+    static libzerocoin::PrivateCoin coin(ZerocoinParams(), libzerocoin::ZQ_LOVELACE);
+    while (state.KeepRunning()) {
+        assert(ZerocoinValidatePubCoin(coin.getPublicCoin()));
+    }
+}
+
+/* Spend verification, one proof at a time and in batches of a block's worth of spends */
+static const libzerocoin::CoinSpend& BenchSpend(libzerocoin::Accumulator& accumulator, libzerocoin::SpendMetaData& metaData)
+{
+    static libzerocoin::CoinSpend *spend = NULL;
+    static libzerocoin::Accumulator *spendAccumulator = NULL;
+    static libzerocoin::SpendMetaData spendMetaData(1, uint256());
+    if (spend == NULL) {
+        const libzerocoin::Params& params = BenchParams();
+        libzerocoin::PrivateCoin coin(&params, libzerocoin::ZQ_LOVELACE);
+        spendAccumulator = new libzerocoin::Accumulator(&params, libzerocoin::ZQ_LOVELACE);
+        libzerocoin::AccumulatorWitness witness(&params, *spendAccumulator, coin.getPublicCoin());
+        *spendAccumulator += coin.getPublicCoin();
+        spendMetaData = libzerocoin::SpendMetaData(1, GetRandHash());
+        spend = new libzerocoin::CoinSpend(&params, coin, *spendAccumulator, witness, spendMetaData);
+    }
+    accumulator = *spendAccumulator;
+    metaData = spendMetaData;
+    return *spend;
+}
+
+static void ZerocoinVerifySpend(benchmark::State& state)
+{
+    libzerocoin::Accumulator accumulator(&BenchParams());
+    libzerocoin::SpendMetaData metaData(1, uint256());
+    const libzerocoin::CoinSpend& spend = BenchSpend(accumulator, metaData);
+    while (state.KeepRunning()) {
+        assert(spend.Verify(accumulator, metaData));
+    }
+}
+
+/* The same proof queued nSpends times, the cost does not depend on the coin */
+static void BatchVerifySpends(benchmark::State& state, int nSpends)
+{
+    libzerocoin::Accumulator accumulator(&BenchParams());
+    libzerocoin::SpendMetaData metaData(1, uint256());
+    const libzerocoin::CoinSpend& spend = BenchSpend(accumulator, metaData);
+    libzerocoin::BatchVerifier batch(&BenchParams());
+    for (int i = 0; i < nSpends; i++)
+        batch.Add(spend, accumulator, metaData);
+    while (state.KeepRunning()) {
+        assert(batch.Verify());
+    }
+}
+
+static void ZerocoinBatchVerify1(benchmark::State& state) { BatchVerifySpends(state, 1); }
+static void ZerocoinBatchVerify4(benchmark::State& state) { BatchVerifySpends(state, 4); }
+static void ZerocoinBatchVerify16(benchmark::State& state) { BatchVerifySpends(state, 16); }
+static void ZerocoinBatchVerify64(benchmark::State& state) { BatchVerifySpends(state, 64); }
+
+BENCHMARK(ZerocoinPowModQRN);
+BENCHMARK(ZerocoinFixedBaseQRN);
+BENCHMARK(ZerocoinPowModSoK);
+BENCHMARK(ZerocoinFixedBaseSoK);
+BENCHMARK(ZerocoinPowModProduct);
+BENCHMARK(ZerocoinMultiPowMod);
+BENCHMARK(ZerocoinAccumulatePowMod);
+BENCHMARK(ZerocoinAccumulateMont);
+BENCHMARK(ZerocoinParamsHash);
+BENCHMARK(ZerocoinParamsTranscript);
+BENCHMARK(ZerocoinWitnessFromMint);
+BENCHMARK(ZerocoinWitnessCached);
+BENCHMARK(ZerocoinSerialLookup);
+BENCHMARK(ZerocoinHasCoin);
+BENCHMARK(ZerocoinCoinHash);
+BENCHMARK(ZerocoinSortMints);
+BENCHMARK(ZerocoinPubCoinIsPrime);
+BENCHMARK(ZerocoinPubCoinValidate);
+BENCHMARK(ZerocoinVerifySpend);
+BENCHMARK(ZerocoinBatchVerify1);
+BENCHMARK(ZerocoinBatchVerify4);
+BENCHMARK(ZerocoinBatchVerify16);
+BENCHMARK(ZerocoinBatchVerify64);
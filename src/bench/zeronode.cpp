@@ -0,0 +1,57 @@
+// Copyright (c) 2016-2017 The Zerobitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "hash.h"
+#include "zeronodeman.h"
+
+static void FillZeronodes(CZeronodeMan& man, int nCount)
+{
+    CPubKey pubKey;
+    for (int i = 0; i < nCount; i++) {
+        CTxIn vin(COutPoint(SerializeHash(i), i % 4));
+        CZeronode mn(CService(), vin, pubKey, pubKey, PROTOCOL_VERSION);
+        man.Add(mn);
+    }
+}
+
+// Scores of every zeronode for a new block hash: what each rank query used to pay
+static void ZeronodeScores(benchmark::State& state, int nCount)
+{
+    CZeronodeMan man;
+    FillZeronodes(man, nCount);
+    uint32_t n = 0;
+    while (state.KeepRunning()) {
+        man.GetZeronodeScores(SerializeHash(n++));
+    }
+}
+
+// Rank of a zeronode once the scores of the block hash are cached
+static void ZeronodeScoresCached(benchmark::State& state, int nCount)
+{
+    CZeronodeMan man;
+    FillZeronodes(man, nCount);
+    uint256 blockHash = SerializeHash(0);
+    COutPoint outpoint(SerializeHash(nCount / 2), (nCount / 2) % 4);
+    man.GetZeronodeScores(blockHash);
+    while (state.KeepRunning()) {
+        std::shared_ptr<const CZeronodeScores> pscores = man.GetZeronodeScores(blockHash);
+        int nRank = 0;
+        BOOST_FOREACH(const CZeronodeScores::score_pair_t& s, pscores->vecScores) {
+            nRank++;
+            if (s.second->vin.prevout == outpoint) break;
+        }
+    }
+}
+
+static void ZeronodeScores5k(benchmark::State& state) { ZeronodeScores(state, 5000); }
+static void ZeronodeScores50k(benchmark::State& state) { ZeronodeScores(state, 50000); }
+static void ZeronodeScoresCached5k(benchmark::State& state) { ZeronodeScoresCached(state, 5000); }
+static void ZeronodeScoresCached50k(benchmark::State& state) { ZeronodeScoresCached(state, 50000); }
+
+BENCHMARK(ZeronodeScores5k);
+BENCHMARK(ZeronodeScores50k);
+BENCHMARK(ZeronodeScoresCached5k);
+BENCHMARK(ZeronodeScoresCached50k);
@@ -148,6 +148,45 @@ enum BlockStatus: uint32_t {
     BLOCK_FAILED_MASK        =   96,
 
     BLOCK_OPT_WITNESS       =   128, //!< block data in blk*.data was received with a witness-enforcing client
+
+    BLOCK_HAVE_ZEROCOIN     =   256, //!< zerocoin mints/spends of the block stored in the block tree database
+};
+
+/** Zerocoin mints, accumulator updates and spends of a block, kept apart from its CBlockIndex */
+class CZerocoinBlockInfo
+{
+public:
+    //! Public coin values of mints in this block, ordered by serialized value of public coin
+    //! Maps <denomination,id> to vector of public coins
+    map<pair<int,int>, vector<CBigNum>> mintedPubCoins;
+
+    //! Accumulator updates. Contains only changes made by mints in this block
+    //! Maps <denomination, id> to <accumulator value (CBigNum), number of such mints in this block>
+    map<pair<int,int>, pair<CBigNum,int>> accumulatorChanges;
+
+    //! Values of coin serials spent in this block
+    set<CBigNum> spentSerials;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+        READWRITE(mintedPubCoins);
+        READWRITE(accumulatorChanges);
+        READWRITE(spentSerials);
+    }
+
+    void SetNull()
+    {
+        mintedPubCoins.clear();
+        accumulatorChanges.clear();
+        spentSerials.clear();
+    }
+
+    bool IsNull() const
+    {
+        return mintedPubCoins.empty() && accumulatorChanges.empty() && spentSerials.empty();
+    }
 };
 
 /** The block chain is a tree shaped structure starting with the
@@ -201,20 +240,14 @@ public:
     unsigned int nBits;
     unsigned int nNonce;
 
+    //! Proof-of-work hash of the header, computed once when the header is accepted
+    //! and stored with the index so that it is not recomputed on every startup.
+    //! Null if not known yet (index written by an older version).
+    uint256 hashPoW;
+
     //! (memory only) Sequential id assigned to distinguish order in which blocks are received.
     uint32_t nSequenceId;
 
-    //! Public coin values of mints in this block, ordered by serialized value of public coin
-    //! Maps <denomination,id> to vector of public coins
-    map<pair<int,int>, vector<CBigNum>> mintedPubCoins;
-
-    //! Accumulator updates. Contains only changes made by mints in this block
-    //! Maps <denomination, id> to <accumulator value (CBigNum), number of such mints in this block>
-    map<pair<int,int>, pair<CBigNum,int>> accumulatorChanges;
-	
-    //! Values of coin serials spent in this block
-	set<CBigNum> spentSerials;
-
     void SetNull()
     {
         phashBlock = NULL;
@@ -235,10 +268,7 @@ public:
         nTime          = 0;
         nBits          = 0;
         nNonce         = 0;
-
-        mintedPubCoins.clear();
-        accumulatorChanges.clear();
-        spentSerials.clear();
+        hashPoW.SetNull();
     }
 
     CBlockIndex()
@@ -293,8 +323,10 @@ public:
         return *phashBlock;
     }
 
-    uint256 GetBlockPoWHash() const
+    uint256 GetBlockPoWHash(bool fForceCalc = false) const
     {
+        if (!fForceCalc && !hashPoW.IsNull())
+            return hashPoW;
         return GetBlockHeader().GetPoWHash(nHeight);
     }
 
@@ -368,6 +400,8 @@ class CDiskBlockIndex : public CBlockIndex
 public:
     uint256 hashPrev;
     int nDiskBlockVersion;
+    //! Zerocoin payload of an entry written before ZC_BLOCK_INFO_INDEX_VERSION
+    CZerocoinBlockInfo zerocoinInfo;
 
     CDiskBlockIndex() {
         hashPrev = uint256();
@@ -405,12 +439,15 @@ public:
         READWRITE(nBits);
         READWRITE(nNonce);
 
-        if (!(nType & SER_GETHASH) && nVersion >= ZC_ADVANCED_INDEX_VERSION) {
-            READWRITE(mintedPubCoins);
-		    READWRITE(accumulatorChanges);
-            READWRITE(spentSerials);
+        if (!(nType & SER_GETHASH) && nVersion >= ZC_ADVANCED_INDEX_VERSION && nVersion < ZC_BLOCK_INFO_INDEX_VERSION) {
+            READWRITE(zerocoinInfo.mintedPubCoins);
+		    READWRITE(zerocoinInfo.accumulatorChanges);
+            READWRITE(zerocoinInfo.spentSerials);
 	    }
 
+        if (!(nType & SER_GETHASH) && nVersion >= POW_HASH_INDEX_VERSION)
+            READWRITE(hashPoW);
+
         nDiskBlockVersion = nVersion;
     }
 
@@ -24,65 +24,151 @@
 #include "Lyra2.h"
 #include "Sponge.h"
 
+#if defined(LYRA2_X86_SIMD)
+#include <cpuid.h>
+#endif
+
 /**
- * Executes Lyra2 based on the G function from Blake2b. This version supports salts and passwords
- * whose combined length is smaller than the size of the memory matrix, (i.e., (nRows x nCols x b) bits,
- * where "b" is the underlying sponge's bitrate). In this implementation, the "basil" is composed by all
- * integer parameters (treated as type "unsigned int") in the order they are provided, plus the value
- * of nCols, (i.e., basil = kLen || pwdlen || saltlen || timeCost || nRows || nCols).
- *
- * @param K The derived key to be output by the algorithm
- * @param kLen Desired key length
- * @param pwd User password
- * @param pwdlen Password length
- * @param salt Salt
- * @param saltlen Salt length
- * @param timeCost Parameter to determine the processing time (T)
- * @param nRows Number or rows of the memory matrix (R)
- * @param nCols Number of columns of the memory matrix (C)
- *
- * @return 0 if the key is generated correctly; -1 if there is an error (usually due to lack of memory for allocation)
+ * The reduced-round row operations, which account for nearly all of the work. They are
+ * dispatched through this table so the vectorized versions can be picked at runtime.
+ * Implementations that can run several independent sponges at once also provide batch
+ * versions of the row operations, taking "lanes" states stored back to back and one
+ * row pointer per lane.
  */
-int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols) {
-
-    //============================= Basic variables ============================//
-    int64_t row = 2; //index of row to be processed
-    int64_t prev = 1; //index of prev (last row ever computed/modified)
-    int64_t rowa = 0; //index of row* (a previous row, deterministically picked during Setup and randomly picked while Wandering)
-    int64_t tau; //Time Loop iterator
-    int64_t step = 1; //Visitation step (used during Setup and Wandering phases)
-    int64_t window = 2; //Visitation window (used to define which rows can be revisited during Setup)
-    int64_t gap = 1; //Modifier to the step, assuming the values 1 or -1
-    int64_t i; //auxiliary iteration counter
-    //==========================================================================/
-
-    //========== Initializing the Memory Matrix and pointers to it =============//
-    //Tries to allocate enough space for the whole memory matrix
+struct lyra2_impl {
+    const char *name;
+    void (*squeezeRow0)(uint64_t* state, uint64_t* row, uint64_t nCols);
+    void (*duplexRow1)(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols);
+    void (*duplexRowSetup)(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+    void (*duplexRow)(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+    unsigned int lanes;
+    void (*squeezeRow0Batch)(uint64_t* state, uint64_t *const *row, uint64_t nCols);
+    void (*duplexRow1Batch)(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowOut, uint64_t nCols);
+    void (*duplexRowSetupBatch)(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowInOut, uint64_t *const *rowOut, uint64_t nCols);
+    void (*duplexRowBatch)(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowInOut, uint64_t *const *rowOut, uint64_t nCols);
+};
+
+static const struct lyra2_impl lyra2_generic = {
+    "generic", reducedSqueezeRow0, reducedDuplexRow1, reducedDuplexRowSetup, reducedDuplexRow,
+    1, NULL, NULL, NULL, NULL
+};
+
+#if defined(LYRA2_X86_SIMD)
+static const struct lyra2_impl lyra2_sse2 = {
+    "sse2", reducedSqueezeRow0_sse2, reducedDuplexRow1_sse2, reducedDuplexRowSetup_sse2, reducedDuplexRow_sse2,
+    1, NULL, NULL, NULL, NULL
+};
+
+static const struct lyra2_impl lyra2_avx2 = {
+    "avx2", reducedSqueezeRow0_avx2, reducedDuplexRow1_avx2, reducedDuplexRowSetup_avx2, reducedDuplexRow_avx2,
+    2, reducedSqueezeRow0_avx2x2, reducedDuplexRow1_avx2x2, reducedDuplexRowSetup_avx2x2, reducedDuplexRow_avx2x2
+};
+
+static const struct lyra2_impl lyra2_avx512 = {
+    "avx512", reducedSqueezeRow0_avx2, reducedDuplexRow1_avx2, reducedDuplexRowSetup_avx2, reducedDuplexRow_avx2,
+    4, reducedSqueezeRow0_avx512x4, reducedDuplexRow1_avx512x4, reducedDuplexRowSetup_avx512x4, reducedDuplexRow_avx512x4
+};
+
+static int lyra2_has_sse2(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+    return (edx >> 26) & 1;
+}
 
+static int lyra2_has_avx2(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+    //The OS must save the YMM registers (OSXSAVE set and XCR0 bits 1 and 2 enabled)
+    if (!((ecx >> 27) & 1) || !((ecx >> 28) & 1))
+        return 0;
+    unsigned int xcr0_lo, xcr0_hi;
+    __asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 6) != 6)
+        return 0;
+    if (__get_cpuid_max(0, NULL) < 7)
+        return 0;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return (ebx >> 5) & 1;
+}
 
-    const int64_t ROW_LEN_INT64 = BLOCK_LEN_INT64 * nCols;
-    const int64_t ROW_LEN_BYTES = ROW_LEN_INT64 * 8;
+static int lyra2_has_avx512(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!lyra2_has_avx2())
+        return 0;
+    //The OS must also save the opmask and ZMM registers (XCR0 bits 5, 6 and 7)
+    unsigned int xcr0_lo, xcr0_hi;
+    __asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 0xE6) != 0xE6)
+        return 0;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return (ebx >> 16) & 1;
+}
+#endif
+
+static const struct lyra2_impl *lyra2_active = &lyra2_generic;
+
+const char *lyra2_detect_simd(void) {
+    lyra2_active = &lyra2_generic;
+#if defined(LYRA2_X86_SIMD)
+    if (lyra2_has_avx512())
+        lyra2_active = &lyra2_avx512;
+    else if (lyra2_has_avx2())
+        lyra2_active = &lyra2_avx2;
+#if defined(__i386__)
+    //Without AVX2 the rotations need shifts, which only pays off when 64-bit words don't fit a register
+    else if (lyra2_has_sse2())
+        lyra2_active = &lyra2_sse2;
+#endif
+#endif
+    return lyra2_active->name;
+}
 
-    i = (int64_t) ((int64_t) nRows * (int64_t) ROW_LEN_BYTES);
-    uint64_t *wholeMatrix = malloc(i);
-    if (wholeMatrix == NULL) {
-      return -1;
+int lyra2_select_impl(const char *name) {
+    if (strcmp(name, lyra2_generic.name) == 0) {
+        lyra2_active = &lyra2_generic;
+        return 1;
     }
-    memset(wholeMatrix, 0, i);
-
-    //Allocates pointers to each row of the matrix
-    uint64_t **memMatrix = malloc(nRows * sizeof (uint64_t*));
-    if (memMatrix == NULL) {
-      return -1;
+#if defined(LYRA2_X86_SIMD)
+    if (strcmp(name, lyra2_sse2.name) == 0 && lyra2_has_sse2()) {
+        lyra2_active = &lyra2_sse2;
+        return 1;
     }
-    //Places the pointers in the correct positions
-    uint64_t *ptrWord = wholeMatrix;
-    for (i = 0; i < nRows; i++) {
-      memMatrix[i] = ptrWord;
-      ptrWord += ROW_LEN_INT64;
+    if (strcmp(name, lyra2_avx2.name) == 0 && lyra2_has_avx2()) {
+        lyra2_active = &lyra2_avx2;
+        return 1;
     }
-    //==========================================================================/
+    if (strcmp(name, lyra2_avx512.name) == 0 && lyra2_has_avx512()) {
+        lyra2_active = &lyra2_avx512;
+        return 1;
+    }
+#endif
+    return 0;
+}
 
+unsigned int lyra2_batch_lanes(void) {
+    return lyra2_active->lanes;
+}
+
+/**
+ * Per-thread memory matrix, large enough for Lyra2Z (8 rows x 8 columns), so hashing
+ * headers does not hit the allocator. Larger matrices are allocated for each call.
+ * LYRA2_batch uses one such matrix per lane.
+ */
+#define LYRA2_SCRATCH_INT64 (8 * 8 * BLOCK_LEN_INT64)
+#define LYRA2_MAX_LANES 4
+#if defined(__GNUC__)
+static __thread uint64_t lyra2_scratch[LYRA2_SCRATCH_INT64] __attribute__ ((aligned(64)));
+static __thread uint64_t lyra2_batch_scratch[LYRA2_MAX_LANES * LYRA2_SCRATCH_INT64] __attribute__ ((aligned(64)));
+#define LYRA2_HAVE_SCRATCH 1
+#endif
+
+/**
+ * Initializes the sponge and absorbs pad(pwd || salt || basil), using the start of the
+ * memory matrix to hold the padded input.
+ */
+static void absorbInput(uint64_t *state, uint64_t *wholeMatrix, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols) {
     //============= Getting the password + salt + basil padded with 10*1 ===============//
     //OBS.:The memory matrix will temporarily hold the password: not for saving memory,
     //but this ensures that the password copied locally will be overwritten as soon as possible
@@ -122,29 +208,94 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
     //==========================================================================/
 
     //======================= Initializing the Sponge State ====================//
-    //Sponge state: 16 uint64_t, BLOCK_LEN_INT64 words of them for the bitrate (b) and the remainder for the capacity (c)
-    uint64_t *state = malloc(16 * sizeof (uint64_t));
-    if (state == NULL) {
-      return -1;
-    }
     initState(state);
     //==========================================================================/
 
-    //================================ Setup Phase =============================//
     //Absorbing salt, password and basil: this is the only place in which the block length is hard-coded to 512 bits
-    ptrWord = wholeMatrix;
+    uint64_t *ptrWord = wholeMatrix;
+    uint64_t i;
     for (i = 0; i < nBlocksInput; i++) {
       absorbBlockBlake2Safe(state, ptrWord); //absorbs each block of pad(pwd || salt || basil)
       ptrWord += BLOCK_LEN_BLAKE2_SAFE_INT64; //goes to next block of pad(pwd || salt || basil)
     }
+}
+
+/**
+ * Executes Lyra2 based on the G function from Blake2b. This version supports salts and passwords
+ * whose combined length is smaller than the size of the memory matrix, (i.e., (nRows x nCols x b) bits,
+ * where "b" is the underlying sponge's bitrate). In this implementation, the "basil" is composed by all
+ * integer parameters (treated as type "unsigned int") in the order they are provided, plus the value
+ * of nCols, (i.e., basil = kLen || pwdlen || saltlen || timeCost || nRows || nCols).
+ *
+ * @param K The derived key to be output by the algorithm
+ * @param kLen Desired key length
+ * @param pwd User password
+ * @param pwdlen Password length
+ * @param salt Salt
+ * @param saltlen Salt length
+ * @param timeCost Parameter to determine the processing time (T)
+ * @param nRows Number or rows of the memory matrix (R)
+ * @param nCols Number of columns of the memory matrix (C)
+ *
+ * @return 0 if the key is generated correctly; -1 if there is an error (usually due to lack of memory for allocation)
+ *
+ * Every row of the matrix is written during the Setup phase before it is read, so the
+ * matrix is not cleared beforehand and may be reused between calls.
+ */
+int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols) {
+
+    //============================= Basic variables ============================//
+    int64_t row = 2; //index of row to be processed
+    int64_t prev = 1; //index of prev (last row ever computed/modified)
+    int64_t rowa = 0; //index of row* (a previous row, deterministically picked during Setup and randomly picked while Wandering)
+    int64_t tau; //Time Loop iterator
+    int64_t step = 1; //Visitation step (used during Setup and Wandering phases)
+    int64_t window = 2; //Visitation window (used to define which rows can be revisited during Setup)
+    int64_t gap = 1; //Modifier to the step, assuming the values 1 or -1
+    int64_t i; //auxiliary iteration counter
+    //==========================================================================/
+
+    //========== Initializing the Memory Matrix and pointers to it =============//
+    //Tries to allocate enough space for the whole memory matrix
+
+
+    const int64_t ROW_LEN_INT64 = BLOCK_LEN_INT64 * nCols;
+    const int64_t ROW_LEN_BYTES = ROW_LEN_INT64 * 8;
+
+    uint64_t *wholeMatrix = NULL;
+    uint64_t *heapMatrix = NULL;
+#if defined(LYRA2_HAVE_SCRATCH)
+    if (nRows * ROW_LEN_INT64 <= LYRA2_SCRATCH_INT64)
+      wholeMatrix = lyra2_scratch;
+#endif
+    if (wholeMatrix == NULL) {
+      i = (int64_t) ((int64_t) nRows * (int64_t) ROW_LEN_BYTES);
+      heapMatrix = malloc(i);
+      if (heapMatrix == NULL) {
+        return -1;
+      }
+      wholeMatrix = heapMatrix;
+    }
+
+    //Row r of the matrix starts at wholeMatrix + r * ROW_LEN_INT64
+#define ROW(r) (wholeMatrix + (r) * ROW_LEN_INT64)
+    //==========================================================================/
+
+    //======================= Initializing the Sponge State ====================//
+    //Sponge state: 16 uint64_t, BLOCK_LEN_INT64 words of them for the bitrate (b) and the remainder for the capacity (c)
+    uint64_t state[16] ALIGN;
+    //==========================================================================/
+
+    //================================ Setup Phase =============================//
+    absorbInput(state, wholeMatrix, kLen, pwd, pwdlen, salt, saltlen, timeCost, nRows, nCols);
 
     //Initializes M[0] and M[1]
-    reducedSqueezeRow0(state, memMatrix[0], nCols); //The locally copied password is most likely overwritten here
-    reducedDuplexRow1(state, memMatrix[0], memMatrix[1], nCols);
+    lyra2_active->squeezeRow0(state, ROW(0), nCols); //The locally copied password is most likely overwritten here
+    lyra2_active->duplexRow1(state, ROW(0), ROW(1), nCols);
 
     do {
       //M[row] = rand; //M[row*] = M[row*] XOR rotW(rand)
-      reducedDuplexRowSetup(state, memMatrix[prev], memMatrix[rowa], memMatrix[row], nCols);
+      lyra2_active->duplexRowSetup(state, ROW(prev), ROW(rowa), ROW(row), nCols);
 
 
       //updates the value of row* (deterministically picked during Setup))
@@ -177,7 +328,7 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
         //------------------------------------------------------------------------------------------
 
         //Performs a reduced-round duplexing operation over M[row*] XOR M[prev], updating both M[row*] and M[row]
-        reducedDuplexRow(state, memMatrix[prev], memMatrix[rowa], memMatrix[row], nCols);
+        lyra2_active->duplexRow(state, ROW(prev), ROW(rowa), ROW(row), nCols);
 
         //update prev: it now points to the last row ever computed
         prev = row;
@@ -194,24 +345,112 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
 
     //============================ Wrap-up Phase ===============================//
     //Absorbs the last block of the memory matrix
-    absorbBlock(state, memMatrix[rowa]);
+    absorbBlock(state, ROW(rowa));
 
     //Squeezes the key
     squeeze(state, K, kLen);
     //==========================================================================/
 
     //========================= Freeing the memory =============================//
-    free(memMatrix);
-    free(wholeMatrix);
+#undef ROW
+    free(heapMatrix);
 
-    //Wiping out the sponge's internal state before freeing it
+    //Wiping out the sponge's internal state
     memset(state, 0, 16 * sizeof (uint64_t));
-    free(state);
     //==========================================================================/
 
     return 0;
 }
 
+/**
+ * Runs LYRA2 over nLanes independent inputs sharing the same parameters, interleaving the
+ * sponges so the latency of one sponge's G function chain is hidden by the others. Every
+ * output is identical to what LYRA2 would return for that lane alone.
+ *
+ * The rows visited during the Setup phase depend only on the parameters, so they are shared
+ * by all lanes; only row* of the Wandering phase is picked per lane. When the active
+ * implementation cannot run nLanes sponges at once, or the matrix does not fit the per-thread
+ * scratch, the lanes are hashed one after the other.
+ *
+ * @return 0 if every key is generated correctly; -1 otherwise
+ */
+int LYRA2_batch(void *const *K, uint64_t kLen, const void *const *pwd, uint64_t pwdlen, const void *const *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols, unsigned int nLanes) {
+    const struct lyra2_impl *impl = lyra2_active;
+    const int64_t ROW_LEN_INT64 = BLOCK_LEN_INT64 * nCols;
+    unsigned int l;
+
+#if defined(LYRA2_HAVE_SCRATCH)
+    if (nLanes >= 2 && nLanes == impl->lanes && nRows >= 3 && nRows * ROW_LEN_INT64 <= LYRA2_SCRATCH_INT64) {
+        int64_t row = 2, prev = 1, rowa = 0, tau, step = 1, window = 2, gap = 1;
+        int64_t rowaLane[LYRA2_MAX_LANES];
+        uint64_t state[LYRA2_MAX_LANES * 16] ALIGN;
+        uint64_t *rowIn[LYRA2_MAX_LANES], *rowInOut[LYRA2_MAX_LANES], *rowOut[LYRA2_MAX_LANES];
+
+        //Row r of lane l's matrix
+#define ROW(l, r) (lyra2_batch_scratch + (l) * LYRA2_SCRATCH_INT64 + (r) * ROW_LEN_INT64)
+        for (l = 0; l < nLanes; l++) {
+            absorbInput(state + 16 * l, ROW(l, 0), kLen, pwd[l], pwdlen, salt[l], saltlen, timeCost, nRows, nCols);
+            rowIn[l] = ROW(l, 0);
+            rowOut[l] = ROW(l, 1);
+        }
+
+        //Initializes M[0] and M[1]
+        impl->squeezeRow0Batch(state, rowIn, nCols);
+        impl->duplexRow1Batch(state, rowIn, rowOut, nCols);
+
+        do {
+          for (l = 0; l < nLanes; l++) {
+            rowIn[l] = ROW(l, prev);
+            rowInOut[l] = ROW(l, rowa);
+            rowOut[l] = ROW(l, row);
+          }
+          impl->duplexRowSetupBatch(state, rowIn, rowInOut, rowOut, nCols);
+
+          rowa = (rowa + step) & (window - 1);
+          prev = row;
+          row++;
+          if (rowa == 0) {
+            step = window + gap;
+            window *= 2;
+            gap = -gap;
+          }
+        } while (row < nRows);
+        for (l = 0; l < nLanes; l++)
+          rowaLane[l] = rowa;
+
+        row = 0;
+        for (tau = 1; tau <= timeCost; tau++) {
+          step = (tau % 2 == 0) ? -1 : nRows / 2 - 1;
+          do {
+            for (l = 0; l < nLanes; l++) {
+              rowaLane[l] = ((uint64_t) (state[16 * l])) % nRows;
+              rowIn[l] = ROW(l, prev);
+              rowInOut[l] = ROW(l, rowaLane[l]);
+              rowOut[l] = ROW(l, row);
+            }
+            impl->duplexRowBatch(state, rowIn, rowInOut, rowOut, nCols);
+            prev = row;
+            row = (row + step) % nRows;
+          } while (row != 0);
+        }
+
+        for (l = 0; l < nLanes; l++) {
+          absorbBlock(state + 16 * l, ROW(l, rowaLane[l]));
+          squeeze(state + 16 * l, K[l], kLen);
+        }
+#undef ROW
+        memset(state, 0, sizeof(state));
+        return 0;
+    }
+#endif
+
+    for (l = 0; l < nLanes; l++) {
+        if (LYRA2(K[l], kLen, pwd[l], pwdlen, salt[l], saltlen, timeCost, nRows, nCols) != 0)
+            return -1;
+    }
+    return 0;
+}
+
 int LYRA2_old(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols) {
 
     //============================= Basic variables ============================//
@@ -42,6 +42,15 @@ extern "C" {
 #endif
 
     int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols);
+    //Hashes nLanes inputs with the same parameters; fastest when nLanes == lyra2_batch_lanes()
+    int LYRA2_batch(void *const *K, uint64_t kLen, const void *const *pwd, uint64_t pwdlen, const void *const *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols, unsigned int nLanes);
+
+    //Picks the fastest row implementation supported by the CPU and returns its name; call before hashing starts
+    const char *lyra2_detect_simd(void);
+    //Forces an implementation ("generic", "sse2", "avx2" or "avx512"); returns 0 if it is not available
+    int lyra2_select_impl(const char *name);
+    //Number of sponges the active implementation runs at once in LYRA2_batch
+    unsigned int lyra2_batch_lanes(void);
 
 #ifdef __cplusplus
 }
@@ -50,3 +50,33 @@ void lyra2z_hash(const char* input, char* output)
 	memcpy(output, hashB, 32);
 }
 
+
+void lyra2z_hash_batch(const char* input, size_t n, char* output)
+{
+    sph_blake256_context     ctx_blake;
+    uint32_t hashA[4][8], hashB[4][8];
+    const void *pwd[4];
+    void *key[4];
+    size_t lanes = lyra2_batch_lanes();
+    size_t i, l;
+
+    if (lanes > 4)
+        lanes = 4;
+    for (l = 0; l < 4; l++) {
+        pwd[l] = hashA[l];
+        key[l] = hashB[l];
+    }
+
+    for (i = 0; i + lanes <= n && lanes > 1; i += lanes) {
+        for (l = 0; l < lanes; l++) {
+            sph_blake256_init(&ctx_blake);
+            sph_blake256(&ctx_blake, input + (i + l) * 80, 80);
+            sph_blake256_close(&ctx_blake, hashA[l]);
+        }
+        LYRA2_batch(key, 32, pwd, 32, pwd, 32, 8, 8, 8, lanes);
+        for (l = 0; l < lanes; l++)
+            memcpy(output + (i + l) * 32, hashB[l], 32);
+    }
+    for (; i < n; i++)
+        lyra2z_hash(input + i * 80, output + i * 32);
+}
@@ -1,11 +1,15 @@
 #ifndef LYRA2RE_H
 #define LYRA2RE_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 void lyra2z_hash(const char* input, char* output);
+/* Hashes n consecutive 80-byte headers into n consecutive 32-byte outputs */
+void lyra2z_hash_batch(const char* input, size_t n, char* output);
 
 #ifdef __cplusplus
 }
@@ -92,6 +92,32 @@ void reducedDuplexRow(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint
 //---- Misc
 void printArray(unsigned char *array, unsigned int size, char *name);
 
+//---- Vectorized row operations, selected at runtime by lyra2_detect_simd()
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LYRA2_X86_SIMD 1
+
+void reducedSqueezeRow0_sse2(uint64_t* state, uint64_t* row, uint64_t nCols);
+void reducedDuplexRow1_sse2(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols);
+void reducedDuplexRowSetup_sse2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+void reducedDuplexRow_sse2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+
+void reducedSqueezeRow0_avx2(uint64_t* state, uint64_t* row, uint64_t nCols);
+void reducedDuplexRow1_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols);
+void reducedDuplexRowSetup_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+void reducedDuplexRow_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+
+//---- Interleaved row operations over several independent sponges (states stored back to back)
+void reducedSqueezeRow0_avx2x2(uint64_t* state, uint64_t *const *rowOut, uint64_t nCols);
+void reducedDuplexRow1_avx2x2(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowOut, uint64_t nCols);
+void reducedDuplexRowSetup_avx2x2(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowInOut, uint64_t *const *rowOut, uint64_t nCols);
+void reducedDuplexRow_avx2x2(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowInOut, uint64_t *const *rowOut, uint64_t nCols);
+
+void reducedSqueezeRow0_avx512x4(uint64_t* state, uint64_t *const *rowOut, uint64_t nCols);
+void reducedDuplexRow1_avx512x4(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowOut, uint64_t nCols);
+void reducedDuplexRowSetup_avx512x4(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowInOut, uint64_t *const *rowOut, uint64_t nCols);
+void reducedDuplexRow_avx512x4(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowInOut, uint64_t *const *rowOut, uint64_t nCols);
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
 
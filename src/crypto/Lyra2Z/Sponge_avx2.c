@@ -0,0 +1,305 @@
+/**
+ * AVX2 implementation of the reduced-round row operations of the Lyra2 sponge.
+ * Each row of Blake2b's 4x4 state matrix lives in one 256-bit register, so the
+ * G function is applied to all four columns (then all four diagonals) at once.
+ * The results are bit-for-bit identical to the portable code in Sponge.c.
+ *
+ * This software is hereby placed in the public domain.
+ */
+#include "Sponge.h"
+#include "Lyra2.h"
+
+#if defined(LYRA2_X86_SIMD)
+
+#include <immintrin.h>
+
+#define LYRA2_AVX2 __attribute__((target("avx2")))
+
+#define ROTR24_AVX2(x) _mm256_shuffle_epi8((x), _mm256_setr_epi8( \
+    3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10, \
+    3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10))
+#define ROTR16_AVX2(x) _mm256_shuffle_epi8((x), _mm256_setr_epi8( \
+    2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9, \
+    2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9))
+#define ROTR63_AVX2(x) _mm256_xor_si256(_mm256_srli_epi64((x), 63), _mm256_add_epi64((x), (x)))
+
+/*Blake2b's G function over four columns*/
+#define G_AVX2(a,b,c,d) \
+  do { \
+    a = _mm256_add_epi64(a, b); \
+    d = _mm256_shuffle_epi32(_mm256_xor_si256(d, a), _MM_SHUFFLE(2,3,0,1)); \
+    c = _mm256_add_epi64(c, d); \
+    b = _mm256_xor_si256(b, c); \
+    b = ROTR24_AVX2(b); \
+    a = _mm256_add_epi64(a, b); \
+    d = _mm256_xor_si256(d, a); \
+    d = ROTR16_AVX2(d); \
+    c = _mm256_add_epi64(c, d); \
+    b = _mm256_xor_si256(b, c); \
+    b = ROTR63_AVX2(b); \
+  } while(0)
+
+/*One Round of the Blake2b's compression function*/
+#define ROUND_LYRA_AVX2(s) \
+  do { \
+    G_AVX2(s[0], s[1], s[2], s[3]); \
+    s[1] = _mm256_permute4x64_epi64(s[1], _MM_SHUFFLE(0,3,2,1)); \
+    s[2] = _mm256_permute4x64_epi64(s[2], _MM_SHUFFLE(1,0,3,2)); \
+    s[3] = _mm256_permute4x64_epi64(s[3], _MM_SHUFFLE(2,1,0,3)); \
+    G_AVX2(s[0], s[1], s[2], s[3]); \
+    s[1] = _mm256_permute4x64_epi64(s[1], _MM_SHUFFLE(2,1,0,3)); \
+    s[2] = _mm256_permute4x64_epi64(s[2], _MM_SHUFFLE(1,0,3,2)); \
+    s[3] = _mm256_permute4x64_epi64(s[3], _MM_SHUFFLE(0,3,2,1)); \
+  } while(0)
+
+/*rand rotated one word to the left: each row shifted up by one word, taking its first word from the previous row*/
+#define ROTW_AVX2(s, r) \
+  do { \
+    __m256i t0 = _mm256_permute4x64_epi64(s[0], _MM_SHUFFLE(2,1,0,3)); \
+    __m256i t1 = _mm256_permute4x64_epi64(s[1], _MM_SHUFFLE(2,1,0,3)); \
+    __m256i t2 = _mm256_permute4x64_epi64(s[2], _MM_SHUFFLE(2,1,0,3)); \
+    r[0] = _mm256_blend_epi32(t0, t2, 0x03); \
+    r[1] = _mm256_blend_epi32(t1, t0, 0x03); \
+    r[2] = _mm256_blend_epi32(t2, t1, 0x03); \
+  } while(0)
+
+#define LYRA2_AVX2_INLINE __attribute__((target("avx2"), always_inline)) static inline
+
+LYRA2_AVX2_INLINE void loadState_avx2(__m256i s[4], const uint64_t *state) {
+    int j;
+    for (j = 0; j < 4; j++)
+        s[j] = _mm256_loadu_si256((const __m256i *) state + j);
+}
+
+LYRA2_AVX2_INLINE void storeState_avx2(uint64_t *state, const __m256i s[4]) {
+    int j;
+    for (j = 0; j < 4; j++)
+        _mm256_storeu_si256((__m256i *) state + j, s[j]);
+}
+
+//state ^= M[in][col]
+LYRA2_AVX2_INLINE void absorbColumn_avx2(__m256i s[4], const __m256i *in) {
+    int j;
+    for (j = 0; j < 3; j++)
+        s[j] = _mm256_xor_si256(s[j], _mm256_loadu_si256(in + j));
+}
+
+//state ^= M[in][col] [+] M[inOut][col]
+LYRA2_AVX2_INLINE void absorbColumns_avx2(__m256i s[4], const __m256i *in, const __m256i *inOut) {
+    int j;
+    for (j = 0; j < 3; j++)
+        s[j] = _mm256_xor_si256(s[j], _mm256_add_epi64(_mm256_loadu_si256(in + j), _mm256_loadu_si256(inOut + j)));
+}
+
+//M[out][col] = M[in][col] XOR rand, or M[out][col] = rand when in is NULL
+LYRA2_AVX2_INLINE void writeColumn_avx2(__m256i *out, const __m256i *in, const __m256i s[4]) {
+    int j;
+    for (j = 0; j < 3; j++)
+        _mm256_storeu_si256(out + j, in ? _mm256_xor_si256(_mm256_loadu_si256(in + j), s[j]) : s[j]);
+}
+
+//M[out][col] ^= rand
+LYRA2_AVX2_INLINE void xorColumn_avx2(__m256i *out, const __m256i s[4]) {
+    int j;
+    for (j = 0; j < 3; j++)
+        _mm256_storeu_si256(out + j, _mm256_xor_si256(_mm256_loadu_si256(out + j), s[j]));
+}
+
+//M[inOut][col] ^= rotW(rand); called after M[out] is written, as the two rows may be the same
+LYRA2_AVX2_INLINE void xorRotColumn_avx2(__m256i *inOut, const __m256i s[4]) {
+    __m256i r[3];
+    int j;
+    ROTW_AVX2(s, r);
+    for (j = 0; j < 3; j++)
+        _mm256_storeu_si256(inOut + j, _mm256_xor_si256(_mm256_loadu_si256(inOut + j), r[j]));
+}
+
+LYRA2_AVX2 void reducedSqueezeRow0_avx2(uint64_t* state, uint64_t* rowOut, uint64_t nCols) {
+    __m256i *ptrWordOut = (__m256i *) (rowOut + (nCols-1)*BLOCK_LEN_INT64);
+    __m256i s[4];
+    uint64_t i;
+
+    loadState_avx2(s, state);
+    for (i = 0; i < nCols; i++) {
+        writeColumn_avx2(ptrWordOut, NULL, s);
+        ptrWordOut -= BLOCK_LEN_INT64 / 4;
+        ROUND_LYRA_AVX2(s);
+    }
+    storeState_avx2(state, s);
+    _mm256_zeroupper();
+}
+
+LYRA2_AVX2 void reducedDuplexRow1_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols) {
+    const __m256i *ptrWordIn = (const __m256i *) rowIn;
+    __m256i *ptrWordOut = (__m256i *) (rowOut + (nCols-1)*BLOCK_LEN_INT64);
+    __m256i s[4];
+    uint64_t i;
+
+    loadState_avx2(s, state);
+    for (i = 0; i < nCols; i++) {
+        absorbColumn_avx2(s, ptrWordIn);
+        ROUND_LYRA_AVX2(s);
+        writeColumn_avx2(ptrWordOut, ptrWordIn, s);
+        ptrWordIn += BLOCK_LEN_INT64 / 4;
+        ptrWordOut -= BLOCK_LEN_INT64 / 4;
+    }
+    storeState_avx2(state, s);
+    _mm256_zeroupper();
+}
+
+LYRA2_AVX2 void reducedDuplexRowSetup_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    const __m256i *ptrWordIn = (const __m256i *) rowIn;
+    __m256i *ptrWordInOut = (__m256i *) rowInOut;
+    __m256i *ptrWordOut = (__m256i *) (rowOut + (nCols-1)*BLOCK_LEN_INT64);
+    __m256i s[4];
+    uint64_t i;
+
+    loadState_avx2(s, state);
+    for (i = 0; i < nCols; i++) {
+        absorbColumns_avx2(s, ptrWordIn, ptrWordInOut);
+        ROUND_LYRA_AVX2(s);
+        writeColumn_avx2(ptrWordOut, ptrWordIn, s);
+        xorRotColumn_avx2(ptrWordInOut, s);
+        ptrWordIn += BLOCK_LEN_INT64 / 4;
+        ptrWordInOut += BLOCK_LEN_INT64 / 4;
+        ptrWordOut -= BLOCK_LEN_INT64 / 4;
+    }
+    storeState_avx2(state, s);
+    _mm256_zeroupper();
+}
+
+LYRA2_AVX2 void reducedDuplexRow_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    const __m256i *ptrWordIn = (const __m256i *) rowIn;
+    __m256i *ptrWordInOut = (__m256i *) rowInOut;
+    __m256i *ptrWordOut = (__m256i *) rowOut;
+    __m256i s[4];
+    uint64_t i;
+
+    loadState_avx2(s, state);
+    for (i = 0; i < nCols; i++) {
+        absorbColumns_avx2(s, ptrWordIn, ptrWordInOut);
+        ROUND_LYRA_AVX2(s);
+        xorColumn_avx2(ptrWordOut, s);
+        xorRotColumn_avx2(ptrWordInOut, s);
+        ptrWordIn += BLOCK_LEN_INT64 / 4;
+        ptrWordInOut += BLOCK_LEN_INT64 / 4;
+        ptrWordOut += BLOCK_LEN_INT64 / 4;
+    }
+    storeState_avx2(state, s);
+    _mm256_zeroupper();
+}
+
+/*
+ * Two independent sponges processed in the same loop. A single sponge is bound by the
+ * latency of the G function chain; interleaving a second one fills the idle issue slots.
+ */
+
+LYRA2_AVX2 void reducedSqueezeRow0_avx2x2(uint64_t* state, uint64_t *const *rowOut, uint64_t nCols) {
+    __m256i *ptrOutA = (__m256i *) (rowOut[0] + (nCols-1)*BLOCK_LEN_INT64);
+    __m256i *ptrOutB = (__m256i *) (rowOut[1] + (nCols-1)*BLOCK_LEN_INT64);
+    __m256i sA[4], sB[4];
+    uint64_t i;
+
+    loadState_avx2(sA, state);
+    loadState_avx2(sB, state + 16);
+    for (i = 0; i < nCols; i++) {
+        writeColumn_avx2(ptrOutA, NULL, sA);
+        writeColumn_avx2(ptrOutB, NULL, sB);
+        ptrOutA -= BLOCK_LEN_INT64 / 4;
+        ptrOutB -= BLOCK_LEN_INT64 / 4;
+        ROUND_LYRA_AVX2(sA);
+        ROUND_LYRA_AVX2(sB);
+    }
+    storeState_avx2(state, sA);
+    storeState_avx2(state + 16, sB);
+    _mm256_zeroupper();
+}
+
+LYRA2_AVX2 void reducedDuplexRow1_avx2x2(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowOut, uint64_t nCols) {
+    const __m256i *ptrInA = (const __m256i *) rowIn[0], *ptrInB = (const __m256i *) rowIn[1];
+    __m256i *ptrOutA = (__m256i *) (rowOut[0] + (nCols-1)*BLOCK_LEN_INT64);
+    __m256i *ptrOutB = (__m256i *) (rowOut[1] + (nCols-1)*BLOCK_LEN_INT64);
+    __m256i sA[4], sB[4];
+    uint64_t i;
+
+    loadState_avx2(sA, state);
+    loadState_avx2(sB, state + 16);
+    for (i = 0; i < nCols; i++) {
+        absorbColumn_avx2(sA, ptrInA);
+        absorbColumn_avx2(sB, ptrInB);
+        ROUND_LYRA_AVX2(sA);
+        ROUND_LYRA_AVX2(sB);
+        writeColumn_avx2(ptrOutA, ptrInA, sA);
+        writeColumn_avx2(ptrOutB, ptrInB, sB);
+        ptrInA += BLOCK_LEN_INT64 / 4;
+        ptrInB += BLOCK_LEN_INT64 / 4;
+        ptrOutA -= BLOCK_LEN_INT64 / 4;
+        ptrOutB -= BLOCK_LEN_INT64 / 4;
+    }
+    storeState_avx2(state, sA);
+    storeState_avx2(state + 16, sB);
+    _mm256_zeroupper();
+}
+
+LYRA2_AVX2 void reducedDuplexRowSetup_avx2x2(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowInOut, uint64_t *const *rowOut, uint64_t nCols) {
+    const __m256i *ptrInA = (const __m256i *) rowIn[0], *ptrInB = (const __m256i *) rowIn[1];
+    __m256i *ptrInOutA = (__m256i *) rowInOut[0], *ptrInOutB = (__m256i *) rowInOut[1];
+    __m256i *ptrOutA = (__m256i *) (rowOut[0] + (nCols-1)*BLOCK_LEN_INT64);
+    __m256i *ptrOutB = (__m256i *) (rowOut[1] + (nCols-1)*BLOCK_LEN_INT64);
+    __m256i sA[4], sB[4];
+    uint64_t i;
+
+    loadState_avx2(sA, state);
+    loadState_avx2(sB, state + 16);
+    for (i = 0; i < nCols; i++) {
+        absorbColumns_avx2(sA, ptrInA, ptrInOutA);
+        absorbColumns_avx2(sB, ptrInB, ptrInOutB);
+        ROUND_LYRA_AVX2(sA);
+        ROUND_LYRA_AVX2(sB);
+        writeColumn_avx2(ptrOutA, ptrInA, sA);
+        writeColumn_avx2(ptrOutB, ptrInB, sB);
+        xorRotColumn_avx2(ptrInOutA, sA);
+        xorRotColumn_avx2(ptrInOutB, sB);
+        ptrInA += BLOCK_LEN_INT64 / 4;
+        ptrInB += BLOCK_LEN_INT64 / 4;
+        ptrInOutA += BLOCK_LEN_INT64 / 4;
+        ptrInOutB += BLOCK_LEN_INT64 / 4;
+        ptrOutA -= BLOCK_LEN_INT64 / 4;
+        ptrOutB -= BLOCK_LEN_INT64 / 4;
+    }
+    storeState_avx2(state, sA);
+    storeState_avx2(state + 16, sB);
+    _mm256_zeroupper();
+}
+
+LYRA2_AVX2 void reducedDuplexRow_avx2x2(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowInOut, uint64_t *const *rowOut, uint64_t nCols) {
+    const __m256i *ptrInA = (const __m256i *) rowIn[0], *ptrInB = (const __m256i *) rowIn[1];
+    __m256i *ptrInOutA = (__m256i *) rowInOut[0], *ptrInOutB = (__m256i *) rowInOut[1];
+    __m256i *ptrOutA = (__m256i *) rowOut[0], *ptrOutB = (__m256i *) rowOut[1];
+    __m256i sA[4], sB[4];
+    uint64_t i;
+
+    loadState_avx2(sA, state);
+    loadState_avx2(sB, state + 16);
+    for (i = 0; i < nCols; i++) {
+        absorbColumns_avx2(sA, ptrInA, ptrInOutA);
+        absorbColumns_avx2(sB, ptrInB, ptrInOutB);
+        ROUND_LYRA_AVX2(sA);
+        ROUND_LYRA_AVX2(sB);
+        xorColumn_avx2(ptrOutA, sA);
+        xorColumn_avx2(ptrOutB, sB);
+        xorRotColumn_avx2(ptrInOutA, sA);
+        xorRotColumn_avx2(ptrInOutB, sB);
+        ptrInA += BLOCK_LEN_INT64 / 4;
+        ptrInB += BLOCK_LEN_INT64 / 4;
+        ptrInOutA += BLOCK_LEN_INT64 / 4;
+        ptrInOutB += BLOCK_LEN_INT64 / 4;
+        ptrOutA += BLOCK_LEN_INT64 / 4;
+        ptrOutB += BLOCK_LEN_INT64 / 4;
+    }
+    storeState_avx2(state, sA);
+    storeState_avx2(state + 16, sB);
+    _mm256_zeroupper();
+}
+
+#endif
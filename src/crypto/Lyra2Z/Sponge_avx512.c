@@ -0,0 +1,236 @@
+/**
+ * AVX-512 implementation of the reduced-round row operations of the Lyra2 sponge,
+ * running four independent sponges at once. Each 512-bit register holds the same
+ * row of two sponges' 4x4 state matrices (one per 256-bit half), and two sets of
+ * registers are interleaved to hide the latency of the G function chain.
+ * The results are bit-for-bit identical to the portable code in Sponge.c.
+ *
+ * This software is hereby placed in the public domain.
+ */
+#include "Sponge.h"
+#include "Lyra2.h"
+
+#if defined(LYRA2_X86_SIMD)
+
+#include <immintrin.h>
+
+#define LYRA2_AVX512 __attribute__((target("avx512f")))
+#define LYRA2_AVX512_INLINE __attribute__((target("avx512f"), always_inline)) static inline
+
+/*Blake2b's G function over four columns of two sponges*/
+#define G_AVX512(a,b,c,d) \
+  do { \
+    a = _mm512_add_epi64(a, b); \
+    d = _mm512_ror_epi64(_mm512_xor_si512(d, a), 32); \
+    c = _mm512_add_epi64(c, d); \
+    b = _mm512_ror_epi64(_mm512_xor_si512(b, c), 24); \
+    a = _mm512_add_epi64(a, b); \
+    d = _mm512_ror_epi64(_mm512_xor_si512(d, a), 16); \
+    c = _mm512_add_epi64(c, d); \
+    b = _mm512_ror_epi64(_mm512_xor_si512(b, c), 63); \
+  } while(0)
+
+/*One Round of the Blake2b's compression function; the permutes act on each 256-bit half*/
+#define ROUND_LYRA_AVX512(s) \
+  do { \
+    G_AVX512(s[0], s[1], s[2], s[3]); \
+    s[1] = _mm512_permutex_epi64(s[1], _MM_SHUFFLE(0,3,2,1)); \
+    s[2] = _mm512_permutex_epi64(s[2], _MM_SHUFFLE(1,0,3,2)); \
+    s[3] = _mm512_permutex_epi64(s[3], _MM_SHUFFLE(2,1,0,3)); \
+    G_AVX512(s[0], s[1], s[2], s[3]); \
+    s[1] = _mm512_permutex_epi64(s[1], _MM_SHUFFLE(2,1,0,3)); \
+    s[2] = _mm512_permutex_epi64(s[2], _MM_SHUFFLE(1,0,3,2)); \
+    s[3] = _mm512_permutex_epi64(s[3], _MM_SHUFFLE(0,3,2,1)); \
+  } while(0)
+
+/*rand rotated one word to the left, for both sponges*/
+#define ROTW_AVX512(s, r) \
+  do { \
+    __m512i t0 = _mm512_permutex_epi64(s[0], _MM_SHUFFLE(2,1,0,3)); \
+    __m512i t1 = _mm512_permutex_epi64(s[1], _MM_SHUFFLE(2,1,0,3)); \
+    __m512i t2 = _mm512_permutex_epi64(s[2], _MM_SHUFFLE(2,1,0,3)); \
+    r[0] = _mm512_mask_blend_epi64(0x11, t0, t2); \
+    r[1] = _mm512_mask_blend_epi64(0x11, t1, t0); \
+    r[2] = _mm512_mask_blend_epi64(0x11, t2, t1); \
+  } while(0)
+
+//Loads 256 bits from each of two sponges' rows into one register
+LYRA2_AVX512_INLINE __m512i load2_avx512(const uint64_t *a, const uint64_t *b) {
+    return _mm512_inserti64x4(_mm512_castsi256_si512(_mm256_loadu_si256((const __m256i *) a)),
+                              _mm256_loadu_si256((const __m256i *) b), 1);
+}
+
+LYRA2_AVX512_INLINE void store2_avx512(uint64_t *a, uint64_t *b, __m512i v) {
+    _mm256_storeu_si256((__m256i *) a, _mm512_castsi512_si256(v));
+    _mm256_storeu_si256((__m256i *) b, _mm512_extracti64x4_epi64(v, 1));
+}
+
+LYRA2_AVX512_INLINE void loadState_avx512(__m512i s[4], const uint64_t *stateA, const uint64_t *stateB) {
+    int j;
+    for (j = 0; j < 4; j++)
+        s[j] = load2_avx512(stateA + 4 * j, stateB + 4 * j);
+}
+
+LYRA2_AVX512_INLINE void storeState_avx512(uint64_t *stateA, uint64_t *stateB, const __m512i s[4]) {
+    int j;
+    for (j = 0; j < 4; j++)
+        store2_avx512(stateA + 4 * j, stateB + 4 * j, s[j]);
+}
+
+//state ^= M[in][col], or M[in][col] [+] M[inOut][col] when inOut is given
+LYRA2_AVX512_INLINE void absorbColumns_avx512(__m512i s[4], const uint64_t *inA, const uint64_t *inB,
+                                              const uint64_t *inOutA, const uint64_t *inOutB) {
+    int j;
+    for (j = 0; j < 3; j++) {
+        __m512i v = load2_avx512(inA + 4 * j, inB + 4 * j);
+        if (inOutA)
+            v = _mm512_add_epi64(v, load2_avx512(inOutA + 4 * j, inOutB + 4 * j));
+        s[j] = _mm512_xor_si512(s[j], v);
+    }
+}
+
+//M[out][col] = M[in][col] XOR rand, or M[out][col] = rand when in is NULL
+LYRA2_AVX512_INLINE void writeColumn_avx512(uint64_t *outA, uint64_t *outB, const uint64_t *inA, const uint64_t *inB, const __m512i s[4]) {
+    int j;
+    for (j = 0; j < 3; j++)
+        store2_avx512(outA + 4 * j, outB + 4 * j, inA ? _mm512_xor_si512(load2_avx512(inA + 4 * j, inB + 4 * j), s[j]) : s[j]);
+}
+
+//M[out][col] ^= rand
+LYRA2_AVX512_INLINE void xorColumn_avx512(uint64_t *outA, uint64_t *outB, const __m512i s[4]) {
+    int j;
+    for (j = 0; j < 3; j++)
+        store2_avx512(outA + 4 * j, outB + 4 * j, _mm512_xor_si512(load2_avx512(outA + 4 * j, outB + 4 * j), s[j]));
+}
+
+//M[inOut][col] ^= rotW(rand); called after M[out] is written, as the two rows may be the same
+LYRA2_AVX512_INLINE void xorRotColumn_avx512(uint64_t *inOutA, uint64_t *inOutB, const __m512i s[4]) {
+    __m512i r[3];
+    int j;
+    ROTW_AVX512(s, r);
+    for (j = 0; j < 3; j++)
+        store2_avx512(inOutA + 4 * j, inOutB + 4 * j, _mm512_xor_si512(load2_avx512(inOutA + 4 * j, inOutB + 4 * j), r[j]));
+}
+
+LYRA2_AVX512 void reducedSqueezeRow0_avx512x4(uint64_t* state, uint64_t *const *rowOut, uint64_t nCols) {
+    uint64_t *ptrOut[4];
+    __m512i sX[4], sY[4];
+    uint64_t i;
+    int l;
+
+    for (l = 0; l < 4; l++)
+        ptrOut[l] = rowOut[l] + (nCols-1)*BLOCK_LEN_INT64;
+    loadState_avx512(sX, state, state + 16);
+    loadState_avx512(sY, state + 32, state + 48);
+    for (i = 0; i < nCols; i++) {
+        writeColumn_avx512(ptrOut[0], ptrOut[1], NULL, NULL, sX);
+        writeColumn_avx512(ptrOut[2], ptrOut[3], NULL, NULL, sY);
+        for (l = 0; l < 4; l++)
+            ptrOut[l] -= BLOCK_LEN_INT64;
+        ROUND_LYRA_AVX512(sX);
+        ROUND_LYRA_AVX512(sY);
+    }
+    storeState_avx512(state, state + 16, sX);
+    storeState_avx512(state + 32, state + 48, sY);
+    _mm256_zeroupper();
+}
+
+LYRA2_AVX512 void reducedDuplexRow1_avx512x4(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowOut, uint64_t nCols) {
+    const uint64_t *ptrIn[4];
+    uint64_t *ptrOut[4];
+    __m512i sX[4], sY[4];
+    uint64_t i;
+    int l;
+
+    for (l = 0; l < 4; l++) {
+        ptrIn[l] = rowIn[l];
+        ptrOut[l] = rowOut[l] + (nCols-1)*BLOCK_LEN_INT64;
+    }
+    loadState_avx512(sX, state, state + 16);
+    loadState_avx512(sY, state + 32, state + 48);
+    for (i = 0; i < nCols; i++) {
+        absorbColumns_avx512(sX, ptrIn[0], ptrIn[1], NULL, NULL);
+        absorbColumns_avx512(sY, ptrIn[2], ptrIn[3], NULL, NULL);
+        ROUND_LYRA_AVX512(sX);
+        ROUND_LYRA_AVX512(sY);
+        writeColumn_avx512(ptrOut[0], ptrOut[1], ptrIn[0], ptrIn[1], sX);
+        writeColumn_avx512(ptrOut[2], ptrOut[3], ptrIn[2], ptrIn[3], sY);
+        for (l = 0; l < 4; l++) {
+            ptrIn[l] += BLOCK_LEN_INT64;
+            ptrOut[l] -= BLOCK_LEN_INT64;
+        }
+    }
+    storeState_avx512(state, state + 16, sX);
+    storeState_avx512(state + 32, state + 48, sY);
+    _mm256_zeroupper();
+}
+
+LYRA2_AVX512 void reducedDuplexRowSetup_avx512x4(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowInOut, uint64_t *const *rowOut, uint64_t nCols) {
+    const uint64_t *ptrIn[4];
+    uint64_t *ptrInOut[4], *ptrOut[4];
+    __m512i sX[4], sY[4];
+    uint64_t i;
+    int l;
+
+    for (l = 0; l < 4; l++) {
+        ptrIn[l] = rowIn[l];
+        ptrInOut[l] = rowInOut[l];
+        ptrOut[l] = rowOut[l] + (nCols-1)*BLOCK_LEN_INT64;
+    }
+    loadState_avx512(sX, state, state + 16);
+    loadState_avx512(sY, state + 32, state + 48);
+    for (i = 0; i < nCols; i++) {
+        absorbColumns_avx512(sX, ptrIn[0], ptrIn[1], ptrInOut[0], ptrInOut[1]);
+        absorbColumns_avx512(sY, ptrIn[2], ptrIn[3], ptrInOut[2], ptrInOut[3]);
+        ROUND_LYRA_AVX512(sX);
+        ROUND_LYRA_AVX512(sY);
+        writeColumn_avx512(ptrOut[0], ptrOut[1], ptrIn[0], ptrIn[1], sX);
+        writeColumn_avx512(ptrOut[2], ptrOut[3], ptrIn[2], ptrIn[3], sY);
+        xorRotColumn_avx512(ptrInOut[0], ptrInOut[1], sX);
+        xorRotColumn_avx512(ptrInOut[2], ptrInOut[3], sY);
+        for (l = 0; l < 4; l++) {
+            ptrIn[l] += BLOCK_LEN_INT64;
+            ptrInOut[l] += BLOCK_LEN_INT64;
+            ptrOut[l] -= BLOCK_LEN_INT64;
+        }
+    }
+    storeState_avx512(state, state + 16, sX);
+    storeState_avx512(state + 32, state + 48, sY);
+    _mm256_zeroupper();
+}
+
+LYRA2_AVX512 void reducedDuplexRow_avx512x4(uint64_t *state, uint64_t *const *rowIn, uint64_t *const *rowInOut, uint64_t *const *rowOut, uint64_t nCols) {
+    const uint64_t *ptrIn[4];
+    uint64_t *ptrInOut[4], *ptrOut[4];
+    __m512i sX[4], sY[4];
+    uint64_t i;
+    int l;
+
+    for (l = 0; l < 4; l++) {
+        ptrIn[l] = rowIn[l];
+        ptrInOut[l] = rowInOut[l];
+        ptrOut[l] = rowOut[l];
+    }
+    loadState_avx512(sX, state, state + 16);
+    loadState_avx512(sY, state + 32, state + 48);
+    for (i = 0; i < nCols; i++) {
+        absorbColumns_avx512(sX, ptrIn[0], ptrIn[1], ptrInOut[0], ptrInOut[1]);
+        absorbColumns_avx512(sY, ptrIn[2], ptrIn[3], ptrInOut[2], ptrInOut[3]);
+        ROUND_LYRA_AVX512(sX);
+        ROUND_LYRA_AVX512(sY);
+        xorColumn_avx512(ptrOut[0], ptrOut[1], sX);
+        xorColumn_avx512(ptrOut[2], ptrOut[3], sY);
+        xorRotColumn_avx512(ptrInOut[0], ptrInOut[1], sX);
+        xorRotColumn_avx512(ptrInOut[2], ptrInOut[3], sY);
+        for (l = 0; l < 4; l++) {
+            ptrIn[l] += BLOCK_LEN_INT64;
+            ptrInOut[l] += BLOCK_LEN_INT64;
+            ptrOut[l] += BLOCK_LEN_INT64;
+        }
+    }
+    storeState_avx512(state, state + 16, sX);
+    storeState_avx512(state + 32, state + 48, sY);
+    _mm256_zeroupper();
+}
+
+#endif
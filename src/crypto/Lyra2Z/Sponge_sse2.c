@@ -0,0 +1,177 @@
+/**
+ * SSE2 implementation of the reduced-round row operations of the Lyra2 sponge.
+ * The sponge state is kept in eight 128-bit registers (two per row of Blake2b's
+ * 4x4 state matrix) and the G function is applied to two columns at once. The
+ * results are bit-for-bit identical to the portable code in Sponge.c.
+ *
+ * This software is hereby placed in the public domain.
+ */
+#include "Sponge.h"
+#include "Lyra2.h"
+
+#if defined(LYRA2_X86_SIMD)
+
+#include <emmintrin.h>
+
+#define LYRA2_SSE2 __attribute__((target("sse2")))
+
+#define ROTR24_SSE2(x) _mm_xor_si128(_mm_srli_epi64((x), 24), _mm_slli_epi64((x), 40))
+#define ROTR16_SSE2(x) _mm_xor_si128(_mm_srli_epi64((x), 16), _mm_slli_epi64((x), 48))
+#define ROTR63_SSE2(x) _mm_xor_si128(_mm_srli_epi64((x), 63), _mm_add_epi64((x), (x)))
+
+/*Blake2b's G function over two columns*/
+#define G_SSE2(a,b,c,d) \
+  do { \
+    a = _mm_add_epi64(a, b); \
+    d = _mm_shuffle_epi32(_mm_xor_si128(d, a), _MM_SHUFFLE(2,3,0,1)); \
+    c = _mm_add_epi64(c, d); \
+    b = _mm_xor_si128(b, c); \
+    b = ROTR24_SSE2(b); \
+    a = _mm_add_epi64(a, b); \
+    d = _mm_xor_si128(d, a); \
+    d = ROTR16_SSE2(d); \
+    c = _mm_add_epi64(c, d); \
+    b = _mm_xor_si128(b, c); \
+    b = ROTR63_SSE2(b); \
+  } while(0)
+
+/*Rotates rows 2, 3 and 4 by one, two and three words so the diagonals line up as columns*/
+#define DIAGONALIZE_SSE2(s) \
+  do { \
+    __m128i t0 = s[6], t1 = s[2], t2 = s[4]; \
+    s[4] = s[5]; \
+    s[5] = t2; \
+    s[6] = _mm_unpackhi_epi64(s[7], _mm_unpacklo_epi64(t0, t0)); \
+    s[7] = _mm_unpackhi_epi64(t0, _mm_unpacklo_epi64(s[7], s[7])); \
+    s[2] = _mm_unpackhi_epi64(s[2], _mm_unpacklo_epi64(s[3], s[3])); \
+    s[3] = _mm_unpackhi_epi64(s[3], _mm_unpacklo_epi64(t1, t1)); \
+  } while(0)
+
+#define UNDIAGONALIZE_SSE2(s) \
+  do { \
+    __m128i t0 = s[2], t1 = s[6], t2 = s[4]; \
+    s[4] = s[5]; \
+    s[5] = t2; \
+    s[2] = _mm_unpackhi_epi64(s[3], _mm_unpacklo_epi64(s[2], s[2])); \
+    s[3] = _mm_unpackhi_epi64(t0, _mm_unpacklo_epi64(s[3], s[3])); \
+    s[6] = _mm_unpackhi_epi64(s[6], _mm_unpacklo_epi64(s[7], s[7])); \
+    s[7] = _mm_unpackhi_epi64(s[7], _mm_unpacklo_epi64(t1, t1)); \
+  } while(0)
+
+/*One Round of the Blake2b's compression function*/
+#define ROUND_LYRA_SSE2(s) \
+  do { \
+    G_SSE2(s[0], s[2], s[4], s[6]); \
+    G_SSE2(s[1], s[3], s[5], s[7]); \
+    DIAGONALIZE_SSE2(s); \
+    G_SSE2(s[0], s[2], s[4], s[6]); \
+    G_SSE2(s[1], s[3], s[5], s[7]); \
+    UNDIAGONALIZE_SSE2(s); \
+  } while(0)
+
+/*Words (w[2k-1], w[2k]) of the 12-word block held in s[0..5], i.e. rand rotated one word to the left*/
+#define ROTW_SSE2(s, k) \
+  _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(s[((k) + 5) % 6]), _mm_castsi128_pd(s[(k)]), 1))
+
+LYRA2_SSE2 static inline void loadState_sse2(__m128i s[8], const uint64_t *state) {
+    int j;
+    for (j = 0; j < 8; j++)
+        s[j] = _mm_loadu_si128((const __m128i *) state + j);
+}
+
+LYRA2_SSE2 static inline void storeState_sse2(uint64_t *state, const __m128i s[8]) {
+    int j;
+    for (j = 0; j < 8; j++)
+        _mm_storeu_si128((__m128i *) state + j, s[j]);
+}
+
+LYRA2_SSE2 void reducedSqueezeRow0_sse2(uint64_t* state, uint64_t* rowOut, uint64_t nCols) {
+    __m128i *ptrWordOut = (__m128i *) (rowOut + (nCols-1)*BLOCK_LEN_INT64);
+    __m128i s[8];
+    uint64_t i;
+    int j;
+
+    loadState_sse2(s, state);
+    for (i = 0; i < nCols; i++) {
+        for (j = 0; j < 6; j++)
+            _mm_storeu_si128(ptrWordOut + j, s[j]);
+        ptrWordOut -= BLOCK_LEN_INT64 / 2;
+        ROUND_LYRA_SSE2(s);
+    }
+    storeState_sse2(state, s);
+}
+
+LYRA2_SSE2 void reducedDuplexRow1_sse2(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols) {
+    const __m128i *ptrWordIn = (const __m128i *) rowIn;
+    __m128i *ptrWordOut = (__m128i *) (rowOut + (nCols-1)*BLOCK_LEN_INT64);
+    __m128i s[8], in[6];
+    uint64_t i;
+    int j;
+
+    loadState_sse2(s, state);
+    for (i = 0; i < nCols; i++) {
+        for (j = 0; j < 6; j++) {
+            in[j] = _mm_loadu_si128(ptrWordIn + j);
+            s[j] = _mm_xor_si128(s[j], in[j]);
+        }
+        ROUND_LYRA_SSE2(s);
+        for (j = 0; j < 6; j++)
+            _mm_storeu_si128(ptrWordOut + j, _mm_xor_si128(in[j], s[j]));
+        ptrWordIn += BLOCK_LEN_INT64 / 2;
+        ptrWordOut -= BLOCK_LEN_INT64 / 2;
+    }
+    storeState_sse2(state, s);
+}
+
+LYRA2_SSE2 void reducedDuplexRowSetup_sse2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    const __m128i *ptrWordIn = (const __m128i *) rowIn;
+    __m128i *ptrWordInOut = (__m128i *) rowInOut;
+    __m128i *ptrWordOut = (__m128i *) (rowOut + (nCols-1)*BLOCK_LEN_INT64);
+    __m128i s[8], in[6];
+    uint64_t i;
+    int j;
+
+    loadState_sse2(s, state);
+    for (i = 0; i < nCols; i++) {
+        for (j = 0; j < 6; j++) {
+            in[j] = _mm_loadu_si128(ptrWordIn + j);
+            s[j] = _mm_xor_si128(s[j], _mm_add_epi64(in[j], _mm_loadu_si128(ptrWordInOut + j)));
+        }
+        ROUND_LYRA_SSE2(s);
+        for (j = 0; j < 6; j++)
+            _mm_storeu_si128(ptrWordOut + j, _mm_xor_si128(in[j], s[j]));
+        for (j = 0; j < 6; j++)
+            _mm_storeu_si128(ptrWordInOut + j, _mm_xor_si128(_mm_loadu_si128(ptrWordInOut + j), ROTW_SSE2(s, j)));
+        ptrWordIn += BLOCK_LEN_INT64 / 2;
+        ptrWordInOut += BLOCK_LEN_INT64 / 2;
+        ptrWordOut -= BLOCK_LEN_INT64 / 2;
+    }
+    storeState_sse2(state, s);
+}
+
+LYRA2_SSE2 void reducedDuplexRow_sse2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    const __m128i *ptrWordIn = (const __m128i *) rowIn;
+    __m128i *ptrWordInOut = (__m128i *) rowInOut;
+    __m128i *ptrWordOut = (__m128i *) rowOut;
+    __m128i s[8];
+    uint64_t i;
+    int j;
+
+    loadState_sse2(s, state);
+    for (i = 0; i < nCols; i++) {
+        for (j = 0; j < 6; j++)
+            s[j] = _mm_xor_si128(s[j], _mm_add_epi64(_mm_loadu_si128(ptrWordIn + j), _mm_loadu_si128(ptrWordInOut + j)));
+        ROUND_LYRA_SSE2(s);
+        //rowOut and rowInOut may be the same row, so rowInOut is reloaded after rowOut is written
+        for (j = 0; j < 6; j++)
+            _mm_storeu_si128(ptrWordOut + j, _mm_xor_si128(_mm_loadu_si128(ptrWordOut + j), s[j]));
+        for (j = 0; j < 6; j++)
+            _mm_storeu_si128(ptrWordInOut + j, _mm_xor_si128(_mm_loadu_si128(ptrWordInOut + j), ROTW_SSE2(s, j)));
+        ptrWordIn += BLOCK_LEN_INT64 / 2;
+        ptrWordInOut += BLOCK_LEN_INT64 / 2;
+        ptrWordOut += BLOCK_LEN_INT64 / 2;
+    }
+    storeState_sse2(state, s);
+}
+
+#endif
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "activezeronode.h"
+#include "checkqueue.h"
 #include "coincontrol.h"
 #include "consensus/validation.h"
 #include "darksend.h"
@@ -12,6 +13,7 @@
 #include "zeronode-payments.h"
 #include "zeronode-sync.h"
 #include "zeronodeman.h"
+#include "script/sigcache.h"
 #include "script/sign.h"
 #include "txmempool.h"
 #include "util.h"
@@ -2335,27 +2337,131 @@ bool CDarkSendSigner::SignMessage(std::string strMessage, std::vector<unsigned c
     return key.SignCompact(ss.GetHash(), vchSigRet);
 }
 
+namespace {
+
+/**
+ * Cache of valid message signatures. Relayed zeronode messages are checked several times on the way to the
+ * list (SimpleCheck, CheckOutpoint, Update) and again every time a peer sends them.
+ */
+class CMessageSignatureCache : public CSaltedHashSet<>
+{
+public:
+    CMessageSignatureCache() : CSaltedHashSet<>(MESSAGE_SIG_CACHE_SIZE) {}
+
+    //! Entries are SHA256(nonce || message hash || public key || signature)
+    void ComputeEntry(uint256& entry, const uint256& hash, const std::vector<unsigned char>& vchSig, const CPubKey& pubkey)
+    {
+        Salted().Write(hash.begin(), 32).Write(pubkey.begin(), pubkey.size()).Write(vchSig.data(), vchSig.size()).Finalize(entry.begin());
+    }
+};
+
+CMessageSignatureCache messageSignatureCache;
+//! Signatures found invalid, by the entries of messageSignatureCache, so that a bad signature checked ahead of
+//! its message is not checked again when the message is processed. Kept apart so junk can't evict valid entries.
+CSaltedHashSet<> invalidMessageSignatureCache(MESSAGE_SIG_CACHE_SIZE);
+
+}
+
 bool CDarkSendSigner::VerifyMessage(CPubKey pubkey, const std::vector<unsigned char> &vchSig, std::string strMessage, std::string &strErrorRet) {
     CHashWriter ss(SER_GETHASH, 0);
     ss << strMessageMagic;
     ss << strMessage;
+    uint256 hash = ss.GetHash();
+
+    uint256 entry;
+    messageSignatureCache.ComputeEntry(entry, hash, vchSig, pubkey);
+    if (messageSignatureCache.Contains(entry))
+        return true;
+    if (invalidMessageSignatureCache.Contains(entry)) {
+        strErrorRet = "Signature already found invalid.";
+        return false;
+    }
 
     CPubKey pubkeyFromSig;
-    if (!pubkeyFromSig.RecoverCompact(ss.GetHash(), vchSig)) {
+    if (!pubkeyFromSig.RecoverCompact(hash, vchSig)) {
+        invalidMessageSignatureCache.Insert(entry);
         strErrorRet = "Error recovering public key.";
         return false;
     }
 
     if (pubkeyFromSig.GetID() != pubkey.GetID()) {
+        invalidMessageSignatureCache.Insert(entry);
         strErrorRet = strprintf("Keys don't match: pubkey=%s, pubkeyFromSig=%s, strMessage=%s, vchSig=%s",
                                 pubkey.GetID().ToString(), pubkeyFromSig.GetID().ToString(), strMessage,
                                 EncodeBase64(&vchSig[0], vchSig.size()));
         return false;
     }
 
+    messageSignatureCache.Insert(entry);
+    return true;
+}
+
+bool CSignedMessageCheck::operator()() {
+    std::string strError;
+    darkSendSigner.VerifyMessage(pubkey, vchSig, strMessage, strError);
     return true;
 }
 
+static CCheckQueue<CSignedMessageCheck> signedmessagecheckqueue(16);
+
+void ThreadSignedMessageCheck() {
+    RenameThread("zerobitcoin-mnsigch");
+    signedmessagecheckqueue.Thread();
+}
+
+void PreverifyZeronodeMessages(CNode* pnode) {
+    // nothing to gain without threads to share the work with
+    if (fLiteMode || nScriptCheckThreads == 0) return;
+
+    std::vector<CSignedMessageCheck> vChecks;
+    int nMessages = 0;
+    BOOST_FOREACH(CNetMessage& msg, pnode->vRecvMsg) {
+        if (!msg.complete() || nMessages++ >= PRIVATESEND_PREVERIFY_MESSAGES_MAX) break;
+        if (msg.fPreverified) continue;
+        msg.fPreverified = true;
+
+        std::string strCommand = msg.hdr.GetCommand();
+        if (strCommand != NetMsgType::MNANNOUNCE && strCommand != NetMsgType::MNPING &&
+                strCommand != NetMsgType::ZERONODEPAYMENTVOTE)
+            continue;
+
+        try {
+            CDataStream vRecv(msg.vRecv);
+            if (strCommand == NetMsgType::MNANNOUNCE) {
+                CZeronodeBroadcast mnb;
+                vRecv >> mnb;
+                if (mnodeman.HasSeenBroadcast(mnb.GetHash())) continue;
+                vChecks.push_back(CSignedMessageCheck(mnb.pubKeyCollateralAddress, mnb.vchSig, mnb.GetSignatureMessage()));
+                if (mnb.lastPing != CZeronodePing())
+                    vChecks.push_back(CSignedMessageCheck(mnb.pubKeyZeronode, mnb.lastPing.vchSig, mnb.lastPing.GetSignatureMessage()));
+            } else if (strCommand == NetMsgType::MNPING) {
+                CZeronodePing mnp;
+                vRecv >> mnp;
+                if (mnodeman.HasSeenPing(mnp.GetHash())) continue;
+                zeronode_info_t mnInfo = mnodeman.GetZeronodeInfo(mnp.vin);
+                if (mnInfo.fInfoValid)
+                    vChecks.push_back(CSignedMessageCheck(mnInfo.pubKeyZeronode, mnp.vchSig, mnp.GetSignatureMessage()));
+            } else {
+                CZeronodePaymentVote vote;
+                vRecv >> vote;
+                if (mnpayments.HasPaymentVote(vote.GetHash())) continue;
+                zeronode_info_t mnInfo = mnodeman.GetZeronodeInfo(vote.vinZeronode);
+                if (mnInfo.fInfoValid)
+                    vChecks.push_back(CSignedMessageCheck(mnInfo.pubKeyZeronode, vote.vchSig, vote.GetSignatureMessage()));
+            }
+        } catch (const std::exception&) {
+            // malformed messages are dealt with when they are processed
+        }
+    }
+
+    // a single signature is as well checked by the message itself
+    if (vChecks.size() < 2) return;
+
+    CCheckQueueControl<CSignedMessageCheck> control(&signedmessagecheckqueue);
+    control.Add(vChecks);
+    control.Wait();
+}
+
 bool CDarkSendEntry::AddScriptSig(const CTxIn &txin) {
     BOOST_FOREACH(CTxDSIn & txdsin, vecTxDSIn)
     {
@@ -2512,7 +2618,7 @@ void ThreadCheckDarkSendPool() {
 
             nTick++;
 
-            // make sure to check all zeronodes first
+            // make sure to check the zeronodes whose state can have changed first
             mnodeman.Check();
 
             // check if we should activate or ping every few minutes,
@@ -36,6 +36,11 @@ static const int PRIVATESEND_KEYS_THRESHOLD_WARNING = 100;
 // Stop mixing completely, it's too dangerous to continue when we have only this many keys left
 static const int PRIVATESEND_KEYS_THRESHOLD_STOP    = 50;
 
+// Maximum memory used by the zeronode message signature cache, about 1 << 16 entries
+static const size_t MESSAGE_SIG_CACHE_SIZE          = 4 << 20;
+// Number of waiting messages of a peer whose signatures are checked ahead in parallel
+static const int PRIVATESEND_PREVERIFY_MESSAGES_MAX = 256;
+
 // The main object for accessing mixing
 extern CDarksendPool darkSendPool;
 // A helper object for signing messages from Zeronodes
@@ -249,6 +254,29 @@ public:
     bool VerifyMessage(CPubKey pubkey, const std::vector<unsigned char>& vchSig, std::string strMessage, std::string& strErrorRet);
 };
 
+/** Signature of a zeronode message, checked ahead of the message so that VerifyMessage finds it in the cache */
+class CSignedMessageCheck
+{
+private:
+    CPubKey pubkey;
+    std::vector<unsigned char> vchSig;
+    std::string strMessage;
+
+public:
+    CSignedMessageCheck() {}
+    CSignedMessageCheck(const CPubKey& pubkeyIn, const std::vector<unsigned char>& vchSigIn, const std::string& strMessageIn) :
+        pubkey(pubkeyIn), vchSig(vchSigIn), strMessage(strMessageIn) {}
+
+    // always true, bad signatures are reported when their message is processed
+    bool operator()();
+
+    void swap(CSignedMessageCheck& check) {
+        std::swap(pubkey, check.pubkey);
+        vchSig.swap(check.vchSig);
+        strMessage.swap(check.strMessage);
+    }
+};
+
 
 /** Used to keep track of current status of mixing pool
  */
@@ -480,4 +508,10 @@ public:
 
 void ThreadCheckDarkSendPool();
 
+/** Run a thread checking the signatures of zeronode messages */
+void ThreadSignedMessageCheck();
+/** Check the signatures of the zeronode messages waiting from a peer in parallel, before they are processed in order.
+ *  Messages that were already processed are skipped, the in-order path would not check them again. */
+void PreverifyZeronodeMessages(CNode* pnode);
+
 #endif
\ No newline at end of file
@@ -16,6 +16,7 @@
 #include "chainparams.h"
 #include "checkpoints.h"
 #include "compat/sanity.h"
+#include "crypto/Lyra2Z/Lyra2.h"
 #include "consensus/validation.h"
 #include "httpserver.h"
 #include "httprpc.h"
@@ -29,6 +30,7 @@
 #include "rpc/register.h"
 #include "script/standard.h"
 #include "script/sigcache.h"
+#include "primitives/powcache.h"
 #include "scheduler.h"
 #include "timedata.h"
 #include "txdb.h"
@@ -273,6 +275,8 @@ void Shutdown() {
         pcoinscatcher = NULL;
         delete pcoinsdbview;
         pcoinsdbview = NULL;
+        delete pzerocoindb;
+        pzerocoindb = NULL;
         delete pblocktree;
         pblocktree = NULL;
     }
@@ -363,6 +367,9 @@ std::string HelpMessage(HelpMessageMode mode) {
     strUsage += HelpMessageOpt("-checklevel=<n>",
                                strprintf(_("How thorough the block verification of -checkblocks is (0-4, default: %u)"),
                                          DEFAULT_CHECKLEVEL));
+    strUsage += HelpMessageOpt("-checkpowonload=<n>",
+                               strprintf(_("How many of the most recent block headers get their proof-of-work hash recomputed at startup (default: %u, 0 = none)"),
+                                         DEFAULT_CHECKPOWONLOAD));
     strUsage += HelpMessageOpt("-conf=<file>",
                                strprintf(_("Specify configuration file (default: %s)"), BITCOIN_CONF_FILENAME));
     if (mode == HMM_BITCOIND) {
@@ -389,6 +396,9 @@ std::string HelpMessage(HelpMessageMode mode) {
     strUsage += HelpMessageOpt("-par=<n>", strprintf(
             _("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
             -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
+    strUsage += HelpMessageOpt("-zcthreads=<n>", strprintf(
+            _("Set the number of zerocoin proof threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
+            -GetNumCores(), MAX_ZEROCOIN_THREADS, DEFAULT_ZEROCOIN_THREADS));
 #ifndef WIN32
     strUsage += HelpMessageOpt("-pid=<file>", strprintf(_("Specify pid file (default: %s)"), BITCOIN_PID_FILENAME));
 #endif
@@ -573,6 +583,12 @@ std::string HelpMessage(HelpMessageMode mode) {
         strUsage += HelpMessageOpt("-maxsigcachesize=<n>",
                                    strprintf("Limit size of signature cache to <n> MiB (default: %u)",
                                              DEFAULT_MAX_SIG_CACHE_SIZE));
+        strUsage += HelpMessageOpt("-powcachesize=<n>",
+                                   strprintf("Limit size of the block header PoW hash cache to <n> MiB (default: %u)",
+                                             DEFAULT_POW_CACHE_SIZE));
+        strUsage += HelpMessageOpt("-zerocoinspendcachesize=<n>",
+                                   strprintf("Limit size of the verified zerocoin spend cache to <n> MiB (default: %u)",
+                                             DEFAULT_ZEROCOIN_SPEND_CACHE_SIZE));
         strUsage += HelpMessageOpt("-maxtipage=<n>", strprintf(
                 "Maximum tip age in seconds to consider node in initial block download (default: %u)",
                 DEFAULT_MAX_TIP_AGE));
@@ -1185,6 +1201,15 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
     else if (nScriptCheckThreads > MAX_SCRIPTCHECK_THREADS)
         nScriptCheckThreads = MAX_SCRIPTCHECK_THREADS;
 
+    int nZerocoinThreads = GetArg("-zcthreads", DEFAULT_ZEROCOIN_THREADS);
+    if (nZerocoinThreads <= 0)
+        nZerocoinThreads += GetNumCores();
+    if (nZerocoinThreads < 1)
+        nZerocoinThreads = 1;
+    else if (nZerocoinThreads > MAX_ZEROCOIN_THREADS)
+        nZerocoinThreads = MAX_ZEROCOIN_THREADS;
+    libzerocoin::ParallelTasks::SetThreadCount(nZerocoinThreads);
+
     fServer = GetBoolArg("-server", false);
 
     // block pruning; get the amount of disk space (in MiB) to allot for block & undo files
@@ -1256,6 +1281,16 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
 
     nMaxTipAge = GetArg("-maxtipage", DEFAULT_MAX_TIP_AGE);
 
+    int64_t nPoWCacheSize = GetArg("-powcachesize", DEFAULT_POW_CACHE_SIZE);
+    if (nPoWCacheSize < 0)
+        return InitError("powcachesize must be non-negative.");
+    powHashCache.SetMaxUsage((size_t)nPoWCacheSize << 20);
+
+    int64_t nZerocoinSpendCacheSize = GetArg("-zerocoinspendcachesize", DEFAULT_ZEROCOIN_SPEND_CACHE_SIZE);
+    if (nZerocoinSpendCacheSize < 0)
+        return InitError("zerocoinspendcachesize must be non-negative.");
+    zerocoinSpendCache.SetMaxUsage((size_t)nZerocoinSpendCacheSize << 20);
+
     fEnableReplacement = GetBoolArg("-mempoolreplacement", DEFAULT_ENABLE_REPLACEMENT);
     if ((!fEnableReplacement) && mapArgs.count("-mempoolreplacement")) {
         // Minimal effort at forwards compatibility
@@ -1307,6 +1342,9 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
     ECC_Start();
     globalVerifyHandle.reset(new ECCVerifyHandle());
 
+    // Pick the Lyra2 row implementation before any thread starts hashing
+    LogPrintf("Using Lyra2 implementation: %s\n", lyra2_detect_simd());
+
     // Sanity check
     if (!InitSanityCheck())
         return InitError(strprintf(_("Initialization sanity check failed. %s is shutting down."), _(PACKAGE_NAME)));
@@ -1347,9 +1385,12 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
     std::ostringstream strErrors;
 
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
+    LogPrintf("Using %d threads for zerocoin proofs\n", nZerocoinThreads);
     if (nScriptCheckThreads) {
-        for (int i = 0; i < nScriptCheckThreads - 1; i++)
+        for (int i = 0; i < nScriptCheckThreads - 1; i++) {
             threadGroup.create_thread(&ThreadScriptCheck);
+            threadGroup.create_thread(&ThreadSignedMessageCheck);
+        }
     }
 
     // Start the lightweight task scheduler thread
@@ -1578,11 +1619,14 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
                                     (nTotalCache / 4) + (1 << 23)); // use 25%-50% of the remainder for disk cache
     nCoinDBCache = std::min(nCoinDBCache, nMaxCoinsDBCache << 20); // cap total coins db cache
     nTotalCache -= nCoinDBCache;
+    int64_t nZerocoinDBCache = std::min(nTotalCache / 8, nMaxZerocoinDBCache << 20);
+    nTotalCache -= nZerocoinDBCache;
 //    nCoinCacheUsage = nTotalCache; // the rest goes to in-memory cache
     nCoinCacheUsage = nTotalCache / 300;
     LogPrintf("Cache configuration:\n");
     LogPrintf("* Using %.1fMiB for block index database\n", nBlockTreeDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for chain state database\n", nCoinDBCache * (1.0 / 1024 / 1024));
+    LogPrintf("* Using %.1fMiB for zerocoin state database\n", nZerocoinDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for in-memory UTXO set\n", nCoinCacheUsage * (1.0 / 1024 / 1024));
 
     bool fLoaded = false;
@@ -1600,6 +1644,7 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
                 delete pcoinsTip;
                 delete pcoinsdbview;
                 delete pcoinscatcher;
+                delete pzerocoindb;
                 delete pblocktree;
 
                 pblocktree = new CBlockTreeDB(nBlockTreeDBCache, false, fReindex);
@@ -1617,6 +1662,7 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
                 pcoinsdbview = new CCoinsViewDB(nCoinDBCache, false, fReindex || fReindexChainState);
                 pcoinscatcher = new CCoinsViewErrorCatcher(pcoinsdbview);
                 pcoinsTip = new CCoinsViewCache(pcoinscatcher);
+                pzerocoindb = new CZerocoinDB(nZerocoinDBCache, false, fReindex || fReindexChainState);
                 LogPrintf("fReindex = %s\n", fReindex);
                 if (fReindex) {
                     pblocktree->WriteReindexing(true);
@@ -1969,6 +2015,10 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
 
         // Run a thread to flush wallet periodically
         threadGroup.create_thread(boost::bind(&ThreadFlushWalletDB, boost::ref(pwalletMain->strWalletFile)));
+
+        // Keep the zerocoin mint pool filled
+        if (GetArg("-zerocoinmintpool", DEFAULT_ZEROCOIN_MINT_POOL_SIZE) > 0)
+            threadGroup.create_thread(boost::bind(&TraceThread<void (*)()>, "zcmintpool", &ThreadZerocoinMintPool));
     }
 #endif
 
@@ -34,9 +34,9 @@ namespace libzerocoin {
         Bignum r_2 = Bignum::randBignum(params->accumulatorModulus / 4);
         Bignum r_3 = Bignum::randBignum(params->accumulatorModulus / 4);
 
-        this->C_e = g_n.pow_mod(e, params->accumulatorModulus) * h_n.pow_mod(r_1, params->accumulatorModulus);
-        this->C_u = witness.getValue() * h_n.pow_mod(r_2, params->accumulatorModulus);
-        this->C_r = g_n.pow_mod(r_2, params->accumulatorModulus) * h_n.pow_mod(r_3, params->accumulatorModulus);
+        this->C_e = params->accumulatorQRNCommitmentGroup.powG(e, params->accumulatorModulus) * params->accumulatorQRNCommitmentGroup.powH(r_1, params->accumulatorModulus);
+        this->C_u = witness.getValue() * params->accumulatorQRNCommitmentGroup.powH(r_2, params->accumulatorModulus);
+        this->C_r = params->accumulatorQRNCommitmentGroup.powG(r_2, params->accumulatorModulus) * params->accumulatorQRNCommitmentGroup.powH(r_3, params->accumulatorModulus);
 
         Bignum r_alpha = Bignum::randBignum(params->maxCoinValue * Bignum(2).pow(params->k_prime + params->k_dprime));
         if (!(Bignum::randBignum(Bignum(3)) % 2)) {
@@ -78,35 +78,35 @@ namespace libzerocoin {
             r_delta = 0 - r_delta;
         }
 
-        this->st_1 = (sg.pow_mod(r_alpha, params->accumulatorPoKCommitmentGroup.modulus) *
-                      sh.pow_mod(r_phi, params->accumulatorPoKCommitmentGroup.modulus)) %
+        this->st_1 = (params->accumulatorPoKCommitmentGroup.powG(r_alpha, params->accumulatorPoKCommitmentGroup.modulus) *
+                      params->accumulatorPoKCommitmentGroup.powH(r_phi, params->accumulatorPoKCommitmentGroup.modulus)) %
                      params->accumulatorPoKCommitmentGroup.modulus;
-        this->st_2 = (((commitmentToCoin.getCommitmentValue() *
-                        sg.inverse(params->accumulatorPoKCommitmentGroup.modulus)).pow_mod(r_gamma,
-                                                                                           params->accumulatorPoKCommitmentGroup.modulus)) *
-                      sh.pow_mod(r_psi, params->accumulatorPoKCommitmentGroup.modulus)) %
+        this->st_2 = (params->accumulatorPoKCommitmentGroup.powMod(commitmentToCoin.getCommitmentValue() *
+                                                                   sg.inverse(params->accumulatorPoKCommitmentGroup.modulus),
+                                                                   r_gamma, params->accumulatorPoKCommitmentGroup.modulus) *
+                      params->accumulatorPoKCommitmentGroup.powH(r_psi, params->accumulatorPoKCommitmentGroup.modulus)) %
                      params->accumulatorPoKCommitmentGroup.modulus;
-        this->st_3 = ((sg * commitmentToCoin.getCommitmentValue()).pow_mod(r_sigma,
-                                                                           params->accumulatorPoKCommitmentGroup.modulus) *
-                      sh.pow_mod(r_xi, params->accumulatorPoKCommitmentGroup.modulus)) %
+        this->st_3 = (params->accumulatorPoKCommitmentGroup.powMod(sg * commitmentToCoin.getCommitmentValue(),
+                                                                   r_sigma, params->accumulatorPoKCommitmentGroup.modulus) *
+                      params->accumulatorPoKCommitmentGroup.powH(r_xi, params->accumulatorPoKCommitmentGroup.modulus)) %
                      params->accumulatorPoKCommitmentGroup.modulus;
 
         this->t_1 =
-                (h_n.pow_mod(r_zeta, params->accumulatorModulus) * g_n.pow_mod(r_epsilon, params->accumulatorModulus)) %
+                (params->accumulatorQRNCommitmentGroup.powH(r_zeta, params->accumulatorModulus) * params->accumulatorQRNCommitmentGroup.powG(r_epsilon, params->accumulatorModulus)) %
                 params->accumulatorModulus;
         this->t_2 =
-                (h_n.pow_mod(r_eta, params->accumulatorModulus) * g_n.pow_mod(r_alpha, params->accumulatorModulus)) %
+                (params->accumulatorQRNCommitmentGroup.powH(r_eta, params->accumulatorModulus) * params->accumulatorQRNCommitmentGroup.powG(r_alpha, params->accumulatorModulus)) %
                 params->accumulatorModulus;
-        this->t_3 = (C_u.pow_mod(r_alpha, params->accumulatorModulus) *
-                     ((h_n.inverse(params->accumulatorModulus)).pow_mod(r_beta, params->accumulatorModulus))) %
+        this->t_3 = (params->accumulatorQRNCommitmentGroup.powMod(C_u, r_alpha, params->accumulatorModulus) *
+                     (params->accumulatorQRNCommitmentGroup.powH(0 - r_beta, params->accumulatorModulus))) %
                     params->accumulatorModulus;
-        this->t_4 = (C_r.pow_mod(r_alpha, params->accumulatorModulus) *
-                     ((h_n.inverse(params->accumulatorModulus)).pow_mod(r_delta, params->accumulatorModulus)) *
-                     ((g_n.inverse(params->accumulatorModulus)).pow_mod(r_beta, params->accumulatorModulus))) %
+        this->t_4 = (params->accumulatorQRNCommitmentGroup.powMod(C_r, r_alpha, params->accumulatorModulus) *
+                     (params->accumulatorQRNCommitmentGroup.powH(0 - r_delta, params->accumulatorModulus)) *
+                     (params->accumulatorQRNCommitmentGroup.powG(0 - r_beta, params->accumulatorModulus))) %
                     params->accumulatorModulus;
 
-        CHashWriter hasher(0, 0);
-        hasher << *params << sg << sh << g_n << h_n << commitmentToCoin.getCommitmentValue() << C_e << C_u << C_r
+        CHashWriter hasher = params->getTranscript();
+        hasher << sg << sh << g_n << h_n << commitmentToCoin.getCommitmentValue() << C_e << C_u << C_r
                << st_1 << st_2 << st_3 << t_1 << t_2 << t_3 << t_4;
 
         //According to the proof, this hash should be of length k_prime bits.  It is currently greater than that, which should not be a problem, but we should check this.
@@ -138,44 +138,27 @@ namespace libzerocoin {
 
 
         //According to the proof, this hash should be of length k_prime bits.  It is currently greater than that, which should not be a problem, but we should check this.
-        CHashWriter hasher(0, 0);
-        hasher << *params << sg << sh << g_n << h_n << valueOfCommitmentToCoin << C_e << C_u << C_r << st_1 << st_2
+        CHashWriter hasher = params->getTranscript();
+        hasher << sg << sh << g_n << h_n << valueOfCommitmentToCoin << C_e << C_u << C_r << st_1 << st_2
                << st_3 << t_1 << t_2 << t_3 << t_4;
 
         Bignum c = Bignum(hasher.GetHash()); //this hash should be of length k_prime bits
 
-        Bignum st_1_prime = (valueOfCommitmentToCoin.pow_mod(c, params->accumulatorPoKCommitmentGroup.modulus) *
-                             sg.pow_mod(s_alpha, params->accumulatorPoKCommitmentGroup.modulus) *
-                             sh.pow_mod(s_phi, params->accumulatorPoKCommitmentGroup.modulus)) %
-                            params->accumulatorPoKCommitmentGroup.modulus;
-        Bignum st_2_prime = (sg.pow_mod(c, params->accumulatorPoKCommitmentGroup.modulus) * ((valueOfCommitmentToCoin *
-                                                                                              sg.inverse(
-                                                                                                      params->accumulatorPoKCommitmentGroup.modulus)).pow_mod(
-                s_gamma, params->accumulatorPoKCommitmentGroup.modulus)) *
-                             sh.pow_mod(s_psi, params->accumulatorPoKCommitmentGroup.modulus)) %
-                            params->accumulatorPoKCommitmentGroup.modulus;
-        Bignum st_3_prime = (sg.pow_mod(c, params->accumulatorPoKCommitmentGroup.modulus) *
-                             (sg * valueOfCommitmentToCoin).pow_mod(s_sigma,
-                                                                    params->accumulatorPoKCommitmentGroup.modulus) *
-                             sh.pow_mod(s_xi, params->accumulatorPoKCommitmentGroup.modulus)) %
-                            params->accumulatorPoKCommitmentGroup.modulus;
-
-        Bignum t_1_prime =
-                (C_r.pow_mod(c, params->accumulatorModulus) * h_n.pow_mod(s_zeta, params->accumulatorModulus) *
-                 g_n.pow_mod(s_epsilon, params->accumulatorModulus)) % params->accumulatorModulus;
-        Bignum t_2_prime =
-                (C_e.pow_mod(c, params->accumulatorModulus) * h_n.pow_mod(s_eta, params->accumulatorModulus) *
-                 g_n.pow_mod(s_alpha, params->accumulatorModulus)) % params->accumulatorModulus;
-
-        Bignum t_3_prime = ((a.getValue()).pow_mod(c, params->accumulatorModulus) *
-                            C_u.pow_mod(s_alpha, params->accumulatorModulus) *
-                            ((h_n.inverse(params->accumulatorModulus)).pow_mod(s_beta, params->accumulatorModulus))) %
-                           params->accumulatorModulus;
-
-        Bignum t_4_prime = (C_r.pow_mod(s_alpha, params->accumulatorModulus) *
-                            ((h_n.inverse(params->accumulatorModulus)).pow_mod(s_delta, params->accumulatorModulus)) *
-                            ((g_n.inverse(params->accumulatorModulus)).pow_mod(s_beta, params->accumulatorModulus))) %
-                           params->accumulatorModulus;
+        // Each check value is one product of powers: the generators come from the
+        // fixed-base tables, the other bases share one chain of squarings
+        const IntegerGroupParams &pok = params->accumulatorPoKCommitmentGroup;
+        const IntegerGroupParams &qrn = params->accumulatorQRNCommitmentGroup;
+        const Bignum &N = params->accumulatorModulus;
+
+        Bignum st_1_prime = pok.multiPow(s_alpha, s_phi, {valueOfCommitmentToCoin}, {c}, pok.modulus);
+        Bignum st_2_prime = pok.multiPow(c, s_psi, {valueOfCommitmentToCoin * sg.inverse(pok.modulus)}, {s_gamma},
+                                         pok.modulus);
+        Bignum st_3_prime = pok.multiPow(c, s_xi, {sg * valueOfCommitmentToCoin}, {s_sigma}, pok.modulus);
+
+        Bignum t_1_prime = qrn.multiPow(s_epsilon, s_zeta, {C_r}, {c}, N);
+        Bignum t_2_prime = qrn.multiPow(s_alpha, s_eta, {C_e}, {c}, N);
+        Bignum t_3_prime = qrn.multiPow(0, 0 - s_beta, {a.getValue(), C_u}, {c, s_alpha}, N);
+        Bignum t_4_prime = qrn.multiPow(0 - s_beta, 0 - s_delta, {C_r}, {s_alpha}, N);
 
         bool result = false;
 
@@ -0,0 +1,80 @@
+/**
+ * @file       BatchVerifier.cpp
+ *
+ * @brief      Verification of several coin spends at once.
+ *
+ * @license    This project is released under the MIT license.
+ **/
+
+#include "Zerocoin.h"
+#include "BatchVerifier.h"
+#include "ParallelTasks.h"
+
+namespace libzerocoin {
+
+BatchVerifier::BatchVerifier(const Params* p): params(p) { }
+
+size_t BatchVerifier::Add(const CoinSpend& spend, const Accumulator& a, const SpendMetaData& m) {
+	entries.push_back(Entry(spend, a, m));
+	return entries.size() - 1;
+}
+
+bool BatchVerifier::Verify() {
+	ParallelTasks::DoNotDisturb dnd;
+
+	std::vector<Entry*> pending;
+	for (Entry &entry: entries) {
+		const CoinSpend &spend = *entry.spend;
+		entry.fValid = false;
+		if (!spend.HasValidSerial() || entry.accumulator.getDenomination() != spend.denomination ||
+		        !spend.serialNumberSoK.HasValidSize())
+			continue;
+		entry.metahash = spend.signatureHash(entry.metaData);
+		entry.fCommitmentPoK = entry.fAccumulatorPoK = false;
+		entry.tprime.assign(params->zkp_iterations, Bignum(0));
+		pending.push_back(&entry);
+	}
+
+	// A job that throws leaves its result false or its commitment zero, which fails the
+	// spend the same way an exception fails CoinSpend::Verify()
+	ParallelTasks jobs(pending.size() * (params->zkp_iterations + 2));
+	for (Entry *pentry: pending) {
+		const CoinSpend &spend = *pentry->spend;
+		jobs.Add([pentry, &spend] {
+			try {
+				pentry->fCommitmentPoK = spend.commitmentPoK.Verify(spend.serialCommitmentToCoinValue,
+				                                                    spend.accCommitmentToCoinValue);
+			} catch (const std::exception &) {}
+		});
+		jobs.Add([pentry, &spend] {
+			try {
+				pentry->fAccumulatorPoK = spend.accumulatorPoK.Verify(pentry->accumulator, spend.accCommitmentToCoinValue);
+			} catch (const std::exception &) {}
+		});
+		for (uint32_t i = 0; i < params->zkp_iterations; i++) {
+			jobs.Add([pentry, &spend, i] {
+				try {
+					pentry->tprime[i] = spend.serialNumberSoK.ChallengeResponse(i, spend.coinSerialNumber,
+					                                                            spend.serialCommitmentToCoinValue);
+				} catch (const std::exception &) {}
+			});
+		}
+	}
+	jobs.Wait();
+
+	for (Entry *pentry: pending) {
+		const CoinSpend &spend = *pentry->spend;
+		pentry->fValid = pentry->fCommitmentPoK && pentry->fAccumulatorPoK
+		        && spend.serialNumberSoK.VerifyChallengeResponses(spend.coinSerialNumber, spend.serialCommitmentToCoinValue,
+		                spend.version == ZEROCOIN_TX_VERSION_1_5 ? pentry->metahash : uint256(), pentry->tprime)
+		        && spend.VerifySignature(pentry->metahash);
+		pentry->tprime.clear();
+	}
+
+	bool fAllValid = true;
+	for (const Entry &entry: entries)
+		fAllValid = fAllValid && entry.fValid;
+	return fAllValid;
+}
+
+} /* namespace libzerocoin */
@@ -0,0 +1,83 @@
+/**
+ * @file       BatchVerifier.h
+ *
+ * @brief      Verification of several coin spends at once.
+ *
+ * @license    This project is released under the MIT license.
+ **/
+
+#ifndef BATCHVERIFIER_H_
+#define BATCHVERIFIER_H_
+
+#include "Zerocoin.h"
+
+#include <vector>
+
+namespace libzerocoin {
+
+/**
+ * Verifies a number of CoinSpend proofs together.
+ *
+ * CoinSpend::Verify() checks the commitment proof, the accumulator proof and the
+ * serial number signature one after another, and only the iterations of the last one
+ * run in parallel. The batch verifier cuts the proofs of all the spends into independent
+ * jobs (one per commitment proof, one per accumulator proof and one per signature
+ * iteration) and runs them on the thread pool together, so that a block with a few
+ * spends keeps every core busy until its last proof is done.
+ *
+ * The result of every spend is exactly that of CoinSpend::Verify() with the same
+ * accumulator and metadata. Random linear combinations of the verification equations
+ * are deliberately not used: the proofs carry group elements chosen by the prover, and
+ * a pair of equations each off by an element of order 2 could pass a combined check
+ * while failing on their own, which would split the nodes that batch from the ones
+ * that do not.
+ */
+class BatchVerifier {
+public:
+	BatchVerifier(const Params* p);
+
+	/**
+	 * Queues a spend to be verified against the given accumulator.
+	 * The spend must outlive the call to Verify().
+	 *
+	 * @return the index of the spend for GetResult()
+	 */
+	size_t Add(const CoinSpend& spend, const Accumulator& a, const SpendMetaData& m);
+
+	/**
+	 * Verifies every spend queued since the last call.
+	 *
+	 * @return true if all of them verify
+	 */
+	bool Verify();
+
+	/** Outcome of the spend with the given index in the last Verify() */
+	bool GetResult(size_t i) const { return entries[i].fValid; }
+
+	size_t size() const { return entries.size(); }
+	void Clear() { entries.clear(); }
+
+private:
+	struct Entry {
+		const CoinSpend *spend;
+		Accumulator accumulator;
+		SpendMetaData metaData;
+		uint256 metahash;
+		// results of the jobs, each one written by a single thread
+		bool fCommitmentPoK;
+		bool fAccumulatorPoK;
+		std::vector<Bignum> tprime;
+		bool fValid;
+
+		Entry(const CoinSpend &spendIn, const Accumulator &a, const SpendMetaData &m)
+			: spend(&spendIn), accumulator(a), metaData(m), fCommitmentPoK(false), fAccumulatorPoK(false),
+			  fValid(false) {}
+	};
+
+	const Params* params;
+	std::vector<Entry> entries;
+};
+
+} /* namespace libzerocoin */
+
+#endif /* BATCHVERIFIER_H_ */
@@ -365,6 +365,58 @@ Test_MintAndSpend()
 	return false;
 }
 
+bool
+Test_BatchVerify()
+{
+	try {
+		if (gCoins[0] == NULL)
+		{
+			Test_MintCoin();
+			if (gCoins[0] == NULL) {
+				return false;
+			}
+		}
+
+		Accumulator acc(&g_Params->accumulatorParams);
+		AccumulatorWitness wAcc(g_Params, acc, gCoins[0]->getPublicCoin());
+		for (uint32_t i = 0; i < TESTS_COINS_TO_ACCUMULATE; i++) {
+			acc += gCoins[i]->getPublicCoin();
+			wAcc += gCoins[i]->getPublicCoin();
+		}
+
+		SpendMetaData m(1,1);
+		CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+		ss << CoinSpend(g_Params, *(gCoins[0]), acc, wAcc, m);
+		CoinSpend spend(g_Params, ss);
+
+		// The same proof is queued over and over, its cost does not depend on the coin
+		for (uint32_t nBatch = 1; nBatch <= 64; nBatch *= 2) {
+			BatchVerifier batch(g_Params);
+			for (uint32_t i = 0; i < nBatch; i++) {
+				batch.Add(spend, acc, m);
+			}
+
+			timer.start();
+			bool ret = batch.Verify();
+			timer.stop();
+
+			if (!ret) {
+				return false;
+			}
+
+			int duration = timer.duration() > 0 ? timer.duration() : 1;
+			cout << "\tBATCH OF " << nBatch << " VERIFY ELAPSED TIME: " << timer.duration() << " ms\t" << nBatch * 1000.0 / duration << " spends/s" << endl;
+		}
+
+		return true;
+	} catch (runtime_error &e) {
+		cout << e.what() << endl;
+		return false;
+	}
+
+	return false;
+}
+
 void
 Test_RunAllTests()
 {
@@ -384,6 +436,7 @@ Test_RunAllTests()
 	LogTestResult("coins can be minted", Test_MintCoin);
 	LogTestResult("the accumulator works", Test_Accumulator);
 	LogTestResult("a minted coin can be spent", Test_MintAndSpend);
+	LogTestResult("spends can be verified in batches", Test_BatchVerify);
 
 	// Summarize test results
 	if (gSuccessfulTests < gNumTests) {
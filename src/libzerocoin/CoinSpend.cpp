@@ -103,41 +103,42 @@ bool CoinSpend::Verify(const Accumulator& a, const SpendMetaData &m) const {
             return false;
     }
 
+    return VerifySignature(metahash);
+}
 
+bool CoinSpend::VerifySignature(const uint256 &metahash) const {
     if (this->version != 2) {
-        return ret;
+        return true;
     }
-    else {
-        // Check if this is a coin that requires a signatures
-        if (coinSerialNumber.bitSize() > 160)
-            return false;
 
-        // Check sizes
-        if (this->ecdsaPubkey.size() != 33 || this->ecdsaSignature.size() != 64) {
-            return false;
-        }
+    // Check if this is a coin that requires a signatures
+    if (coinSerialNumber.bitSize() > 160)
+        return false;
 
-        // Verify signature
-        secp256k1_pubkey pubkey;
-        secp256k1_ecdsa_signature signature;
+    // Check sizes
+    if (this->ecdsaPubkey.size() != 33 || this->ecdsaSignature.size() != 64) {
+        return false;
+    }
 
-        if (!secp256k1_ec_pubkey_parse(ctx, &pubkey, ecdsaPubkey.data(), 33)) {
-            return false;
-        }
+    // Verify signature
+    secp256k1_pubkey pubkey;
+    secp256k1_ecdsa_signature signature;
 
-        // Recompute and compare hash of public key
-        if (coinSerialNumber != PrivateCoin::serialNumberFromSerializedPublicKey(ctx, &pubkey)) {
-            return false;
-        }
+    if (!secp256k1_ec_pubkey_parse(ctx, &pubkey, ecdsaPubkey.data(), 33)) {
+        return false;
+    }
 
-        secp256k1_ecdsa_signature_parse_compact(ctx, &signature, ecdsaSignature.data());
-        if (!secp256k1_ecdsa_verify(ctx, &signature, metahash.begin(), &pubkey)) {
-            return false;
-        }
+    // Recompute and compare hash of public key
+    if (coinSerialNumber != PrivateCoin::serialNumberFromSerializedPublicKey(ctx, &pubkey)) {
+        return false;
+    }
 
-        return true;
+    secp256k1_ecdsa_signature_parse_compact(ctx, &signature, ecdsaSignature.data());
+    if (!secp256k1_ecdsa_verify(ctx, &signature, metahash.begin(), &pubkey)) {
+        return false;
     }
 
+    return true;
 }
 
 bool CoinSpend::HasValidSerial() const { 
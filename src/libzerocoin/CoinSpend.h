@@ -142,8 +142,13 @@ public:
 	}
 
 private:
+	// verifies the sub-proofs of many spends at once
+	friend class BatchVerifier;
+
 	const Params *params;
     const uint256 signatureHash(const SpendMetaData &m) const;
+	// the ECDSA signature of a version 2 spend, true for the other versions
+	bool VerifySignature(const uint256 &metahash) const;
 	// Denomination is stored as an INT because storing
 	// and enum raises amigiuities in the serialize code //FIXME if possible
 	int denomination;
@@ -0,0 +1,89 @@
+/**
+ * @file       FixedBaseExp.cpp
+ *
+ * @brief      Precomputed modular exponentiation for a fixed base.
+ *
+ * @license    This project is released under the MIT license.
+ **/
+
+#include "Zerocoin.h"
+
+namespace libzerocoin {
+
+FixedBaseExp::FixedBaseExp(const Bignum& base, const Bignum& modulus, uint32_t maxBits, uint32_t windowBits)
+	: base(base), modulus(modulus), maxBits(maxBits), windowBits(windowBits), mont(NULL) {
+	if (windowBits < 1 || windowBits > 16 || !BN_is_odd(&modulus))
+		throw bignum_error("FixedBaseExp : unsupported window size or even modulus");
+
+	CAutoBN_CTX pctx;
+	mont = BN_MONT_CTX_new();
+	if (mont == NULL || !BN_MONT_CTX_set(mont, &modulus, pctx)) {
+		BN_MONT_CTX_free(mont);
+		throw bignum_error("FixedBaseExp : BN_MONT_CTX_set failed");
+	}
+
+	Bignum one = 1;
+	if (!BN_to_montgomery(&montOne, &one, mont, pctx))
+		throw bignum_error("FixedBaseExp : BN_to_montgomery failed");
+
+	const uint32_t nDigits = (1u << windowBits) - 1;
+	const uint32_t nWindows = (maxBits + windowBits - 1) / windowBits;
+	table.resize((size_t)nWindows * nDigits);
+
+	// power = base^(2^(windowBits * i)), reduced first as the base may exceed the modulus
+	Bignum power = base % modulus;
+	if (power < 0)
+		power += modulus;
+	if (!BN_to_montgomery(&power, &power, mont, pctx))
+		throw bignum_error("FixedBaseExp : BN_to_montgomery failed");
+	for (size_t row = 0; row < table.size(); row += nDigits) {
+		table[row] = power;
+		for (uint32_t d = 1; d < nDigits; d++) {
+			if (!BN_mod_mul_montgomery(&table[row + d], &table[row + d - 1], &power, mont, pctx))
+				throw bignum_error("FixedBaseExp : BN_mod_mul_montgomery failed");
+		}
+		if (!BN_mod_mul_montgomery(&power, &table[row + nDigits - 1], &power, mont, pctx))
+			throw bignum_error("FixedBaseExp : BN_mod_mul_montgomery failed");
+	}
+}
+
+FixedBaseExp::~FixedBaseExp() {
+	BN_MONT_CTX_free(mont);
+}
+
+Bignum FixedBaseExp::pow_mod(const Bignum& e) const {
+	if ((uint32_t)e.bitSize() > maxBits)
+		return base.pow_mod(e, modulus);
+
+	const uint32_t nDigits = (1u << windowBits) - 1;
+	const int nBits = e.bitSize();
+	CAutoBN_CTX pctx;
+	Bignum result = montOne;
+	for (int bit = 0, i = 0; bit < nBits; bit += windowBits, i++) {
+		uint32_t d = 0;
+		for (uint32_t j = 0; j < windowBits; j++) {
+			if (BN_is_bit_set(&e, bit + j))
+				d |= 1u << j;
+		}
+		if (d != 0 && !BN_mod_mul_montgomery(&result, &result, &table[(size_t)i * nDigits + d - 1], mont, pctx))
+			throw bignum_error("FixedBaseExp::pow_mod : BN_mod_mul_montgomery failed");
+	}
+	if (!BN_from_montgomery(&result, &result, mont, pctx))
+		throw bignum_error("FixedBaseExp::pow_mod : BN_from_montgomery failed");
+
+	// g^-x = (g^x)^-1, the bits above are those of |e|
+	if (e < 0)
+		return result.inverse(modulus);
+	return result;
+}
+
+size_t FixedBaseExp::memoryUsage() const {
+	return memoryUsage(modulus, maxBits, windowBits);
+}
+
+size_t FixedBaseExp::memoryUsage(const Bignum& modulus, uint32_t maxBits, uint32_t windowBits) {
+	const size_t nWindows = (maxBits + windowBits - 1) / windowBits;
+	return nWindows * ((1u << windowBits) - 1) * (size_t)BN_num_bytes(&modulus);
+}
+
+} /* namespace libzerocoin */
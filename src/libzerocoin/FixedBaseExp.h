@@ -0,0 +1,66 @@
+/**
+ * @file       FixedBaseExp.h
+ *
+ * @brief      Precomputed modular exponentiation for a fixed base.
+ *
+ * @license    This project is released under the MIT license.
+ **/
+
+#ifndef FIXEDBASEEXP_H_
+#define FIXEDBASEEXP_H_
+
+#include "Zerocoin.h"
+
+#include <vector>
+
+namespace libzerocoin {
+
+/**
+ * Modular exponentiation of a fixed base using a table of precomputed powers.
+ *
+ * The exponent is cut into windows of windowBits bits, and base^(d * 2^(windowBits * i))
+ * is stored in Montgomery form for every window i and every non-zero digit d. Raising the
+ * base to a power then takes one Montgomery multiplication per non-zero window, and no
+ * squarings at all. Negative exponents are supported; exponents longer than the table
+ * fall back to BN_mod_exp.
+ */
+class FixedBaseExp {
+public:
+	/**
+	 * @param base the base
+	 * @param modulus an odd modulus
+	 * @param maxBits the longest exponent covered by the table
+	 * @param windowBits bits of the exponent handled by one table lookup
+	 */
+	FixedBaseExp(const Bignum& base, const Bignum& modulus, uint32_t maxBits, uint32_t windowBits);
+	~FixedBaseExp();
+
+	/** base^e mod modulus, identical to base.pow_mod(e, modulus) */
+	Bignum pow_mod(const Bignum& e) const;
+
+	const Bignum& getModulus() const { return modulus; }
+
+	/** Size of the table in bytes */
+	size_t memoryUsage() const;
+
+	/** Table size in bytes for the given parameters, without building it */
+	static size_t memoryUsage(const Bignum& modulus, uint32_t maxBits, uint32_t windowBits);
+
+private:
+	FixedBaseExp(const FixedBaseExp&);
+	FixedBaseExp& operator=(const FixedBaseExp&);
+
+	Bignum base;
+	Bignum modulus;
+	uint32_t maxBits;
+	uint32_t windowBits;
+	BN_MONT_CTX *mont;
+	// (2^windowBits - 1) entries per window, digit d of window i at i * (2^windowBits - 1) + d - 1
+	std::vector<Bignum> table;
+	// 1 in Montgomery form
+	Bignum montOne;
+};
+
+} /* namespace libzerocoin */
+
+#endif /* FIXEDBASEEXP_H_ */
@@ -1,5 +1,6 @@
 #include "Zerocoin.h"
 #include "ParallelTasks.h"
+#include "../util.h"
 
 #define BOOST_THREAD_PROVIDES_FUTURE
 
@@ -7,9 +8,12 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/future.hpp>
+#include <boost/thread/tss.hpp>
 #include <boost/chrono.hpp>
 
-#include <queue>
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <vector>
 #include <list>
 #include <algorithm>
@@ -17,94 +21,264 @@
 
 namespace libzerocoin {
 
-#ifdef ZEROCOIN_THREADING
+typedef boost::chrono::steady_clock Clock;
+
+struct ParallelTasks::Task {
+    boost::packaged_task<void> job;
+    // shared futures, unlike boost::future these don't depend on BOOST_THREAD_PROVIDES_FUTURE being set
+    // before the first boost thread header of the file including ParallelTasks.h
+    boost::shared_future<void> result;
+    Clock::time_point queued;
+    bool fHighPriority;
+    // set by the thread that runs the task, a pool thread or the one waiting for it
+    std::atomic<bool> fTaken;
+
+    Task(function<void()> task, bool fHighPriorityIn) : job(std::move(task)), queued(Clock::now()),
+                                                        fHighPriority(fHighPriorityIn), fTaken(false) {
+        result = job.get_future().share();
+    }
+};
+
+typedef std::shared_ptr<ParallelTasks::Task> TaskPtr;
+
+namespace {
 
-// Number of seconds before thread shuts down if idle
-constexpr static int secondsBeforeThreadShutdown = 10;
+// What the pool needs to know about the calling thread
+struct ThreadState {
+    // index of the pool thread, -1 for the other threads
+    int nWorker;
+    // number of ParallelTasks::HighPriority instances alive on the thread
+    int nHighPriority;
 
-// Simple thread pool class for using multiple cores effeciently
+    ThreadState() : nWorker(-1), nHighPriority(0) {}
+};
+
+boost::thread_specific_ptr<ThreadState> threadState;
+
+ThreadState &GetThreadState() {
+    if (threadState.get() == NULL)
+        threadState.reset(new ThreadState());
+    return *threadState;
+}
+
+}
+
+#ifdef ZEROCOIN_THREADING
+
+// Work-stealing thread pool for using multiple cores effeciently. Every thread has its own deque, taking
+// tasks from its front and stealing from the back of the others when it runs out. Tasks added by block
+// validation go to a separate lane that is always served first, so a long proof job from the wallet or
+// RPC only delays them by the tasks already running. A task is also listed by the ParallelTasks instance that
+// added it, whose Wait() runs it if no pool thread has taken it yet; the queues skip tasks taken that way.
+// Threads live as long as the process.
 
 static class ParallelOpThreadPool {
 private:
+    struct Worker {
+        boost::mutex cs;
+        std::deque<TaskPtr> tasks;
+    };
+
+    // protects the high priority lane and the startup, and is the one idle threads sleep on
+    boost::mutex                              cs;
+    boost::condition_variable                 cond;
+    std::deque<TaskPtr>                       highPriorityTasks;
+    std::vector<std::unique_ptr<Worker>>      workers;
     std::list<boost::thread>                  threads;
-    std::queue<boost::packaged_task<void>>    taskQueue;
-    boost::mutex                              taskQueueMutex;
-    boost::condition_variable                 taskQueueCondition;
-
-    bool                                      shutdown;
     size_t                                    numberOfThreads;
+    std::atomic<bool>                         started;
+    bool                                      shutdown;
 
-    void ThreadProc() {
-        for (;;) {
-            boost::packaged_task<void> job;
-            {
-                boost::unique_lock<boost::mutex> lock(taskQueueMutex);
-
-                taskQueueCondition.wait_for(lock, boost::chrono::seconds(secondsBeforeThreadShutdown),
-                                            [this] { return !taskQueue.empty() || shutdown; });
-                if (taskQueue.empty()) {
-                    // Either timeout or shutdown. If it's a timeout we need to delete ourself from the thread list and detach the thread
-                    // In case of shutdown thread list will be empty and destructor will wait for this thread completion
-                    boost::thread::id currentId = boost::this_thread::get_id();
-                    auto pThread = find_if(threads.begin(), threads.end(), [=](const boost::thread &t) { return t.get_id() == currentId; });
-                    if (pThread != threads.end()) {
-                        pThread->detach();
-                        threads.erase(pThread);
-                    }
-                    break;
+    // tasks not taken yet in both lanes and in the first one, only increased with cs held so that idle
+    // threads don't miss them
+    std::atomic<int64_t>                      nQueued;
+    std::atomic<int64_t>                      nHighPriorityQueued;
+    std::atomic<size_t>                       nNextWorker;
+
+    std::atomic<uint64_t>                     nHighPriorityTasks;
+    std::atomic<uint64_t>                     nHighPriorityLatency;
+    std::atomic<uint64_t>                     nMaxHighPriorityLatency;
+    std::atomic<uint64_t>                     nTasks;
+    std::atomic<uint64_t>                     nLatency;
+    std::atomic<uint64_t>                     nMaxLatency;
+    std::atomic<uint64_t>                     nStolen;
+
+    void Start() {
+        boost::lock_guard<boost::mutex> lock(cs);
+        if (started)
+            return;
+        for (size_t i = 0; i < numberOfThreads; i++)
+            workers.emplace_back(new Worker());
+        for (size_t i = 0; i < numberOfThreads; i++)
+            threads.emplace_back(std::bind(&ParallelOpThreadPool::ThreadProc, this, (int)i));
+        started = true;
+    }
+
+    static void UpdateMax(std::atomic<uint64_t> &max, uint64_t value) {
+        uint64_t current = max;
+        while (value > current && !max.compare_exchange_weak(current, value)) {}
+    }
+
+    // Claim the task for the calling thread, false if another thread already has
+    bool Claim(ParallelTasks::Task &task) {
+        if (task.fTaken.exchange(true))
+            return false;
+        nQueued--;
+        if (task.fHighPriority)
+            nHighPriorityQueued--;
+        return true;
+    }
+
+    void Run(ParallelTasks::Task &task) {
+        uint64_t latency = boost::chrono::duration_cast<boost::chrono::microseconds>(Clock::now() - task.queued).count();
+        if (task.fHighPriority) {
+            nHighPriorityTasks++;
+            nHighPriorityLatency += latency;
+            UpdateMax(nMaxHighPriorityLatency, latency);
+        }
+        else {
+            nTasks++;
+            nLatency += latency;
+            UpdateMax(nMaxLatency, latency);
+        }
+        task.job();
+    }
+
+    // Take the next task for the given pool thread: high priority ones first, then its own, then stolen ones.
+    // Tasks already run by the thread waiting for them are dropped on the way
+    bool Take(int nWorker, TaskPtr &task) {
+        {
+            boost::lock_guard<boost::mutex> lock(cs);
+            while (!highPriorityTasks.empty()) {
+                task = std::move(highPriorityTasks.front());
+                highPriorityTasks.pop_front();
+                if (Claim(*task))
+                    return true;
+            }
+        }
+
+        {
+            Worker &worker = *workers[nWorker];
+            boost::lock_guard<boost::mutex> lock(worker.cs);
+            while (!worker.tasks.empty()) {
+                task = std::move(worker.tasks.front());
+                worker.tasks.pop_front();
+                if (Claim(*task))
+                    return true;
+            }
+        }
+
+        for (size_t i = 1; i <= workers.size(); i++) {
+            Worker &victim = *workers[(nWorker + i) % workers.size()];
+            boost::lock_guard<boost::mutex> lock(victim.cs);
+            while (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.back());
+                victim.tasks.pop_back();
+                if (Claim(*task)) {
+                    nStolen++;
+                    return true;
                 }
-                job = std::move(taskQueue.front());
-                taskQueue.pop();
             }
-            job();
         }
+        return false;
     }
 
-    void StartThreads() {
-        // should be called with mutex aquired
-        // start missing threads
-        while(threads.size() < numberOfThreads)
-            threads.emplace_back(std::bind(&ParallelOpThreadPool::ThreadProc, this));
+    void ThreadProc(int nWorker) {
+        RenameThread("zerobitcoin-zcpool");
+        GetThreadState().nWorker = nWorker;
+        for (;;) {
+            TaskPtr task;
+            if (Take(nWorker, task)) {
+                Run(*task);
+                continue;
+            }
+
+            boost::unique_lock<boost::mutex> lock(cs);
+            if (shutdown)
+                break;
+            if (nQueued <= 0)
+                cond.wait(lock);
+        }
     }
 
 public:
-    ParallelOpThreadPool() : shutdown(false), numberOfThreads(boost::thread::hardware_concurrency()) {}
+    ParallelOpThreadPool() : numberOfThreads(std::max(boost::thread::hardware_concurrency(), 1u)), started(false),
+                             shutdown(false), nQueued(0), nHighPriorityQueued(0), nNextWorker(0), nHighPriorityTasks(0),
+                             nHighPriorityLatency(0), nMaxHighPriorityLatency(0), nTasks(0), nLatency(0),
+                             nMaxLatency(0), nStolen(0) {}
 
     ~ParallelOpThreadPool() {
         std::list<boost::thread> threadsToJoin;
 
-        taskQueueMutex.lock();
+        cs.lock();
 
         shutdown = true;
-        taskQueueCondition.notify_all();
+        cond.notify_all();
 
         // move the list to separate variable to wait for the shutdown process to complete
         threadsToJoin.swap(threads);
 
-        taskQueueMutex.unlock();
+        cs.unlock();
 
         // wait for all the threads
         for (boost::thread &t: threadsToJoin)
             t.join();
     }
 
-    // Post a task to the thread pool and return a future to wait for its completion
-    boost::future<void> PostTask(function<void()> task) {
-        boost::packaged_task<void> packagedTask(std::move(task));
-        boost::future<void> ret = packagedTask.get_future();
-
-        taskQueueMutex.lock();
-
-        // lazy start threads on first request or after shutdown
-        if (threads.size() < numberOfThreads)
-            StartThreads();
+    bool SetThreadCount(size_t n) {
+        boost::lock_guard<boost::mutex> lock(cs);
+        if (started)
+            return false;
+        numberOfThreads = std::max(n, (size_t)1);
+        return true;
+    }
 
-        taskQueue.emplace(std::move(packagedTask));
-        taskQueueCondition.notify_one();
+    // Post a task to the thread pool
+    void PostTask(const TaskPtr &task) {
+        // lazy start threads on first request
+        if (!started)
+            Start();
+
+        if (task->fHighPriority) {
+            boost::lock_guard<boost::mutex> lock(cs);
+            highPriorityTasks.push_back(task);
+            nQueued++;
+            nHighPriorityQueued++;
+        }
+        else {
+            // tasks of a pool thread stay with it unless stolen, the others are dealt out in turn
+            int nWorker = GetThreadState().nWorker;
+            Worker &worker = *workers[nWorker >= 0 ? (size_t)nWorker : nNextWorker++ % workers.size()];
+            {
+                boost::lock_guard<boost::mutex> lock(worker.cs);
+                worker.tasks.push_back(task);
+            }
+            boost::lock_guard<boost::mutex> lock(cs);
+            nQueued++;
+        }
+        cond.notify_one();
+    }
 
-        taskQueueMutex.unlock();
+    // Run the task on the calling thread unless a pool thread has taken it
+    void RunIfPending(ParallelTasks::Task &task) {
+        if (Claim(task))
+            Run(task);
+    }
 
-        return ret;
+    ParallelTasksStats GetStats() {
+        ParallelTasksStats stats;
+        boost::lock_guard<boost::mutex> lock(cs);
+        stats.nThreads = started ? workers.size() : 0;
+        stats.nHighPriorityQueued = (size_t)std::max(nHighPriorityQueued.load(), (int64_t)0);
+        stats.nQueued = (size_t)std::max(nQueued.load() - nHighPriorityQueued.load(), (int64_t)0);
+        stats.nHighPriorityTasks = nHighPriorityTasks;
+        stats.nHighPriorityLatencyMicros = nHighPriorityLatency;
+        stats.nMaxHighPriorityLatencyMicros = nMaxHighPriorityLatency;
+        stats.nTasks = nTasks;
+        stats.nLatencyMicros = nLatency;
+        stats.nMaxLatencyMicros = nMaxLatency;
+        stats.nStolen = nStolen;
+        return stats;
     }
 
 } s_parallelOpThreadPool;
@@ -113,11 +287,18 @@ public:
 
 static class ParallelOpThreadPool {
 public:
-    boost::future<void> PostTask(function<void()> task) {
-        task();
-        boost::promise<void> promise;
-        promise.set_value();
-        return promise.get_future();
+    void PostTask(const TaskPtr &task) {
+        task->fTaken = true;
+        task->job();
+    }
+
+    bool SetThreadCount(size_t n) { return true; }
+    void RunIfPending(ParallelTasks::Task &task) {}
+
+    ParallelTasksStats GetStats() {
+        ParallelTasksStats stats;
+        memset(&stats, 0, sizeof(stats));
+        return stats;
     }
 } s_parallelOpThreadPool;
 
@@ -125,21 +306,43 @@ public:
 
 // High level API to create number of parallel tasks and wait for completion
 
-ParallelTasks::ParallelTasks(int n) {
+ParallelTasks::ParallelTasks(int n) : fHighPriority(GetThreadState().nHighPriority > 0) {
     tasks.reserve(n);
 }
 
 void ParallelTasks::Add(function<void()> task) {
-    tasks.push_back(s_parallelOpThreadPool.PostTask(std::move(task)));
+    tasks.push_back(std::make_shared<Task>(std::move(task), fHighPriority));
+    s_parallelOpThreadPool.PostTask(tasks.back());
 }
 
 void ParallelTasks::Wait() {
-    for (boost::future<void> &f: tasks)
-        f.get();
+    // help out instead of sleeping, this also keeps a pool thread waiting for its own tasks from
+    // blocking them. Tasks of other callers are not touched: the caller may hold locks, and a long
+    // wallet proof must not end up running under them
+    for (TaskPtr &task: tasks)
+        s_parallelOpThreadPool.RunIfPending(*task);
+    for (TaskPtr &task: tasks)
+        task->result.get();
 }
 
 void ParallelTasks::Reset() {
     tasks.clear();
 }
 
+ParallelTasks::HighPriority::HighPriority() {
+    GetThreadState().nHighPriority++;
+}
+
+ParallelTasks::HighPriority::~HighPriority() {
+    GetThreadState().nHighPriority--;
+}
+
+bool ParallelTasks::SetThreadCount(size_t n) {
+    return s_parallelOpThreadPool.SetThreadCount(n);
+}
+
+ParallelTasksStats ParallelTasks::GetStats() {
+    return s_parallelOpThreadPool.GetStats();
+}
+
 } // namespace libzerocoin
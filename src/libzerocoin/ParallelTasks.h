@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <functional>
+#include <memory>
 
 #define BOOST_THREAD_PROVIDES_FUTURE
 
@@ -12,9 +13,28 @@
 
 namespace libzerocoin {
 
+// Counters of the thread pool, latencies are the time tasks spent queued
+struct ParallelTasksStats {
+    size_t nThreads;
+    size_t nHighPriorityQueued;
+    size_t nQueued;
+    uint64_t nHighPriorityTasks;
+    uint64_t nHighPriorityLatencyMicros;
+    uint64_t nMaxHighPriorityLatencyMicros;
+    uint64_t nTasks;
+    uint64_t nLatencyMicros;
+    uint64_t nMaxLatencyMicros;
+    uint64_t nStolen;
+};
+
 class ParallelTasks {
+public:
+    // a task of the pool, defined in ParallelTasks.cpp
+    struct Task;
+
 private:
-    vector<boost::future<void>> tasks;
+    vector<std::shared_ptr<Task>> tasks;
+    bool fHighPriority;
 
 public:
     ParallelTasks(int n=0);
@@ -22,7 +42,8 @@ public:
     // add new task
     void Add(std::function<void()> task);
 
-    // wait for everything added so far
+    // wait for everything added so far, running the tasks no pool thread has started yet meanwhile;
+    // tasks of other instances are left to the pool
     void Wait();
 
     // clear all the tasks from the waiting list
@@ -35,6 +56,19 @@ public:
     public:
         DoNotDisturb() {}
     };
+
+    // tasks added by this thread while an instance exists are run before all the others, for callers
+    // holding cs_main (block validation and mempool acceptance)
+    class HighPriority {
+    public:
+        HighPriority();
+        ~HighPriority();
+    };
+
+    // number of threads of the pool, only effective before the first task is added
+    static bool SetThreadCount(size_t n);
+
+    static ParallelTasksStats GetStats();
 };
 
 }
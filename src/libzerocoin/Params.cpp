@@ -13,7 +13,7 @@
 
 namespace libzerocoin {
 
-Params::Params(CBigNum N, uint32_t securityLevel) {
+Params::Params(CBigNum N, uint32_t securityLevel, size_t nPrecomputeMemory) {
 	this->zkp_hash_len = securityLevel;
 	this->zkp_iterations = securityLevel;
 
@@ -25,12 +25,112 @@ Params::Params(CBigNum N, uint32_t securityLevel) {
 
 	this->accumulatorParams.initialized = true;
 	this->initialized = true;
+
+	Precompute(nPrecomputeMemory);
+}
+
+namespace {
+
+struct GeneratorTable {
+	std::shared_ptr<FixedBaseExp> *table;
+	Bignum base;
+	Bignum modulus;
+	uint32_t maxBits;
+};
+
+}
+
+size_t Params::Precompute(size_t nMaxMemory) {
+	AccumulatorAndProofParams &acc = this->accumulatorParams;
+	IntegerGroupParams &qrn = acc.accumulatorQRNCommitmentGroup;
+	IntegerGroupParams &pok = acc.accumulatorPoKCommitmentGroup;
+	IntegerGroupParams &sok = this->serialNumberSoKCommitmentGroup;
+	IntegerGroupParams &coin = this->coinCommitmentGroup;
+
+	// Every proof hash starts with the serialized parameters, several kilobytes
+	acc.transcript.reset();
+	acc.transcript = std::make_shared<const CHashWriter>(acc.getTranscript());
+	this->transcript.reset();
+	this->transcript = std::make_shared<const CHashWriter>(getTranscript());
+
+	// Exponent lengths seen by the provers and verifiers. The QRN group has no modulus
+	// of its own and works mod N; its responses reach |N| + |maxCoinValue| + |c| bits.
+	const uint32_t coinBits = acc.maxCoinValue.bitSize();
+	const uint32_t qrnBits = acc.accumulatorModulus.bitSize() +
+	                         std::max<uint32_t>(coinBits + HASH_OUTPUT_BITS,
+	                                            pok.modulus.bitSize() + acc.k_prime + acc.k_dprime) + 2;
+	const uint32_t pokBits = std::max<uint32_t>(coinBits + std::max<uint32_t>(acc.k_prime + acc.k_dprime, HASH_OUTPUT_BITS),
+	                                            2 * pok.groupOrder.bitSize() + HASH_OUTPUT_BITS) + 2;
+	const uint32_t sokBits = sok.groupOrder.bitSize() + 1;
+	const uint32_t coinOrderBits = coin.groupOrder.bitSize() + 1;
+
+	GeneratorTable tables[] = {
+		{ &qrn.gTable, qrn.g, acc.accumulatorModulus, qrnBits },
+		{ &qrn.hTable, qrn.h, acc.accumulatorModulus, qrnBits },
+		{ &pok.gTable, pok.g, pok.modulus, pokBits },
+		{ &pok.hTable, pok.h, pok.modulus, pokBits },
+		{ &sok.gTable, sok.g, sok.modulus, sokBits },
+		// SoK responses for h are v - r * b^x, twice the length of the order
+		{ &sok.hTable, sok.h, sok.modulus, 2 * sokBits },
+		{ &coin.gTable, coin.g, coin.modulus, coinOrderBits },
+		{ &coin.hTable, coin.h, coin.modulus, coinOrderBits },
+	};
+	const size_t nTables = sizeof(tables) / sizeof(tables[0]);
+
+	// Montgomery contexts cost next to nothing, so every group gets one regardless of the budget
+	CAutoBN_CTX pctx;
+	IntegerGroupParams *groups[] = { &qrn, &pok, &sok, &coin };
+	for (size_t i = 0; i < sizeof(groups) / sizeof(groups[0]); i++) {
+		const Bignum &m = (groups[i] == &qrn) ? acc.accumulatorModulus : groups[i]->modulus;
+		groups[i]->mont.reset();
+		if (BN_is_odd(&m))
+			groups[i]->mont.reset(new CAutoBN_MONT_CTX(&m, pctx));
+	}
+
+	// Montgomery multiplication needs an odd modulus
+	size_t nUsable = 0;
+	for (size_t i = 0; i < nTables; i++) {
+		tables[i].table->reset();
+		if (BN_is_odd(&tables[i].modulus))
+			tables[nUsable++] = tables[i];
+	}
+
+	// Widest window that fits: an exponentiation costs one multiplication per
+	// window, while the table grows as 2^w / w
+	for (uint32_t windowBits = 6; windowBits >= 1; windowBits--) {
+		size_t nMemory = 0;
+		for (size_t i = 0; i < nUsable; i++)
+			nMemory += FixedBaseExp::memoryUsage(tables[i].modulus, tables[i].maxBits, windowBits);
+		if (nMemory > nMaxMemory)
+			continue;
+
+		for (size_t i = 0; i < nUsable; i++)
+			tables[i].table->reset(new FixedBaseExp(tables[i].base, tables[i].modulus, tables[i].maxBits, windowBits));
+		return nMemory;
+	}
+	return 0;
+}
+
+CHashWriter Params::getTranscript() const {
+	if (transcript)
+		return *transcript;
+	CHashWriter hasher(0, 0);
+	hasher << *this;
+	return hasher;
 }
 
 AccumulatorAndProofParams::AccumulatorAndProofParams() {
 	this->initialized = false;
 }
 
+CHashWriter AccumulatorAndProofParams::getTranscript() const {
+	if (transcript)
+		return *transcript;
+	CHashWriter hasher(0, 0);
+	hasher << *this;
+	return hasher;
+}
+
 IntegerGroupParams::IntegerGroupParams() {
 	this->initialized = false;
 }
@@ -39,7 +139,51 @@ Bignum IntegerGroupParams::randomElement() const {
 	// The generator of the group raised
 	// to a random number less than the order of the group
 	// provides us with a uniformly distributed random number.
-	return this->g.pow_mod(Bignum::randBignum(this->groupOrder),this->modulus);
+	return this->powG(Bignum::randBignum(this->groupOrder),this->modulus);
+}
+
+Bignum IntegerGroupParams::powG(const Bignum& e, const Bignum& m) const {
+	if (gTable && gTable->getModulus() == m)
+		return gTable->pow_mod(e);
+	return powMod(this->g, e, m);
+}
+
+Bignum IntegerGroupParams::powH(const Bignum& e, const Bignum& m) const {
+	if (hTable && hTable->getModulus() == m)
+		return hTable->pow_mod(e);
+	return powMod(this->h, e, m);
+}
+
+Bignum IntegerGroupParams::powMod(const Bignum& base, const Bignum& e, const Bignum& m) const {
+	BN_MONT_CTX *pmont = montFor(m);
+	if (pmont != NULL)
+		return base.pow_mod_mont(e, m, pmont);
+	return base.pow_mod(e, m);
+}
+
+BN_MONT_CTX* IntegerGroupParams::montFor(const Bignum& m) const {
+	if (mont && mont->IsFor(&m))
+		return *mont;
+	return NULL;
+}
+
+Bignum IntegerGroupParams::multiPow(const Bignum& eg, const Bignum& eh, const std::vector<Bignum>& bases,
+                                    const std::vector<Bignum>& exponents, const Bignum& m) const {
+	std::vector<Bignum> allBases(bases), allExponents(exponents);
+	Bignum fixed = 1;
+	if (gTable && gTable->getModulus() == m) {
+		fixed = gTable->pow_mod(eg);
+	} else {
+		allBases.push_back(this->g);
+		allExponents.push_back(eg);
+	}
+	if (hTable && hTable->getModulus() == m) {
+		fixed = fixed.mul_mod(hTable->pow_mod(eh), m);
+	} else {
+		allBases.push_back(this->h);
+		allExponents.push_back(eh);
+	}
+	return Bignum::multi_pow_mod(allBases, allExponents, m, montFor(m)).mul_mod(fixed, m);
 }
 
 } /* namespace libzerocoin */
@@ -28,6 +28,45 @@ public:
 	 * @return a random element in the group.
 	 */
     CBigNum randomElement() const;
+
+	/**
+	 * g^e mod m, using the precomputed table for g when there is one for m.
+	 * @param e the exponent, may be negative
+	 * @param m the modulus
+	 */
+	CBigNum powG(const CBigNum& e, const CBigNum& m) const;
+
+	/**
+	 * h^e mod m, using the precomputed table for h when there is one for m.
+	 * @param e the exponent, may be negative
+	 * @param m the modulus
+	 */
+	CBigNum powH(const CBigNum& e, const CBigNum& m) const;
+
+	/**
+	 * g^eg * h^eh * prod(bases[i]^exponents[i]) mod m. The generators use their
+	 * tables when there are tables for m, the remaining powers share the squarings
+	 * of a single CBigNum::multi_pow_mod.
+	 * @param eg the exponent for g, may be zero or negative
+	 * @param eh the exponent for h, may be zero or negative
+	 * @param bases other bases
+	 * @param exponents one exponent per base
+	 * @param m the modulus
+	 */
+	CBigNum multiPow(const CBigNum& eg, const CBigNum& eh, const std::vector<CBigNum>& bases,
+	                 const std::vector<CBigNum>& exponents, const CBigNum& m) const;
+
+	/**
+	 * base^e mod m, using the group's Montgomery context when it was built for m.
+	 * @param base the base
+	 * @param e the exponent, may be negative
+	 * @param m the modulus
+	 */
+	CBigNum powMod(const CBigNum& base, const CBigNum& e, const CBigNum& m) const;
+
+	/** The group's Montgomery context if it was built for m, otherwise NULL */
+	BN_MONT_CTX* montFor(const CBigNum& m) const;
+
 	bool initialized;
 
 	/**
@@ -52,6 +91,19 @@ public:
 	 */
     CBigNum groupOrder;
 
+	/**
+	 * Fixed-base tables for g and h. Not serialized, built by
+	 * Params::Precompute() and shared between copies.
+	 */
+	std::shared_ptr<FixedBaseExp> gTable;
+	std::shared_ptr<FixedBaseExp> hTable;
+
+	/**
+	 * Montgomery context for the group's modulus (N for the QRN group).
+	 * Not serialized, built by Params::Precompute().
+	 */
+	std::shared_ptr<CAutoBN_MONT_CTX> mont;
+
 	ADD_SERIALIZE_METHODS;
 
 	template <typename Stream, typename Operation>
@@ -61,6 +113,11 @@ public:
 		READWRITE(h);
 		READWRITE(modulus);
 		READWRITE(groupOrder);
+		if (ser_action.ForRead()) {
+			gTable.reset();
+			hTable.reset();
+			mont.reset();
+		}
 	};
 
 };
@@ -138,10 +195,26 @@ public:
 	 * The statistical zero-knowledgeness of the accumulator proof.
 	 */
 	uint32_t k_dprime;
+
+	/**
+	 * A hash writer that has already been fed these parameters, as
+	 * "CHashWriter hasher(0, 0); hasher << *this;" would have.
+	 * @return the writer, copied from a midstate when one was precomputed
+	 */
+	CHashWriter getTranscript() const;
+
+	/**
+	 * Hash midstate after the serialized parameters. Not serialized,
+	 * built by Params::Precompute().
+	 */
+	std::shared_ptr<const CHashWriter> transcript;
+
 	ADD_SERIALIZE_METHODS;
 
 	template <typename Stream, typename Operation>
 	inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+		if (ser_action.ForRead())
+			transcript.reset();
 		READWRITE(initialized);
 		READWRITE(accumulatorModulus);
 		READWRITE(accumulatorBase);
@@ -172,7 +245,19 @@ public:
 	* compromised. The integer "N" must be a MINIMUM of 1024
 	* in length. 3072 bits is strongly recommended.
 	**/
-    Params(CBigNum accumulatorModulus, uint32_t securityLevel = ZEROCOIN_DEFAULT_SECURITYLEVEL);
+    Params(CBigNum accumulatorModulus, uint32_t securityLevel = ZEROCOIN_DEFAULT_SECURITYLEVEL,
+           size_t nPrecomputeMemory = ZEROCOIN_PRECOMPUTE_MEMORY);
+
+	/**
+	 * Builds a Montgomery context for the modulus of every group, and fixed-base
+	 * exponentiation tables for their generators using the widest window that
+	 * keeps all tables within nMaxMemory bytes. Exponents longer than a table
+	 * covers fall back to pow_mod. Also captures the hash midstates returned by
+	 * getTranscript().
+	 * @param nMaxMemory memory budget for the tables, 0 disables them
+	 * @return the memory used by the tables
+	 */
+	size_t Precompute(size_t nMaxMemory);
 
 	bool initialized;
 
@@ -204,10 +289,25 @@ public:
 	 */
 	uint32_t zkp_hash_len;
 
+	/**
+	 * A hash writer that has already been fed these parameters, as
+	 * "CHashWriter hasher(0, 0); hasher << *this;" would have.
+	 * @return the writer, copied from a midstate when one was precomputed
+	 */
+	CHashWriter getTranscript() const;
+
+	/**
+	 * Hash midstate after the serialized parameters. Not serialized,
+	 * built by Precompute().
+	 */
+	std::shared_ptr<const CHashWriter> transcript;
+
 	ADD_SERIALIZE_METHODS;
 
 	template <typename Stream, typename Operation>
 	inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+		if (ser_action.ForRead())
+			transcript.reset();
 		READWRITE(initialized);
 		READWRITE(accumulatorParams);
 		READWRITE(coinCommitmentGroup);
@@ -29,13 +29,8 @@ SerialNumberSignatureOfKnowledge::SerialNumberSignatureOfKnowledge(const Params*
 		throw ZerocoinException("Groups are not structured correctly.");
 	}
 
-	Bignum a = params->coinCommitmentGroup.g;
-	Bignum b = params->coinCommitmentGroup.h;
-	Bignum g = params->serialNumberSoKCommitmentGroup.g;
-	Bignum h = params->serialNumberSoKCommitmentGroup.h;
-
-	CHashWriter hasher(0,0);
-	hasher << *params << commitmentToCoin.getCommitmentValue() << coin.getSerialNumber();
+	CHashWriter hasher = params->getTranscript();
+	hasher << commitmentToCoin.getCommitmentValue() << coin.getSerialNumber();
     if (!msghash.IsNull())
         hasher << msghash;
 
@@ -85,10 +80,10 @@ SerialNumberSignatureOfKnowledge::SerialNumberSignatureOfKnowledge(const Params*
 			s_notprime[i]       = r[i];
 			sprime[i]           = v[i];
 		} else {
-            challenges.Add([this, i, &r, &v, &b, &commitmentToCoin, &coin] {
+            challenges.Add([this, i, &r, &v, &commitmentToCoin, &coin] {
                 s_notprime[i]   = r[i] - coin.getRandomness();
                 sprime[i]       = v[i] - (commitmentToCoin.getRandomness() *
-			                              b.pow_mod(r[i] - coin.getRandomness(), params->serialNumberSoKCommitmentGroup.groupOrder));
+			                              params->coinCommitmentGroup.powH(r[i] - coin.getRandomness(), params->serialNumberSoKCommitmentGroup.groupOrder));
             });
 		}
     }
@@ -98,15 +93,10 @@ SerialNumberSignatureOfKnowledge::SerialNumberSignatureOfKnowledge(const Params*
 inline Bignum SerialNumberSignatureOfKnowledge::challengeCalculation(const Bignum& a_exp,const Bignum& b_exp,
         const Bignum& h_exp) const {
 
-	Bignum a = params->coinCommitmentGroup.g;
-	Bignum b = params->coinCommitmentGroup.h;
-	Bignum g = params->serialNumberSoKCommitmentGroup.g;
-	Bignum h = params->serialNumberSoKCommitmentGroup.h;
-
-	Bignum exponent = (a.pow_mod(a_exp, params->serialNumberSoKCommitmentGroup.groupOrder)
-	                   * b.pow_mod(b_exp, params->serialNumberSoKCommitmentGroup.groupOrder)) % params->serialNumberSoKCommitmentGroup.groupOrder;
+	const vector<Bignum> none;
+	Bignum exponent = params->coinCommitmentGroup.multiPow(a_exp, b_exp, none, none, params->serialNumberSoKCommitmentGroup.groupOrder);
 
-	return (g.pow_mod(exponent, params->serialNumberSoKCommitmentGroup.modulus) * h.pow_mod(h_exp, params->serialNumberSoKCommitmentGroup.modulus)) % params->serialNumberSoKCommitmentGroup.modulus;
+	return params->serialNumberSoKCommitmentGroup.multiPow(exponent, h_exp, none, none, params->serialNumberSoKCommitmentGroup.modulus);
 }
 
 bool SerialNumberSignatureOfKnowledge::Verify(const Bignum& coinSerialNumber, const Bignum& valueOfCommitmentToCoin,
@@ -114,44 +104,57 @@ bool SerialNumberSignatureOfKnowledge::Verify(const Bignum& coinSerialNumber, co
 
     ParallelTasks::DoNotDisturb dnd;
 
-	Bignum a = params->coinCommitmentGroup.g;
-	Bignum b = params->coinCommitmentGroup.h;
-	Bignum g = params->serialNumberSoKCommitmentGroup.g;
-	Bignum h = params->serialNumberSoKCommitmentGroup.h;
-
 	// Make sure that the serial number has a unique representation
-	if (coinSerialNumber < 0 || coinSerialNumber >= params->coinCommitmentGroup.groupOrder){
+	if (coinSerialNumber < 0 || coinSerialNumber >= params->coinCommitmentGroup.groupOrder || !HasValidSize()){
 		return false;
 	}
 
-
-	CHashWriter hasher(0,0);
-	hasher << *params << valueOfCommitmentToCoin <<coinSerialNumber;
-    if (!msghash.IsNull())
-        hasher << msghash;
-
 	vector<CBigNum> tprime(params->zkp_iterations);
-	unsigned char *hashbytes = (unsigned char*) &this->hash;
 
     ParallelTasks challenges(params->zkp_iterations);
 
 	for(uint32_t i = 0; i < params->zkp_iterations; i++) {
-        challenges.Add([this, i, hashbytes, &b, &h, &tprime, &coinSerialNumber, &valueOfCommitmentToCoin] {
-            int bit = i % 8;
-            int byte = i / 8;
-            bool challenge_bit = ((hashbytes[byte] >> bit) & 0x01);
-            if(challenge_bit) {
-                tprime[i] = challengeCalculation(coinSerialNumber, s_notprime[i], sprime[i]);
-            } else {
-                Bignum exp = b.pow_mod(s_notprime[i], params->serialNumberSoKCommitmentGroup.groupOrder);
-                tprime[i] = ((valueOfCommitmentToCoin.pow_mod(exp, params->serialNumberSoKCommitmentGroup.modulus) % params->serialNumberSoKCommitmentGroup.modulus) *
-                             (h.pow_mod(sprime[i], params->serialNumberSoKCommitmentGroup.modulus) % params->serialNumberSoKCommitmentGroup.modulus)) %
-                            params->serialNumberSoKCommitmentGroup.modulus;
-            }
+        challenges.Add([this, i, &tprime, &coinSerialNumber, &valueOfCommitmentToCoin] {
+            tprime[i] = ChallengeResponse(i, coinSerialNumber, valueOfCommitmentToCoin);
         });
 	}
     challenges.Wait();
 
+    return VerifyChallengeResponses(coinSerialNumber, valueOfCommitmentToCoin, msghash, tprime);
+}
+
+bool SerialNumberSignatureOfKnowledge::HasValidSize() const {
+    // longer vectors have always been accepted, the extra responses are ignored
+    return s_notprime.size() >= params->zkp_iterations && sprime.size() >= params->zkp_iterations;
+}
+
+Bignum SerialNumberSignatureOfKnowledge::ChallengeResponse(uint32_t i, const Bignum& coinSerialNumber,
+        const Bignum& valueOfCommitmentToCoin) const {
+	const unsigned char *hashbytes = (const unsigned char*) &this->hash;
+	int bit = i % 8;
+	int byte = i / 8;
+	bool challenge_bit = ((hashbytes[byte] >> bit) & 0x01);
+	if(challenge_bit) {
+		return challengeCalculation(coinSerialNumber, s_notprime[i], sprime[i]);
+	} else {
+		Bignum exp = params->coinCommitmentGroup.powH(s_notprime[i], params->serialNumberSoKCommitmentGroup.groupOrder);
+		return params->serialNumberSoKCommitmentGroup.multiPow(0, sprime[i], {valueOfCommitmentToCoin}, {exp},
+		                                                       params->serialNumberSoKCommitmentGroup.modulus);
+	}
+}
+
+bool SerialNumberSignatureOfKnowledge::VerifyChallengeResponses(const Bignum& coinSerialNumber,
+        const Bignum& valueOfCommitmentToCoin, const uint256 msghash, const vector<Bignum>& tprime) const {
+	if (coinSerialNumber < 0 || coinSerialNumber >= params->coinCommitmentGroup.groupOrder ||
+	        tprime.size() != params->zkp_iterations) {
+		return false;
+	}
+
+	CHashWriter hasher = params->getTranscript();
+	hasher << valueOfCommitmentToCoin <<coinSerialNumber;
+    if (!msghash.IsNull())
+        hasher << msghash;
+
 	for(uint32_t i = 0; i < params->zkp_iterations; i++) {
 		hasher << tprime[i];
 	}
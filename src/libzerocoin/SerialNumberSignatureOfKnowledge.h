@@ -51,6 +51,18 @@ public:
 	 */
     bool Verify(const Bignum& coinSerialNumber, const Bignum& valueOfCommitmentToCoin,const uint256 msghash) const;
 
+	/** True if there is a response for every iteration of the proof. */
+	bool HasValidSize() const;
+
+	/** Recomputes the commitment of iteration i from its response, the part of Verify()
+	 * that can run on another thread. HasValidSize() must hold.
+	 */
+	Bignum ChallengeResponse(uint32_t i, const Bignum& coinSerialNumber, const Bignum& valueOfCommitmentToCoin) const;
+
+	/** Checks the challenge hash against the recomputed commitments of all the iterations. */
+	bool VerifyChallengeResponses(const Bignum& coinSerialNumber, const Bignum& valueOfCommitmentToCoin,
+	                              const uint256 msghash, const vector<Bignum>& tprime) const;
+
 	ADD_SERIALIZE_METHODS;
 	template <typename Stream, typename Operation>
 	inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
@@ -13,6 +13,7 @@
 #ifndef ZEROCOIN_H_
 #define ZEROCOIN_H_
 
+#include <memory>
 #include <stdexcept>
 #include <secp256k1.h>
 #include <secp256k1_recovery.h>
@@ -47,6 +48,9 @@
 // to timing attacks. Turn off if an attacker can measure coin minting time.
 #define	ZEROCOIN_FAST_MINT 1
 
+// Memory budget for the fixed-base exponentiation tables built for each Params
+#define ZEROCOIN_PRECOMPUTE_MEMORY          (16 << 20)
+
 // Errors thrown by the Zerocoin library
 
 class ZerocoinException : public std::runtime_error
@@ -63,6 +67,7 @@ namespace libzerocoin {
 #include "../serialize.h"
 #include "bitcoin_bignum/bignum.h"
 #include "../hash.h"
+#include "FixedBaseExp.h"
 #include "Params.h"
 #include "Coin.h"
 #include "Commitment.h"
@@ -71,5 +76,6 @@ namespace libzerocoin {
 #include "CoinSpend.h"
 #include "SerialNumberSignatureOfKnowledge.h"
 #include "ParamGeneration.h"
+#include "BatchVerifier.h"
 
 #endif /* ZEROCOIN_H_ */
@@ -5,9 +5,12 @@
 #ifndef BITCOIN_BIGNUM_H
 #define BITCOIN_BIGNUM_H
 
+#include <algorithm>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 #include <openssl/bn.h>
+#include <boost/thread/tss.hpp>
 
 #include "../../uint256.h" // for uint64
 #include "../../arith_uint256.h"
@@ -20,7 +23,48 @@ public:
     explicit bignum_error(const std::string& str) : std::runtime_error(str) {}
 };
 
-/** RAII encapsulated BN_CTX (OpenSSL bignum context) */
+/** Per-thread free list of BN_CTX, so that CAutoBN_CTX does not allocate a context per operation */
+class CBN_CTXPool
+{
+private:
+    static const size_t MAX_FREE = 16;
+    std::vector<BN_CTX*> vFree;
+
+public:
+    ~CBN_CTXPool()
+    {
+        for (size_t i = 0; i < vFree.size(); i++)
+            BN_CTX_free(vFree[i]);
+    }
+
+    static CBN_CTXPool& ForThread()
+    {
+        // thread_specific_ptr deletes the pool when the thread ends
+        static boost::thread_specific_ptr<CBN_CTXPool> pool;
+        if (pool.get() == NULL)
+            pool.reset(new CBN_CTXPool());
+        return *pool;
+    }
+
+    BN_CTX* Get()
+    {
+        if (vFree.empty())
+            return BN_CTX_new();
+        BN_CTX* pctx = vFree.back();
+        vFree.pop_back();
+        return pctx;
+    }
+
+    void Put(BN_CTX* pctx)
+    {
+        if (vFree.size() < MAX_FREE)
+            vFree.push_back(pctx);
+        else
+            BN_CTX_free(pctx);
+    }
+};
+
+/** RAII encapsulated BN_CTX (OpenSSL bignum context), taken from the thread's pool */
 class CAutoBN_CTX
 {
 protected:
@@ -30,7 +74,7 @@ protected:
 public:
     CAutoBN_CTX()
     {
-        pctx = BN_CTX_new();
+        pctx = CBN_CTXPool::ForThread().Get();
         if (pctx == NULL)
             throw bignum_error("CAutoBN_CTX : BN_CTX_new() returned NULL");
     }
@@ -38,7 +82,7 @@ public:
     ~CAutoBN_CTX()
     {
         if (pctx != NULL)
-            BN_CTX_free(pctx);
+            CBN_CTXPool::ForThread().Put(pctx);
     }
 
     operator BN_CTX*() { return pctx; }
@@ -47,6 +91,49 @@ public:
     bool operator!() { return (pctx == NULL); }
 };
 
+/**
+ * RAII encapsulated BN_MONT_CTX (OpenSSL Montgomery context) for an odd modulus.
+ * The context is only read once built, so one instance can be shared by all threads.
+ */
+class CAutoBN_MONT_CTX
+{
+protected:
+    BN_MONT_CTX* pmont;
+    BIGNUM* pmodulus;
+
+private:
+    CAutoBN_MONT_CTX(const CAutoBN_MONT_CTX&);
+    CAutoBN_MONT_CTX& operator=(const CAutoBN_MONT_CTX&);
+
+public:
+    CAutoBN_MONT_CTX(const BIGNUM* m, BN_CTX* pctx)
+    {
+        pmont = BN_MONT_CTX_new();
+        pmodulus = BN_dup(m);
+        if (pmont == NULL || pmodulus == NULL) {
+            BN_MONT_CTX_free(pmont);
+            BN_free(pmodulus);
+            throw bignum_error("CAutoBN_MONT_CTX : allocation failed");
+        }
+        if (!BN_MONT_CTX_set(pmont, m, pctx)) {
+            BN_MONT_CTX_free(pmont);
+            BN_free(pmodulus);
+            throw bignum_error("CAutoBN_MONT_CTX : BN_MONT_CTX_set failed");
+        }
+    }
+
+    ~CAutoBN_MONT_CTX()
+    {
+        BN_MONT_CTX_free(pmont);
+        BN_free(pmodulus);
+    }
+
+    /** True if this context was built for modulus m */
+    bool IsFor(const BIGNUM* m) const { return BN_cmp(pmodulus, m) == 0; }
+
+    operator BN_MONT_CTX*() const { return pmont; }
+};
+
 
 /** C++ wrapper for BIGNUM (OpenSSL bignum) */class CBigNum
 {
@@ -547,6 +634,129 @@ public:
         return ret;
     }
 
+    /**
+     * modular exponentiation: this^e mod m, with a Montgomery context built
+     * beforehand for the odd modulus m
+     * @param e exponent
+     * @param m modulus
+     * @param mont Montgomery context for m
+     */
+    CBigNum pow_mod_mont(const CBigNum& e, const CBigNum& m, BN_MONT_CTX* mont) const {
+        CAutoBN_CTX pctx;
+        CBigNum ret;
+        if( e < 0){
+            // g^-x = (g^-1)^x
+            CBigNum inv = this->inverse(m);
+            CBigNum posE = e * -1;
+            if (!BN_mod_exp_mont(&ret, &inv, &posE, &m, pctx, mont))
+                throw bignum_error("CBigNum::pow_mod_mont: BN_mod_exp_mont failed on negative exponent");
+        }else
+        if (!BN_mod_exp_mont(&ret, bn, &e, &m, pctx, mont))
+            throw bignum_error("CBigNum::pow_mod_mont : BN_mod_exp_mont failed");
+
+        return ret;
+    }
+
+    /**
+     * Calculates prod(bases[i]^exponents[i]) mod m, Straus/Shamir style: the
+     * exponents share one chain of squarings and each is scanned with its own
+     * sliding window. A negative exponent inverts its base first, as in pow_mod.
+     * @param bases the bases
+     * @param exponents one exponent per base
+     * @param m the modulus
+     * @param mont a Montgomery context for m, or NULL to build one
+     * @return the product, identical to multiplying the separate pow_mod results mod m
+     */
+    static CBigNum multi_pow_mod(const std::vector<CBigNum>& bases, const std::vector<CBigNum>& exponents, const CBigNum& m,
+                                 BN_MONT_CTX* mont = NULL) {
+        if (bases.size() != exponents.size())
+            throw bignum_error("CBigNum::multi_pow_mod : bases and exponents differ in length");
+
+        CAutoBN_CTX pctx;
+        CBigNum ret;
+        // Montgomery multiplication needs an odd modulus
+        if (!BN_is_odd(&m)) {
+            ret = 1;
+            for (size_t i = 0; i < bases.size(); i++)
+                ret = ret.mul_mod(bases[i].pow_mod(exponents[i], m), m);
+            return ret;
+        }
+
+        std::unique_ptr<CAutoBN_MONT_CTX> ownMont;
+        if (mont == NULL) {
+            ownMont.reset(new CAutoBN_MONT_CTX(&m, pctx));
+            mont = *ownMont;
+        }
+        const size_t n = bases.size();
+        int nMaxBits = 0;
+        for (size_t i = 0; i < n; i++)
+            nMaxBits = std::max(nMaxBits, exponents[i].bitSize());
+
+        // digits[i][j] is the odd window value of exponent i whose lowest bit is j, or zero
+        std::vector<std::vector<unsigned int> > digits(n, std::vector<unsigned int>(nMaxBits, 0));
+        std::vector<std::vector<CBigNum> > powers(n);
+        for (size_t i = 0; i < n; i++) {
+            const CBigNum& e = exponents[i];
+            const int nBits = e.bitSize();
+            if (nBits == 0)
+                continue;
+
+            // Same window sizes as BN_mod_exp
+            const int w = nBits > 671 ? 6 : nBits > 239 ? 5 : nBits > 79 ? 4 : nBits > 23 ? 3 : 1;
+            for (int j = nBits - 1; j >= 0; ) {
+                if (!BN_is_bit_set(&e, j)) {
+                    j--;
+                    continue;
+                }
+                int low = std::max(j - w + 1, 0);
+                while (!BN_is_bit_set(&e, low))
+                    low++;
+                unsigned int d = 0;
+                for (int k = j; k >= low; k--)
+                    d = (d << 1) | (BN_is_bit_set(&e, k) ? 1 : 0);
+                digits[i][low] = d;
+                j = low - 1;
+            }
+
+            // powers[i][k] = base^(2k+1) in Montgomery form
+            CBigNum b = (e < 0 ? bases[i].inverse(m) : bases[i]) % m;
+            if (b < 0)
+                b += m;
+            CBigNum b2;
+            powers[i].resize((size_t)1 << (w - 1));
+            if (!BN_to_montgomery(&powers[i][0], &b, mont, pctx) ||
+                !BN_mod_mul_montgomery(&b2, &powers[i][0], &powers[i][0], mont, pctx))
+                throw bignum_error("CBigNum::multi_pow_mod : Montgomery conversion failed");
+            for (size_t k = 1; k < powers[i].size(); k++) {
+                if (!BN_mod_mul_montgomery(&powers[i][k], &powers[i][k - 1], &b2, mont, pctx))
+                    throw bignum_error("CBigNum::multi_pow_mod : BN_mod_mul_montgomery failed");
+            }
+        }
+
+        bool fStarted = false;
+        for (int j = nMaxBits - 1; j >= 0; j--) {
+            if (fStarted && !BN_mod_mul_montgomery(&ret, &ret, &ret, mont, pctx))
+                throw bignum_error("CBigNum::multi_pow_mod : BN_mod_mul_montgomery failed");
+            for (size_t i = 0; i < n; i++) {
+                const unsigned int d = digits[i][j];
+                if (d == 0)
+                    continue;
+                if (!fStarted) {
+                    ret = powers[i][d >> 1];
+                    fStarted = true;
+                } else if (!BN_mod_mul_montgomery(&ret, &ret, &powers[i][d >> 1], mont, pctx)) {
+                    throw bignum_error("CBigNum::multi_pow_mod : BN_mod_mul_montgomery failed");
+                }
+            }
+        }
+
+        if (!fStarted)
+            return CBigNum(1) % m;
+        if (!BN_from_montgomery(&ret, &ret, mont, pctx))
+            throw bignum_error("CBigNum::multi_pow_mod : BN_from_montgomery failed");
+        return ret;
+    }
+
     /**
      * Calculates the inverse of this element mod m.
      * i.e. i such this*i = 1 mod m
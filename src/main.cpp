@@ -24,6 +24,7 @@
 #include "policy/policy.h"
 #include "pow.h"
 #include "primitives/block.h"
+#include "primitives/powcache.h"
 #include "primitives/transaction.h"
 #include "random.h"
 #include "script/script.h"
@@ -1097,7 +1098,7 @@ int64_t GetTransactionSigOpCost(const CTransaction &tx, const CCoinsViewCache &i
 
 
 //static libzerocoin::Params *ZCParams;
-bool CheckTransaction(const CTransaction &tx, CValidationState &state, uint256 hashTx,  bool isVerifyDB, int nHeight, bool isCheckWallet, CZerocoinTxInfo *zerocoinTxInfo) {
+bool CheckTransaction(const CTransaction &tx, CValidationState &state, uint256 hashTx,  bool isVerifyDB, int nHeight, bool isCheckWallet, CZerocoinTxInfo *zerocoinTxInfo, std::vector<CZerocoinSpendCheck> *pvZerocoinChecks) {
     LogPrintf("CheckTransaction nHeight=%s, isVerifyDB=%s, isCheckWallet=%s, txHash=%s\n", nHeight, isVerifyDB, isCheckWallet, tx.GetHash().ToString());
 //    LogPrintf("transaction = %s\n", tx.ToString());
     bool fTestNet = (Params().NetworkIDString() == CBaseChainParams::TESTNET);
@@ -1144,7 +1145,7 @@ bool CheckTransaction(const CTransaction &tx, CValidationState &state, uint256 h
 			    return state.DoS(10, false, REJECT_INVALID, "bad-txns-prevout-null");
 		    }
 	    }
-        if (!CheckZerocoinTransaction(tx, state, hashTx, isVerifyDB, nHeight, isCheckWallet, zerocoinTxInfo))
+        if (!CheckZerocoinTransaction(tx, state, hashTx, isVerifyDB, nHeight, isCheckWallet, zerocoinTxInfo, pvZerocoinChecks))
 		    return false;
     }
     return true;
@@ -1182,10 +1183,18 @@ bool AcceptToMemoryPoolWorker(CTxMemPool &pool, CValidationState &state, const C
     if (pfMissingInputs)
         *pfMissingInputs = false;
 
-    if (!CheckTransaction(tx, state, hash, false, INT_MAX, isCheckWalletTransaction)) {
+    std::vector<CZerocoinSpendCheck> vSpendChecks;
+    if (!CheckTransaction(tx, state, hash, false, INT_MAX, isCheckWalletTransaction, NULL, &vSpendChecks)) {
         LogPrintf("CheckTransaction() failed!");
         return false; // state filled in by CheckTransaction
     }
+    // Spends proven here are not proven again when the block containing them is checked
+    {
+        // cs_main is held, so the proofs must not queue behind wallet and RPC work either
+        libzerocoin::ParallelTasks::HighPriority highPriority;
+        if (!CZerocoinSpendCheck::VerifyBatch(vSpendChecks, true))
+            return state.Invalid(false, REJECT_INVALID, "bad-zerocoin-spend");
+    }
 
     // Coinbase is only valid in a block, not as a loose transaction
     if (tx.IsCoinBase()) {
@@ -1765,7 +1774,7 @@ bool WriteBlockToDisk(const CBlock &block, CDiskBlockPos &pos, const CMessageHea
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, const Consensus::Params &consensusParams) {
+bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, const Consensus::Params &consensusParams, bool fCheckPOW) {
     block.SetNull();
 
     // Open history file to read
@@ -1781,13 +1790,16 @@ bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, con
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
     }
     // Check the header
-    if (!CheckProofOfWork(block.GetPoWHash(nHeight), block.nBits, consensusParams))
+    if (fCheckPOW && !CheckProofOfWork(block.GetPoWHash(nHeight), block.nBits, consensusParams))
         return error("ReadBlockFromDisk: Errors in block header at %s", pos.ToString());
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex, const Consensus::Params &consensusParams) {
-    if (!ReadBlockFromDisk(block, pindex->GetBlockPos(), pindex->nHeight, consensusParams))
+bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex, const Consensus::Params &consensusParams, bool fForceCheckPOW) {
+    // The proof of work of fully validated blocks was checked when they were accepted, and the
+    // header hash comparison below ties the data on disk to that index entry.
+    bool fCheckPOW = fForceCheckPOW || !pindex->IsValid(BLOCK_VALID_SCRIPTS);
+    if (!ReadBlockFromDisk(block, pindex->GetBlockPos(), pindex->nHeight, consensusParams, fCheckPOW))
         return false;
     if (block.GetHash() != pindex->GetBlockHash()) {
         return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): GetHash() doesn't match index for %s at %s",
@@ -2689,6 +2701,9 @@ bool ConnectBlock(const CBlock &block, CValidationState &state, CBlockIndex *pin
         if (!pblocktree->WriteTxIndex(vPos))
             return AbortNode(state, "Failed to write transaction index");
 
+    // zeronodes look their collaterals up only when a block spends them
+    mnodeman.BlockConnected(block);
+
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash());
 
@@ -2785,6 +2800,14 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode) {
             FlushBlockFile();
             // Then update all block file information (which may refer to block and undo files).
             {
+                // Zerocoin payloads go with the block index entries referring to them
+                std::vector<std::pair<CBlockIndex*, std::shared_ptr<const CZerocoinBlockInfo> > > vZerocoinInfo;
+                ZerocoinTakeDirtyBlockInfo(vZerocoinInfo);
+                for (size_t i = 0; i < vZerocoinInfo.size(); i++)
+                    setDirtyBlockIndex.insert(vZerocoinInfo[i].first);
+                std::vector<std::pair<uint256, CCoinbasePayees> > vCoinbasePayees;
+                int nCoinbasePayeesPruned;
+                coinbasePayeeIndex.TakeDirty(vCoinbasePayees, nCoinbasePayeesPruned);
                 std::vector <std::pair<int, const CBlockFileInfo *>> vFiles;
                 vFiles.reserve(setDirtyFileInfo.size());
                 for (set<int>::iterator it = setDirtyFileInfo.begin(); it != setDirtyFileInfo.end();) {
@@ -2797,7 +2820,7 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode) {
                     vBlocks.push_back(*it);
                     setDirtyBlockIndex.erase(it++);
                 }
-                if (!pblocktree->WriteBatchSync(vFiles, nLastBlockFile, vBlocks)) {
+                if (!pblocktree->WriteBatchSync(vFiles, nLastBlockFile, vBlocks, vZerocoinInfo, vCoinbasePayees, nCoinbasePayeesPruned)) {
                     return AbortNode(state, "Files to write to block index database");
                 }
             }
@@ -2818,6 +2841,9 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode) {
             // Flush the chainstate (which may refer to block index entries).
             if (!pcoinsTip->Flush())
                 return AbortNode(state, "Failed to write to coin database");
+            // The zerocoin state corresponds to the same best block as the chainstate.
+            if (!ZerocoinFlushState(pcoinsTip->GetBestBlock()))
+                return AbortNode(state, "Failed to write to zerocoin database");
             nLastFlush = nNow;
         }
         if (fDoFullFlush || ((mode == FLUSH_STATE_ALWAYS || mode == FLUSH_STATE_PERIODIC) &&
@@ -2954,6 +2980,7 @@ bool static DisconnectTip(CValidationState &state, const CChainParams &chainpara
         // block that were added back and cleans up the mempool state.
         mempool.UpdateTransactionsFromBlock(vHashUpdate);
     }
+    coinbasePayeeIndex.BlockDisconnected(pindexDelete);
     // Update chainActive and related variables.
     UpdateTip(pindexDelete->pprev, chainparams);
     // Let wallets know transactions went from 1-confirmed to
@@ -3026,6 +3053,8 @@ ConnectTip(CValidationState &state, const CChainParams &chainparams, CBlockIndex
     list <CTransaction> txConflicted;
 //    LogPrint("ConnectTip", "pblock->ToString()=%s\n", pblock->ToString());
     mempool.removeForBlock(pblock->vtx, pindexNew->nHeight, txConflicted, !IsInitialBlockDownload());
+    // Index the zeronode payments before UpdateTip makes the zeronode code look them up
+    coinbasePayeeIndex.BlockConnected(*pblock, pindexNew);
     // Update chainActive & related variables.
     UpdateTip(pindexNew, chainparams);
     // Tell wallet about transactions that went from mempool
@@ -3546,6 +3575,8 @@ CBlockIndex *AddToBlockIndex(const CBlockHeader &block) {
         pindexNew->nHeight = pindexNew->pprev->nHeight + 1;
         pindexNew->BuildSkip();
     }
+    // Header PoW has just been checked by CheckBlockHeader, keep it with the index
+    pindexNew->hashPoW = block.GetPoWHash(pindexNew->nHeight);
     pindexNew->nChainWork = (pindexNew->pprev ? pindexNew->pprev->nChainWork : 0) + GetBlockProof(*pindexNew);
     pindexNew->RaiseValidity(BLOCK_VALID_TREE);
     if (pindexBestHeader == NULL || pindexBestHeader->nChainWork < pindexNew->nChainWork)
@@ -3796,12 +3827,23 @@ bool CheckBlock(const CBlock &block, CValidationState &state, const Consensus::P
             nHeight = ZerocoinGetNHeight(block.GetBlockHeader());
         if (block.zerocoinTxInfo == NULL)
             block.zerocoinTxInfo = new CZerocoinTxInfo();
-        BOOST_FOREACH(const CTransaction &tx, block.vtx)
-        if (!CheckTransaction(tx, state, tx.GetHash(), isVerifyDB, nHeight, false, block.zerocoinTxInfo)) {
-            LogPrintf("block=%s\n", block.ToString());
-            return state.Invalid(false, state.GetRejectCode(), state.GetRejectReason(),
-                                 strprintf("Transaction check failed (tx hash %s) %s", tx.GetHash().ToString(),
-                                           state.GetDebugMessage()));
+        // Zerocoin spend proofs of the whole block are verified together once all the transactions
+        // are checked, while the checks that depend on the order of transactions (used serials) are done here
+        std::vector<CZerocoinSpendCheck> vSpendChecks;
+        BOOST_FOREACH(const CTransaction &tx, block.vtx) {
+            if (!CheckTransaction(tx, state, tx.GetHash(), isVerifyDB, nHeight, false, block.zerocoinTxInfo,
+                                  &vSpendChecks)) {
+                LogPrintf("block=%s\n", block.ToString());
+                return state.Invalid(false, state.GetRejectCode(), state.GetRejectReason(),
+                                     strprintf("Transaction check failed (tx hash %s) %s", tx.GetHash().ToString(),
+                                               state.GetDebugMessage()));
+            }
+        }
+        {
+            // proofs of the block go ahead of wallet and RPC work queued in the zerocoin thread pool
+            libzerocoin::ParallelTasks::HighPriority highPriority;
+            if (!CZerocoinSpendCheck::VerifyBatch(vSpendChecks))
+                return state.DoS(100, false, REJECT_INVALID, "bad-zerocoin-spend");
         }
         block.zerocoinTxInfo->Complete();
 
@@ -4410,10 +4452,27 @@ bool static LoadBlockIndexDB() {
         vSortedByHeight.push_back(make_pair(pindex->nHeight, pindex));
     }
     sort(vSortedByHeight.begin(), vSortedByHeight.end());
+
+    // Entries without a stored PoW hash come from an older index: hash them once and mark
+    // them dirty so that the next flush persists the hash. Stored hashes of the most recent
+    // -checkpowonload headers are recomputed in full.
+    int nCheckPoWOnLoad = GetArg("-checkpowonload", DEFAULT_CHECKPOWONLOAD);
+    int nCheckPoWHeight = vSortedByHeight.empty() ? 0 : vSortedByHeight.back().first - nCheckPoWOnLoad;
+    int nPoWHashUpgraded = 0;
     BOOST_FOREACH(
     const PAIRTYPE(int, CBlockIndex*) &item, vSortedByHeight)
     {
         CBlockIndex *pindex = item.second;
+        if (pindex->hashPoW.IsNull()) {
+            pindex->hashPoW = pindex->GetBlockPoWHash(true);
+            if (!CheckProofOfWork(pindex->hashPoW, pindex->nBits, chainparams.GetConsensus()))
+                return error("LoadBlockIndexDB(): CheckProofOfWork failed: %s", pindex->ToString());
+            setDirtyBlockIndex.insert(pindex);
+            nPoWHashUpgraded++;
+        } else if (nCheckPoWOnLoad > 0 && pindex->nHeight > nCheckPoWHeight) {
+            if (pindex->GetBlockPoWHash(true) != pindex->hashPoW)
+                return error("LoadBlockIndexDB(): stored PoW hash mismatch: %s", pindex->ToString());
+        }
         pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + GetBlockProof(*pindex);
         // We can link the chain of blocks for which we've received transactions at some point.
         // Pruned nodes may have deleted the block.
@@ -4441,6 +4500,9 @@ bool static LoadBlockIndexDB() {
             pindexBestHeader = pindex;
     }
 
+    if (nPoWHashUpgraded > 0)
+        LogPrintf("%s: stored PoW hash of %d block index entries\n", __func__, nPoWHashUpgraded);
+
     // Load block file info
     pblocktree->ReadLastBlockFile(nLastBlockFile);
     vinfoBlockFile.resize(nLastBlockFile + 1);
@@ -4491,6 +4553,11 @@ bool static LoadBlockIndexDB() {
     pblocktree->ReadFlag("txindex", fTxIndex);
     LogPrintf("%s: transaction index %s\n", __func__, fTxIndex ? "enabled" : "disabled");
 
+    // Resume pruning the coinbase payee index where the last run stopped
+    int nCoinbasePayeesPruned;
+    if (pblocktree->ReadCoinbasePayeesPruned(nCoinbasePayeesPruned))
+        coinbasePayeeIndex.SetPrunedHeight(nCoinbasePayeesPruned);
+
     // Load pointer to end of best chain
     BlockMap::iterator it = mapBlockIndex.find(pcoinsTip->GetBestBlock());
     if (it == mapBlockIndex.end()) {
@@ -4500,7 +4567,9 @@ bool static LoadBlockIndexDB() {
     chainActive.SetTip(it->second);
 
     PruneBlockIndexCandidates();
-    ZerocoinBuildStateFromIndex(&chainActive);
+    // Validating with an empty zerocoin state would let already used serials be spent again
+    if (!ZerocoinBuildStateFromIndex(&chainActive))
+        return error("LoadBlockIndexDB(): failed to load zerocoin state");
 
     LogPrintf("%s: hashBestChain=%s height=%d date=%s progress=%f\n", __func__,
               chainActive.Tip()->GetBlockHash().ToString(), chainActive.Height(),
@@ -4557,7 +4626,7 @@ bool CVerifyDB::VerifyDB(const CChainParams &chainparams, CCoinsView *coinsview,
         }
         CBlock block;
         // check level 0: read from disk
-        if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus()))
+        if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus(), true))
             return error("VerifyDB(): *** ReadBlockFromDisk failed at %d, hash=%s", pindex->nHeight,
                          pindex->GetBlockHash().ToString());
         LogPrintf("VerifyDB->CheckBlock() nHeight=%s\n", pindex->nHeight);
@@ -4736,6 +4805,8 @@ void UnloadBlockIndex() {
     for (int b = 0; b < VERSIONBITS_NUM_BITS; b++) {
         warningcache[b].clear();
     }
+    CZerocoinState::GetZerocoinState()->Reset();
+    ZerocoinUnloadBlockInfo();
 
     BOOST_FOREACH(BlockMap::value_type & entry, mapBlockIndex)
     {
@@ -5542,6 +5613,28 @@ uint32_t GetFetchFlags(CNode *pfrom, CBlockIndex *pprev, const Consensus::Params
     return nFetchFlags;
 }
 
+// Hash headers[nBegin, nEnd), a connecting run whose first header is at nFirstHeight, MAX_HEADERS_POW_BATCH
+// headers at a time and cache the PoW hashes that meet their target. Like AcceptBlockHeader, this stops
+// at the first header that fails CheckProofOfWork, so at most one batch of junk headers gets hashed
+void static PrecomputeHeadersPoW(const std::vector<CBlockHeader>& headers, unsigned int nBegin, unsigned int nEnd,
+                                 int nFirstHeight, const Consensus::Params& consensusParams) {
+    for (unsigned int nBatch = nBegin; nBatch < nEnd; nBatch += MAX_HEADERS_POW_BATCH) {
+        std::vector<CBlockHeader> batch(headers.begin() + nBatch,
+                                        headers.begin() + std::min(nEnd, nBatch + MAX_HEADERS_POW_BATCH));
+        int nBatchHeight = nFirstHeight + (nBatch - nBegin);
+        std::vector<uint256> vPoWHash;
+        ComputePoWHashes(batch, nBatchHeight, vPoWHash);
+        for (size_t i = 0; i < batch.size(); i++) {
+            // Headers below the Lyra2Z heights are left to AcceptBlockHeader
+            if (vPoWHash[i].IsNull())
+                continue;
+            if (!CheckProofOfWork(vPoWHash[i], batch[i].nBits, consensusParams))
+                return;
+            powHashCache.Insert(batch[i].GetHash(), nBatchHeight + i, vPoWHash[i]);
+        }
+    }
+}
+
 bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv, int64_t nTimeReceived,
                            const CChainParams &chainparams) {
     if (mapArgs.count("-dropmessagestest") && GetRand(atoi(mapArgs["-dropmessagestest"])) == 0) {
@@ -6520,6 +6613,33 @@ bool static ProcessMessage(CNode *pfrom, string strCommand, CDataStream &vRecv,
             ReadCompactSize(vRecv); // ignore tx count; assume it is 0.
         }
 
+        // Hash the headers of a connecting run up front, outside cs_main, so Lyra2Z is
+        // computed several headers at a time and CheckBlockHeader hits the PoW hash cache.
+        // Headers we already have are skipped, they are not checked again; being a chain,
+        // they can only come first. The run stops at the first header the loop below would
+        // reject without hashing it, and PrecomputeHeadersPoW stops at the first batch with
+        // a header failing its target
+        if (nCount > 0) {
+            unsigned int nKnown = 0;
+            int nFirstHeight = -1;
+            {
+                LOCK(cs_main);
+                while (nKnown < nCount && mapBlockIndex.count(headers[nKnown].GetHash()))
+                    nKnown++;
+                if (nKnown < nCount) {
+                    BlockMap::iterator mi = mapBlockIndex.find(headers[nKnown].hashPrevBlock);
+                    if (mi != mapBlockIndex.end())
+                        nFirstHeight = mi->second->nHeight + 1;
+                }
+            }
+            unsigned int nEnd = nKnown;
+            while (nEnd < nCount && (nEnd == nKnown || headers[nEnd].hashPrevBlock == headers[nEnd - 1].GetHash()) &&
+                   CheckProofOfWorkTarget(headers[nEnd].nBits, chainparams.GetConsensus()))
+                nEnd++;
+            if (nFirstHeight >= 0 && nEnd > nKnown)
+                PrecomputeHeadersPoW(headers, nKnown, nEnd, nFirstHeight, chainparams.GetConsensus());
+        }
+
         {
             LOCK(cs_main);
 
@@ -6922,6 +7042,8 @@ bool ProcessMessages(CNode *pfrom) {
     // this maintains the order of responses
     if (!pfrom->vRecvGetData.empty()) return fOk;
 
+    PreverifyZeronodeMessages(pfrom);
+
     std::deque<CNetMessage>::iterator it = pfrom->vRecvMsg.begin();
     while (!pfrom->fDisconnect && it != pfrom->vRecvMsg.end()) {
         // Don't bother if send buffer is too full to respond anyway
@@ -1032,6 +1032,38 @@ void BlockAssembler::addPriorityTxs()
 //    }
 //}
 
+// Nonces hashed per lyra2z_hash_batch call; a multiple of every batch width that divides 256
+static const unsigned int MINER_LYRA2Z_BATCH = 16;
+
+//
+// ScanLyra2ZBatch hashes nonces nNonce .. nNonce + MINER_LYRA2Z_BATCH - 1 at once, so
+// the Lyra2 sponges of neighbouring nonces can be interleaved. On success nNonce is set
+// to the first nonce meeting the target and thash to its hash, otherwise nNonce is
+// advanced past the batch.
+//
+static bool ScanLyra2ZBatch(CBlock *pblock, const arith_uint256& hashTarget, uint256& thash)
+{
+    char headers[MINER_LYRA2Z_BATCH * 80];
+    char hashes[MINER_LYRA2Z_BATCH * 32];
+    uint32_t nNonceStart = pblock->nNonce;
+
+    for (unsigned int i = 0; i < MINER_LYRA2Z_BATCH; i++) {
+        pblock->nNonce = nNonceStart + i;
+        memcpy(headers + i * 80, BEGIN(pblock->nVersion), 80);
+    }
+    lyra2z_hash_batch(headers, MINER_LYRA2Z_BATCH, hashes);
+
+    for (unsigned int i = 0; i < MINER_LYRA2Z_BATCH; i++) {
+        memcpy(thash.begin(), hashes + i * 32, 32);
+        if (UintToArith256(thash) <= hashTarget) {
+            pblock->nNonce = nNonceStart + i;
+            return true;
+        }
+    }
+    pblock->nNonce = nNonceStart + MINER_LYRA2Z_BATCH;
+    return false;
+}
+
 static bool ProcessBlockFound(const CBlock* pblock, const CChainParams& chainparams)
 {
     LogPrintf("%s\n", pblock->ToString());
@@ -1119,20 +1151,25 @@ void static ZerobitcoinMiner(const CChainParams &chainparams) {
             LogPrintf("pblock: %s\n", pblock->ToString());
             LogPrintf("pblock->nVersion: %s\n", pblock->nVersion);
             LogPrintf("pblock->nTime: %s\n", pblock->nTime);
+            bool fLyra2Z = fTestNet ? pindexPrev->nHeight + 1 >= HF_LYRA2Z_HEIGHT_TESTNET
+                                    : pindexPrev->nHeight + 1 >= HF_LYRA2Z_HEIGHT;
             while (true) {
                 // Check if something found
                 uint256 thash;
 
                 while (true) {
-                    if ((!fTestNet && pindexPrev->nHeight + 1 >= HF_LYRA2Z_HEIGHT)) {
-                        lyra2z_hash(BEGIN(pblock->nVersion), BEGIN(thash));
+                    if (fLyra2Z) {
+                        if (!ScanLyra2ZBatch(pblock, hashTarget, thash)) {
+                            // Stop at the same 256-nonce boundaries as the single-hash loop
+                            if ((pblock->nNonce & 0xFF) < MINER_LYRA2Z_BATCH)
+                                break;
+                            continue;
+                        }
                     } else if (!fTestNet && pindexPrev->nHeight + 1 >= HF_LYRA2_HEIGHT) {
                         LYRA2(BEGIN(thash), 32, BEGIN(pblock->nVersion), 80, BEGIN(pblock->nVersion), 80, 2, 8192, 256);
                     } else if (!fTestNet && pindexPrev->nHeight + 1 >= HF_LYRA2VAR_HEIGHT) {
                         LYRA2(BEGIN(thash), 32, BEGIN(pblock->nVersion), 80, BEGIN(pblock->nVersion), 80, 2,
                               pindexPrev->nHeight + 1, 256);
-                    } else if (fTestNet && pindexPrev->nHeight + 1 >= HF_LYRA2Z_HEIGHT_TESTNET) { // testnet
-                        lyra2z_hash(BEGIN(pblock->nVersion), BEGIN(thash));
                     } else if (fTestNet && pindexPrev->nHeight + 1 >= HF_LYRA2_HEIGHT_TESTNET) { // testnet
                         LYRA2(BEGIN(thash), 32, BEGIN(pblock->nVersion), 80, BEGIN(pblock->nVersion), 80, 2, 8192, 256);
                     } else if (fTestNet && pindexPrev->nHeight + 1 >= HF_LYRA2VAR_HEIGHT_TESTNET) { // testnet
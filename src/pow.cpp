@@ -115,16 +115,23 @@ unsigned int CalculateNextWorkRequired(const CBlockIndex *pindexLast, int64_t nF
     return bnNew.GetCompact();
 }
 
-bool CheckProofOfWork(uint256 hash, unsigned int nBits, const Consensus::Params &params) {
+bool CheckProofOfWorkTarget(unsigned int nBits, const Consensus::Params &params) {
     bool fNegative;
     bool fOverflow;
     arith_uint256 bnTarget;
 
     bnTarget.SetCompact(nBits, &fNegative, &fOverflow);
+    return !(fNegative || bnTarget == 0 || fOverflow || bnTarget > UintToArith256(params.powLimit));
+}
+
+bool CheckProofOfWork(uint256 hash, unsigned int nBits, const Consensus::Params &params) {
     // Check range
-    if (fNegative || bnTarget == 0 || fOverflow || bnTarget > UintToArith256(params.powLimit))
+    if (!CheckProofOfWorkTarget(nBits, params))
         return false;
 
+    arith_uint256 bnTarget;
+    bnTarget.SetCompact(nBits);
+
     // Check proof of work matches claimed amount
     if (UintToArith256(hash) > bnTarget)
         return false;
@@ -26,4 +26,7 @@ unsigned int BorisRidiculouslyNamedDifficultyFunction(const CBlockIndex *pindexL
 /** Check whether a block hash satisfies the proof-of-work requirement specified by nBits */
 bool CheckProofOfWork(uint256 hash, unsigned int nBits, const Consensus::Params &);
 
+/** Check whether nBits is a target a block could be mined at, without looking at the block hash */
+bool CheckProofOfWorkTarget(unsigned int nBits, const Consensus::Params &);
+
 #endif // BITCOIN_POW_H
@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <string>
 #include "precomputed_hash.h"
+#include "primitives/powcache.h"
 
 
 
@@ -54,19 +55,13 @@ uint256 CBlockHeader::GetPoWHash(int nHeight) const {
 //    int64_t start = std::chrono::duration_cast<std::chrono::milliseconds>(
 //            std::chrono::system_clock::now().time_since_epoch()).count();
     bool fTestNet = (Params().NetworkIDString() == CBaseChainParams::TESTNET);
-    if (!fTestNet) {
-        if (nHeight < 20500) {
-            if (!mapPoWHash.count(1)) {
-//            std::cout << "Start Build Map" << std::endl;
-                buildMapPoWHash();
-            }
-        }
-        if (mapPoWHash.count(nHeight)) {
-//        std::cout << "GetPowHash nHeight=" << nHeight << ", hash= " << mapPoWHash[nHeight].ToString() << std::endl;
-            return mapPoWHash[nHeight];
-        }
-    }
+    if (!fTestNet && nHeight > 0 && nHeight < 20500)
+        return uint256S(precomputedHash[nHeight]);
+
+    uint256 hashBlock = GetHash();
     uint256 powHash;
+    if (powHashCache.Get(hashBlock, nHeight, powHash))
+        return powHash;
     try {
         if (!fTestNet && nHeight >= HF_LYRA2Z_HEIGHT) {
             lyra2z_hash(BEGIN(nVersion), BEGIN(powHash));
@@ -85,15 +80,41 @@ uint256 CBlockHeader::GetPoWHash(int nHeight) const {
         }
     } catch (std::exception &e) {
         LogPrintf("excepetion: %s", e.what());
+        return powHash;
     }
 //    int64_t end = std::chrono::duration_cast<std::chrono::milliseconds>(
 //            std::chrono::system_clock::now().time_since_epoch()).count();
 //    std::cout << "GetPowHash nHeight=" << nHeight << ", hash= " << powHash.ToString() << " done in= " << (end - start) << " miliseconds" << std::endl;
-    mapPoWHash.insert(make_pair(nHeight, powHash));
-//    SetPoWHash(thash);
+    powHashCache.Insert(hashBlock, nHeight, powHash);
     return powHash;
 }
 
+void ComputePoWHashes(const std::vector<CBlockHeader>& headers, int nFirstHeight, std::vector<uint256>& vPoWHashRet) {
+    bool fTestNet = (Params().NetworkIDString() == CBaseChainParams::TESTNET);
+    std::vector<size_t> vIndex;
+    std::vector<char> vInput;
+    vPoWHashRet.assign(headers.size(), uint256());
+    vIndex.reserve(headers.size());
+    vInput.reserve(headers.size() * 80);
+    for (size_t i = 0; i < headers.size(); i++) {
+        int nHeight = nFirstHeight + i;
+        // Mainnet heights below 20500 come from the precomputed table
+        if (fTestNet ? nHeight < HF_LYRA2Z_HEIGHT_TESTNET : nHeight < std::max(HF_LYRA2Z_HEIGHT, 20500))
+            continue;
+        if (powHashCache.Get(headers[i].GetHash(), nHeight, vPoWHashRet[i]))
+            continue;
+        vIndex.push_back(i);
+        vInput.insert(vInput.end(), BEGIN(headers[i].nVersion), BEGIN(headers[i].nVersion) + 80);
+    }
+    if (vIndex.empty())
+        return;
+
+    std::vector<char> vOutput(vIndex.size() * 32);
+    lyra2z_hash_batch(&vInput[0], vIndex.size(), &vOutput[0]);
+    for (size_t j = 0; j < vIndex.size(); j++)
+        memcpy(vPoWHashRet[vIndex[j]].begin(), &vOutput[j * 32], 32);
+}
+
 std::string CBlock::ToString() const {
     std::stringstream s;
     s << strprintf(
@@ -211,4 +211,12 @@ struct CBlockLocator
 /** Compute the consensus-critical block weight (see BIP 141). */
 int64_t GetBlockWeight(const CBlock& tx);
 
+/**
+ * Compute the PoW hashes of a run of consecutive headers, the first one at nFirstHeight.
+ * Lyra2Z headers are hashed several at a time, which is faster than hashing them one by one
+ * in GetPoWHash, or taken from the PoW hash cache. Nothing is added to the cache, and the
+ * hashes of headers below the Lyra2Z heights are left null.
+ */
+void ComputePoWHashes(const std::vector<CBlockHeader>& headers, int nFirstHeight, std::vector<uint256>& vPoWHashRet);
+
 #endif // BITCOIN_PRIMITIVES_BLOCK_H
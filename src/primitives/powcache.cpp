@@ -0,0 +1,113 @@
+// Copyright (c) 2016-2017 The Zerobitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "primitives/powcache.h"
+
+#include "prevector.h"
+#include "memusage.h"
+
+CPoWHashCache powHashCache;
+
+CPoWHashCache::CPoWHashCache(size_t nMaxUsage) : nHits(0), nMisses(0)
+{
+    nMaxEntriesPerShard = nMaxUsage / EntryUsage() / SHARDS;
+}
+
+size_t CPoWHashCache::EntryUsage()
+{
+    // One list node, one index node and one bucket pointer per entry
+    return memusage::MallocUsage(sizeof(Entry) + 2 * sizeof(void*)) +
+           memusage::MallocUsage(sizeof(memusage::boost_unordered_node<map_type::value_type>)) +
+           sizeof(void*);
+}
+
+CPoWHashCache::Shard& CPoWHashCache::GetShard(const uint256& hashBlock)
+{
+    // The index hashes the first 8 bytes, pick the shard from a different one
+    return shards[*(hashBlock.begin() + 8) % SHARDS];
+}
+
+bool CPoWHashCache::Get(const uint256& hashBlock, int nHeight, uint256& hashPoW)
+{
+    Shard& shard = GetShard(hashBlock);
+    {
+        boost::lock_guard<boost::mutex> lock(shard.cs);
+        map_type::iterator it = shard.index.find(hashBlock);
+        if (it != shard.index.end() && it->second->nHeight == nHeight) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            hashPoW = it->second->hashPoW;
+            nHits++;
+            return true;
+        }
+    }
+    nMisses++;
+    return false;
+}
+
+void CPoWHashCache::Insert(const uint256& hashBlock, int nHeight, const uint256& hashPoW)
+{
+    size_t nMaxEntries = nMaxEntriesPerShard;
+    if (nMaxEntries == 0)
+        return;
+
+    Shard& shard = GetShard(hashBlock);
+    boost::lock_guard<boost::mutex> lock(shard.cs);
+    map_type::iterator it = shard.index.find(hashBlock);
+    if (it != shard.index.end()) {
+        it->second->nHeight = nHeight;
+        it->second->hashPoW = hashPoW;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+
+    while (shard.index.size() >= nMaxEntries) {
+        shard.index.erase(shard.lru.back().hashBlock);
+        shard.lru.pop_back();
+    }
+    Entry entry;
+    entry.hashBlock = hashBlock;
+    entry.hashPoW = hashPoW;
+    entry.nHeight = nHeight;
+    shard.lru.push_front(entry);
+    shard.index.insert(std::make_pair(hashBlock, shard.lru.begin()));
+}
+
+void CPoWHashCache::SetMaxUsage(size_t nMaxUsage)
+{
+    size_t nMaxEntries = nMaxUsage / EntryUsage() / SHARDS;
+    nMaxEntriesPerShard = nMaxEntries;
+    for (int i = 0; i < SHARDS; i++) {
+        boost::lock_guard<boost::mutex> lock(shards[i].cs);
+        while (shards[i].index.size() > nMaxEntries) {
+            shards[i].index.erase(shards[i].lru.back().hashBlock);
+            shards[i].lru.pop_back();
+        }
+    }
+}
+
+void CPoWHashCache::Clear()
+{
+    for (int i = 0; i < SHARDS; i++) {
+        boost::lock_guard<boost::mutex> lock(shards[i].cs);
+        shards[i].index.clear();
+        shards[i].lru.clear();
+    }
+    nHits = 0;
+    nMisses = 0;
+}
+
+CPoWHashCacheStats CPoWHashCache::GetStats()
+{
+    CPoWHashCacheStats stats;
+    stats.nEntries = 0;
+    for (int i = 0; i < SHARDS; i++) {
+        boost::lock_guard<boost::mutex> lock(shards[i].cs);
+        stats.nEntries += shards[i].index.size();
+    }
+    stats.nUsage = stats.nEntries * EntryUsage();
+    stats.nMaxUsage = nMaxEntriesPerShard * SHARDS * EntryUsage();
+    stats.nHits = nHits;
+    stats.nMisses = nMisses;
+    return stats;
+}
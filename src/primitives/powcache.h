@@ -0,0 +1,90 @@
+// Copyright (c) 2016-2017 The Zerobitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_PRIMITIVES_POWCACHE_H
+#define BITCOIN_PRIMITIVES_POWCACHE_H
+
+#include "uint256.h"
+
+#include <atomic>
+#include <list>
+
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+
+//! Default for -powcachesize, maximum memory used by the PoW hash cache in MiB
+static const unsigned int DEFAULT_POW_CACHE_SIZE = 8;
+
+/** Snapshot of the PoW hash cache counters, see getpowcacheinfo */
+struct CPoWHashCacheStats
+{
+    size_t nEntries;
+    size_t nUsage;
+    size_t nMaxUsage;
+    uint64_t nHits;
+    uint64_t nMisses;
+};
+
+/**
+ * Bounded LRU cache of block header PoW hashes, keyed by the header hash.
+ * Lyra2Z is memory-hard and the same header is hashed by the message handler,
+ * RPC workers, the importer and the miner, so results are shared between them.
+ * The cache is split into independently locked shards to keep contention low.
+ */
+class CPoWHashCache
+{
+private:
+    static const int SHARDS = 16;
+
+    struct CacheHasher
+    {
+        size_t operator()(const uint256& key) const {
+            return key.GetCheapHash();
+        }
+    };
+
+    struct Entry
+    {
+        uint256 hashBlock;
+        uint256 hashPoW;
+        int nHeight;
+    };
+
+    typedef std::list<Entry> list_type;
+    typedef boost::unordered_map<uint256, list_type::iterator, CacheHasher> map_type;
+
+    struct Shard
+    {
+        boost::mutex cs;
+        //! Most recently used entries are at the front
+        list_type lru;
+        map_type index;
+    };
+
+    Shard shards[SHARDS];
+    std::atomic<size_t> nMaxEntriesPerShard;
+    std::atomic<uint64_t> nHits;
+    std::atomic<uint64_t> nMisses;
+
+    Shard& GetShard(const uint256& hashBlock);
+    static size_t EntryUsage();
+
+public:
+    CPoWHashCache(size_t nMaxUsage = DEFAULT_POW_CACHE_SIZE << 20);
+
+    /** Look up the PoW hash of a header. The height is part of the key, as it selects the algorithm. */
+    bool Get(const uint256& hashBlock, int nHeight, uint256& hashPoW);
+    void Insert(const uint256& hashBlock, int nHeight, const uint256& hashPoW);
+
+    /** Change the memory limit, evicting least recently used entries if needed */
+    void SetMaxUsage(size_t nMaxUsage);
+    void Clear();
+    CPoWHashCacheStats GetStats();
+};
+
+/** Process-wide cache used by CBlockHeader::GetPoWHash */
+extern CPoWHashCache powHashCache;
+
+#endif // BITCOIN_PRIMITIVES_POWCACHE_H
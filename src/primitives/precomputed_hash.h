@@ -4,8 +4,6 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
-static map<int, uint256> mapPoWHash;
-
 const char *precomputedHash[20501] = {
         "",
         "00000da58fce09f363bf5bb42409fbc2aabfc8b58c2211b24a3d7e2a7deedc90", "000009614e788eaeb5a3647d4313f37c8be994c678f10b7462476c1605c4c8df", "000008404d2723be9fb2eb0d4d1d1541ca1e823909faf572fa1d11097fc0123a", "000007c74d283118c293bfee54c5085573ab887549ed09a8d8d8664269c79685",
@@ -5134,9 +5132,3 @@ const char *precomputedHash[20501] = {
         "0000001493783dc106eca2e13943634447a123461a1e6c6171e55efe47b6f0ee", "00000007475c059d99e2dc7dc86b98e38717a298da564e9d2dda585c9d4693cf", "00000024e20b3082abe9b28203f1c7344c610252bebe672839a3bf8e3b8d894c", "00000002b9db9de70050a3761f26e8eb40ea16d5c9eba5aafb822794c4ec4a6b",
         "0000000da1e36c4636dcc335a04f92eadd914b6b7ba7c491d57e885ee51910fe", "00000027ac4851b1295226716709fc7903f12c13499db94e39a8748f3a022308", "0000001f3ae8427fd5c6ae82f345b67a5bfa81812b3013d106dc1bab080a2074", "0000000000652474481a18f6affe29ed9a5b9f20045a331f0ce5c734b770d4d2"
 };
-
-void buildMapPoWHash() {
-    for (int i=1; i<20500; i++) {
-        mapPoWHash.insert(make_pair(i, uint256S(precomputedHash[i])));
-    }
-};
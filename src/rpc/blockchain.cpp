@@ -11,6 +11,7 @@
 #include "consensus/validation.h"
 #include "main.h"
 #include "policy/policy.h"
+#include "primitives/powcache.h"
 #include "primitives/transaction.h"
 #include "rpc/server.h"
 #include "streams.h"
@@ -19,6 +20,7 @@
 #include "util.h"
 #include "utilstrencodings.h"
 #include "hash.h"
+#include "zerocoin.h"
 
 #include <stdint.h>
 
@@ -1111,6 +1113,103 @@ UniValue getmempoolinfo(const UniValue& params, bool fHelp)
     return mempoolInfoToJSON();
 }
 
+UniValue getpowcacheinfo(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() != 0)
+        throw runtime_error(
+            "getpowcacheinfo\n"
+            "\nReturns details on the block header proof-of-work hash cache.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"entries\": xxxxx,            (numeric) Number of cached PoW hashes\n"
+            "  \"usage\": xxxxx,              (numeric) Estimated memory usage of the cache\n"
+            "  \"maxusage\": xxxxx,           (numeric) Maximum memory usage of the cache\n"
+            "  \"hits\": xxxxx,               (numeric) Lookups answered from the cache\n"
+            "  \"misses\": xxxxx              (numeric) Lookups that required hashing the header\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getpowcacheinfo", "")
+            + HelpExampleRpc("getpowcacheinfo", "")
+        );
+
+    CPoWHashCacheStats stats = powHashCache.GetStats();
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("entries", (int64_t) stats.nEntries));
+    ret.push_back(Pair("usage", (int64_t) stats.nUsage));
+    ret.push_back(Pair("maxusage", (int64_t) stats.nMaxUsage));
+    ret.push_back(Pair("hits", (int64_t) stats.nHits));
+    ret.push_back(Pair("misses", (int64_t) stats.nMisses));
+    return ret;
+}
+
+UniValue getzerocoinspendcacheinfo(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() != 0)
+        throw runtime_error(
+            "getzerocoinspendcacheinfo\n"
+            "\nReturns details on the cache of verified zerocoin spend proofs.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"entries\": xxxxx,            (numeric) Number of cached spend proofs\n"
+            "  \"usage\": xxxxx,              (numeric) Estimated memory usage of the cache\n"
+            "  \"maxusage\": xxxxx,           (numeric) Maximum memory usage of the cache\n"
+            "  \"hits\": xxxxx,               (numeric) Spends whose proof was found in the cache\n"
+            "  \"misses\": xxxxx              (numeric) Spends whose proof had to be verified\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getzerocoinspendcacheinfo", "")
+            + HelpExampleRpc("getzerocoinspendcacheinfo", "")
+        );
+
+    CZerocoinSpendCacheStats stats = zerocoinSpendCache.GetStats();
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("entries", (int64_t) stats.nEntries));
+    ret.push_back(Pair("usage", (int64_t) stats.nUsage));
+    ret.push_back(Pair("maxusage", (int64_t) stats.nMaxUsage));
+    ret.push_back(Pair("hits", (int64_t) stats.nHits));
+    ret.push_back(Pair("misses", (int64_t) stats.nMisses));
+    return ret;
+}
+
+UniValue getzerocointhreadpoolinfo(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() != 0)
+        throw runtime_error(
+            "getzerocointhreadpoolinfo\n"
+            "\nReturns details on the thread pool verifying and creating zerocoin proofs.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"threads\": xxxxx,                   (numeric) Number of threads, 0 until the first task\n"
+            "  \"highpriorityqueued\": xxxxx,        (numeric) Block validation tasks waiting for a thread\n"
+            "  \"queued\": xxxxx,                    (numeric) Other tasks waiting for a thread\n"
+            "  \"highprioritytasks\": xxxxx,         (numeric) Block validation tasks run so far\n"
+            "  \"highprioritylatency\": xxxxx,       (numeric) Average time in microseconds they spent queued\n"
+            "  \"maxhighprioritylatency\": xxxxx,    (numeric) Longest time in microseconds one of them spent queued\n"
+            "  \"tasks\": xxxxx,                     (numeric) Other tasks run so far\n"
+            "  \"latency\": xxxxx,                   (numeric) Average time in microseconds they spent queued\n"
+            "  \"maxlatency\": xxxxx,                (numeric) Longest time in microseconds one of them spent queued\n"
+            "  \"stolen\": xxxxx                     (numeric) Tasks run by a thread other than the one they were queued to\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getzerocointhreadpoolinfo", "")
+            + HelpExampleRpc("getzerocointhreadpoolinfo", "")
+        );
+
+    libzerocoin::ParallelTasksStats stats = libzerocoin::ParallelTasks::GetStats();
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("threads", (int64_t) stats.nThreads));
+    ret.push_back(Pair("highpriorityqueued", (int64_t) stats.nHighPriorityQueued));
+    ret.push_back(Pair("queued", (int64_t) stats.nQueued));
+    ret.push_back(Pair("highprioritytasks", (int64_t) stats.nHighPriorityTasks));
+    ret.push_back(Pair("highprioritylatency", (int64_t) (stats.nHighPriorityTasks ? stats.nHighPriorityLatencyMicros / stats.nHighPriorityTasks : 0)));
+    ret.push_back(Pair("maxhighprioritylatency", (int64_t) stats.nMaxHighPriorityLatencyMicros));
+    ret.push_back(Pair("tasks", (int64_t) stats.nTasks));
+    ret.push_back(Pair("latency", (int64_t) (stats.nTasks ? stats.nLatencyMicros / stats.nTasks : 0)));
+    ret.push_back(Pair("maxlatency", (int64_t) stats.nMaxLatencyMicros));
+    ret.push_back(Pair("stolen", (int64_t) stats.nStolen));
+    return ret;
+}
+
 UniValue invalidateblock(const UniValue& params, bool fHelp)
 {
     if (fHelp || params.size() != 1)
@@ -1201,6 +1300,9 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getmempooldescendants",  &getmempooldescendants,  true  },
     { "blockchain",         "getmempoolentry",        &getmempoolentry,        true  },
     { "blockchain",         "getmempoolinfo",         &getmempoolinfo,         true  },
+    { "blockchain",         "getpowcacheinfo",        &getpowcacheinfo,        true  },
+    { "blockchain",         "getzerocoinspendcacheinfo", &getzerocoinspendcacheinfo, true  },
+    { "blockchain",         "getzerocointhreadpoolinfo", &getzerocointhreadpoolinfo, true  },
     { "blockchain",         "getrawmempool",          &getrawmempool,          true  },
     { "blockchain",         "gettxout",               &gettxout,               true  },
     { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        true  },
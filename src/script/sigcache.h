@@ -8,14 +8,125 @@
 
 #include "script/interpreter.h"
 
+#include "crypto/sha256.h"
+#include "memusage.h"
+#include "random.h"
+#include "uint256.h"
+
+#include <atomic>
 #include <vector>
 
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/unordered_set.hpp>
+
 // DoS prevention: limit cache size to less than 40MB (over 500000
 // entries on 64-bit systems).
 static const unsigned int DEFAULT_MAX_SIG_CACHE_SIZE = 40;
 
 class CPubKey;
 
+/**
+ * We're hashing a nonce into the entries themselves, so we don't need extra
+ * blinding in the set hash computation.
+ */
+class CSaltedEntryHasher
+{
+public:
+    size_t operator()(const uint256& key) const {
+        return key.GetCheapHash();
+    }
+};
+
+/**
+ * Set of results known to hold, to avoid doing an expensive check twice.
+ * Entries are SHA256(nonce || everything the result depends on), computed by
+ * the caller from Salted(). When the set uses more than its memory limit, a
+ * random entry is evicted.
+ */
+template <typename Hasher = CSaltedEntryHasher>
+class CSaltedHashSet
+{
+private:
+    typedef boost::unordered_set<uint256, Hasher> set_type;
+
+    uint256 nonce;
+    set_type setEntries;
+    std::atomic<size_t> nMaxUsage;
+    mutable boost::shared_mutex cs;
+
+    void Trim(size_t nMax)
+    {
+        while (!setEntries.empty() && memusage::DynamicUsage(setEntries) > nMax) {
+            typename set_type::size_type s = GetRand(setEntries.bucket_count());
+            typename set_type::local_iterator it = setEntries.begin(s);
+            if (it != setEntries.end(s)) {
+                setEntries.erase(*it);
+            }
+        }
+    }
+
+public:
+    explicit CSaltedHashSet(size_t nMaxUsageIn) : nMaxUsage(nMaxUsageIn)
+    {
+        GetRandBytes(nonce.begin(), 32);
+    }
+
+    //! Hasher with the nonce already written, to compute entries with
+    CSHA256 Salted() const
+    {
+        CSHA256 hasher;
+        hasher.Write(nonce.begin(), 32);
+        return hasher;
+    }
+
+    bool Contains(const uint256& entry) const
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs);
+        return setEntries.count(entry) > 0;
+    }
+
+    void Erase(const uint256& entry)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs);
+        setEntries.erase(entry);
+    }
+
+    void Insert(const uint256& entry)
+    {
+        size_t nMax = nMaxUsage;
+        if (nMax == 0) return;
+
+        boost::unique_lock<boost::shared_mutex> lock(cs);
+        Trim(nMax);
+        setEntries.insert(entry);
+    }
+
+    /** Change the memory limit, evicting entries if needed */
+    void SetMaxUsage(size_t nMaxUsageIn)
+    {
+        nMaxUsage = nMaxUsageIn;
+        boost::unique_lock<boost::shared_mutex> lock(cs);
+        if (nMaxUsageIn == 0)
+            setEntries.clear();
+        Trim(nMaxUsageIn);
+    }
+
+    size_t GetMaxUsage() const { return nMaxUsage; }
+
+    size_t Size() const
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs);
+        return setEntries.size();
+    }
+
+    size_t DynamicUsage() const
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs);
+        return memusage::DynamicUsage(setEntries);
+    }
+};
+
 class CachingTransactionSignatureChecker : public TransactionSignatureChecker
 {
 private:
@@ -9,6 +9,8 @@
 #include "crypto/sha512.h"
 #include "crypto/hmac_sha256.h"
 #include "crypto/hmac_sha512.h"
+#include "crypto/Lyra2Z/Lyra2.h"
+#include "crypto/Lyra2Z/Lyra2Z.h"
 #include "random.h"
 #include "utilstrencodings.h"
 #include "test/test_bitcoin.h"
@@ -187,6 +189,20 @@ void TestAES256CBC(const std::string &hexkey, const std::string &hexiv, bool pad
     }
 }
 
+void TestLyra2Z(const std::vector<unsigned char> &in, const std::string &hexout)
+{
+    unsigned char out[32];
+    lyra2z_hash((const char*)&in[0], (char*)out);
+    BOOST_CHECK_EQUAL(HexStr(out, out + 32), hexout);
+}
+
+void TestLyra2(const std::vector<unsigned char> &in, uint64_t timeCost, uint64_t nRows, uint64_t nCols, const std::string &hexout)
+{
+    unsigned char out[32];
+    BOOST_CHECK_EQUAL(LYRA2(out, 32, &in[0], in.size() / 2, &in[in.size() / 2], in.size() / 2, timeCost, nRows, nCols), 0);
+    BOOST_CHECK_EQUAL(HexStr(out, out + 32), hexout);
+}
+
 std::string LongTestString(void) {
     std::string ret;
     for (int i=0; i<200000; i++) {
@@ -439,4 +455,57 @@ BOOST_AUTO_TEST_CASE(aes_cbc_testvectors) {
                   "b2eb05e2c39be9fcda6c19078c6a9d1b3f461796d6b0d6b2e0c2a72b4d80e644");
 }
 
+BOOST_AUTO_TEST_CASE(lyra2z_testvectors) {
+    // Computed with the portable implementation, every vectorized one must match it bit for bit
+    std::vector<unsigned char> zero(80, 0), counting(80), falling(80);
+    for (int i = 0; i < 80; i++) {
+        counting[i] = i;
+        falling[i] = 0xff - 3 * i;
+    }
+    const char* impls[] = {"generic", "sse2", "avx2", "avx512"};
+    for (unsigned int i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+        if (!lyra2_select_impl(impls[i]))
+            continue;
+        BOOST_TEST_MESSAGE(std::string("lyra2 implementation: ") + impls[i]);
+        TestLyra2Z(zero, "9b63bf262ec6f678d73e101f57dadcfe07b6d1f01c2b6ebfbc84ed3fa2be947d");
+        TestLyra2Z(counting, "6b0ded5afb3b27cf0e601243ffd9b37ee65331a2d46c7add2a6a826958ab1c0b");
+        TestLyra2Z(falling, "78ac4636c695b18dd21db57b31bfa496442899d7a236b4411509548ff64cd09d");
+        // Parameter sets too large for the per-thread scratch matrix
+        std::vector<unsigned char> doubled(counting);
+        doubled.insert(doubled.end(), counting.begin(), counting.end());
+        TestLyra2(doubled, 2, 16, 256, "255f3fd2f99f1f58453685699ec8e2e981250ef87425db2b16a5b0efd552c696");
+        TestLyra2(doubled, 2, 330, 256, "bbc07308856eef2305237fd2aa662c6573d2e173fddee568788bc30048d54ab0");
+        TestLyra2(std::vector<unsigned char>(counting.begin(), counting.begin() + 64), 1, 4, 4,
+                  "7297aa2f78e27ac1fd957a42465d81633c647762718b483aaac048a2e76d73e5");
+    }
+    lyra2_detect_simd();
+}
+
+BOOST_AUTO_TEST_CASE(lyra2z_batch) {
+    // Seven headers, so every batch width leaves a remainder hashed one at a time
+    std::vector<unsigned char> counting(80), falling(80);
+    for (int i = 0; i < 80; i++) {
+        counting[i] = i;
+        falling[i] = 0xff - 3 * i;
+    }
+    const std::vector<unsigned char>* inputs[] = {&counting, &falling};
+    const char* hashes[] = {"6b0ded5afb3b27cf0e601243ffd9b37ee65331a2d46c7add2a6a826958ab1c0b",
+                            "78ac4636c695b18dd21db57b31bfa496442899d7a236b4411509548ff64cd09d"};
+    std::vector<unsigned char> headers;
+    for (int n = 0; n < 7; n++)
+        headers.insert(headers.end(), inputs[n % 2]->begin(), inputs[n % 2]->end());
+
+    const char* impls[] = {"generic", "sse2", "avx2", "avx512"};
+    for (unsigned int i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+        if (!lyra2_select_impl(impls[i]))
+            continue;
+        BOOST_TEST_MESSAGE(std::string("lyra2 implementation: ") + impls[i]);
+        std::vector<unsigned char> out(7 * 32);
+        lyra2z_hash_batch((const char*)&headers[0], 7, (char*)&out[0]);
+        for (int n = 0; n < 7; n++)
+            BOOST_CHECK_EQUAL(HexStr(out.begin() + n * 32, out.begin() + (n + 1) * 32), hashes[n % 2]);
+    }
+    lyra2_detect_simd();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,547 @@
+// Copyright (c) 2016-2017 The Zerobitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "main.h"
+#include "random.h"
+#include "streams.h"
+#include "txdb.h"
+#include "zeronode-payments.h"
+#include "zerocoin.h"
+#include "zerocoin_params.h"
+
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(zerocoin_tests, TestingSetup)
+
+// Block index entry with a random hash, owned by mapBlockIndex
+static CBlockIndex *AddTestBlock(CBlockIndex *pprev, int nHeight)
+{
+    CBlockIndex *pindex = new CBlockIndex();
+    BlockMap::iterator mi = mapBlockIndex.insert(std::make_pair(GetRandHash(), pindex)).first;
+    pindex->phashBlock = &mi->first;
+    pindex->pprev = pprev;
+    pindex->nHeight = nHeight;
+    return pindex;
+}
+
+BOOST_AUTO_TEST_CASE(zerocoin_state_db)
+{
+    const std::pair<int,int> denomAndId = std::make_pair(1, 1);
+    CBigNum coinRange = CBigNum(2).pow(1024);
+    CBigNum coin1 = CBigNum::randBignum(coinRange), coin2 = CBigNum::randBignum(coinRange), coin3 = CBigNum::randBignum(coinRange);
+    CBigNum serial = CBigNum::randBignum(CBigNum(2).pow(256));
+    CBigNum acc1 = CBigNum::randBignum(coinRange), acc2 = CBigNum::randBignum(coinRange);
+
+    CBlockIndex *genesis = chainActive.Genesis();
+    CBlockIndex *block1 = AddTestBlock(genesis, ZC_CHECK_BUG_FIXED_AT_BLOCK + 1);
+    CZerocoinBlockInfo info1;
+    info1.mintedPubCoins[denomAndId].push_back(coin1);
+    info1.mintedPubCoins[denomAndId].push_back(coin2);
+    info1.accumulatorChanges[denomAndId] = std::make_pair(acc1, 2);
+    ZerocoinSetBlockInfo(block1, info1);
+    CBlockIndex *block2 = AddTestBlock(block1, ZC_CHECK_BUG_FIXED_AT_BLOCK + 2);
+    CZerocoinBlockInfo info2;
+    info2.mintedPubCoins[denomAndId].push_back(coin3);
+    info2.accumulatorChanges[denomAndId] = std::make_pair(acc2, 1);
+    info2.spentSerials.insert(serial);
+    ZerocoinSetBlockInfo(block2, info2);
+
+    CZerocoinState state;
+    state.AddBlock(block1);
+    state.AddBlock(block2);
+    BOOST_CHECK(state.Flush(block2->GetBlockHash()));
+
+    uint256 hashBestBlock;
+    BOOST_CHECK(pzerocoindb->ReadBestBlock(hashBestBlock));
+    BOOST_CHECK(hashBestBlock == block2->GetBlockHash());
+
+    // Only the coin groups are read on load, coins and serials come from the database on demand
+    CZerocoinState loaded;
+    BOOST_CHECK(loaded.Load());
+    BOOST_CHECK(loaded.HasCoin(coin1) && loaded.HasCoin(coin2) && loaded.HasCoin(coin3));
+    BOOST_CHECK(loaded.IsUsedCoinSerial(serial));
+    BOOST_CHECK(!loaded.IsUsedCoinSerial(coin1));
+
+    CZerocoinState::CoinGroupInfo group;
+    BOOST_CHECK(loaded.GetCoinGroupInfo(1, 1, group));
+    BOOST_CHECK(group.firstBlock == block1 && group.lastBlock == block2);
+    BOOST_CHECK_EQUAL(group.nCoins, 3);
+
+    int id = 0;
+    BOOST_CHECK_EQUAL(loaded.GetMintedCoinHeightAndId(coin3, 1, id), block2->nHeight);
+    BOOST_CHECK_EQUAL(id, 1);
+    BOOST_CHECK_EQUAL(loaded.GetMintedCoinHeightAndId(coin3, 10, id), -1);
+
+    CBigNum accumulator;
+    uint256 accumulatorBlockHash;
+    BOOST_CHECK_EQUAL(loaded.GetAccumulatorValueForSpend(block2->nHeight, 1, 1, accumulator, accumulatorBlockHash), 3);
+    BOOST_CHECK(accumulator == acc2 && accumulatorBlockHash == block2->GetBlockHash());
+
+    // Roll back a block that was already written
+    loaded.RemoveBlock(block2);
+    BOOST_CHECK(loaded.Flush(block1->GetBlockHash()));
+
+    CZerocoinState reloaded;
+    BOOST_CHECK(reloaded.Load());
+    BOOST_CHECK(reloaded.HasCoin(coin1) && !reloaded.HasCoin(coin3));
+    BOOST_CHECK(!reloaded.IsUsedCoinSerial(serial));
+    BOOST_CHECK(reloaded.GetCoinGroupInfo(1, 1, group));
+    BOOST_CHECK(group.lastBlock == block1);
+    BOOST_CHECK_EQUAL(group.nCoins, 2);
+
+    // Removing the last coins of a group erases it
+    reloaded.RemoveBlock(block1);
+    BOOST_CHECK(reloaded.Flush(genesis->GetBlockHash()));
+    BOOST_CHECK(state.Load());
+    BOOST_CHECK(!state.GetCoinGroupInfo(1, 1, group));
+    BOOST_CHECK(!state.HasCoin(coin1));
+
+    BOOST_CHECK(pzerocoindb->Wipe());
+    BOOST_CHECK(!pzerocoindb->ReadBestBlock(hashBestBlock));
+}
+
+BOOST_AUTO_TEST_CASE(zerocoin_accumulator_checkpoints)
+{
+    const std::pair<int,int> denomAndId = std::make_pair(10, 1);
+    CBigNum coinRange = CBigNum(2).pow(1024);
+    CBigNum coin1 = CBigNum::randBignum(coinRange), coin2 = CBigNum::randBignum(coinRange), coin3 = CBigNum::randBignum(coinRange);
+    CBigNum acc1 = CBigNum::randBignum(coinRange), acc3 = CBigNum::randBignum(coinRange);
+
+    // Mints in the first and the third block, none in between
+    CBlockIndex *block1 = AddTestBlock(chainActive.Genesis(), 1);
+    CZerocoinBlockInfo info1;
+    info1.mintedPubCoins[denomAndId].push_back(coin1);
+    info1.accumulatorChanges[denomAndId] = std::make_pair(acc1, 1);
+    ZerocoinSetBlockInfo(block1, info1);
+    CBlockIndex *block2 = AddTestBlock(block1, 2);
+    CBlockIndex *block3 = AddTestBlock(block2, 3);
+    CZerocoinBlockInfo info3;
+    info3.mintedPubCoins[denomAndId].push_back(coin2);
+    info3.mintedPubCoins[denomAndId].push_back(coin3);
+    info3.accumulatorChanges[denomAndId] = std::make_pair(acc3, 2);
+    ZerocoinSetBlockInfo(block3, info3);
+
+    CZerocoinState state;
+    state.AddBlock(block1);
+    state.AddBlock(block3);
+
+    CBigNum accumulator;
+    uint256 accumulatorBlockHash;
+    BOOST_CHECK_EQUAL(state.GetAccumulatorValueForSpend(0, 10, 1, accumulator, accumulatorBlockHash), 0);
+    BOOST_CHECK_EQUAL(state.GetAccumulatorValueForSpend(2, 10, 1, accumulator, accumulatorBlockHash), 1);
+    BOOST_CHECK(accumulator == acc1 && accumulatorBlockHash == block1->GetBlockHash());
+    BOOST_CHECK_EQUAL(state.GetAccumulatorValueForSpend(INT_MAX, 10, 1, accumulator, accumulatorBlockHash), 3);
+    BOOST_CHECK(accumulator == acc3 && accumulatorBlockHash == block3->GetBlockHash());
+
+    // All the values latest first, or the value of the given block of the group
+    std::vector<CBigNum> values;
+    state.GetAccumulatorValuesForSpend(10, 1, uint256(), values);
+    BOOST_CHECK(values.size() == 2 && values[0] == acc3 && values[1] == acc1);
+    values.clear();
+    state.GetAccumulatorValuesForSpend(10, 1, block3->GetBlockHash(), values);
+    BOOST_CHECK(values.size() == 1 && values[0] == acc3);
+    values.clear();
+    state.GetAccumulatorValuesForSpend(10, 1, block2->GetBlockHash(), values);
+    BOOST_CHECK(values.empty());
+    values.clear();
+    state.GetAccumulatorValuesForSpend(10, 1, GetRandHash(), values);
+    BOOST_CHECK(values.size() == 1 && values[0] == acc1);
+
+    std::vector<CBigNum> pubCoins;
+    state.GetCoinGroupPubCoins(10, 1, pubCoins);
+    BOOST_CHECK(pubCoins.size() == 3 && pubCoins[0] == coin1 && pubCoins[1] == coin2 && pubCoins[2] == coin3);
+
+    // A new mint continues from the latest value
+    CBlockIndex *block4 = AddTestBlock(block3, 4);
+    CBigNum previousAccValue;
+    BOOST_CHECK_EQUAL(state.AddMint(block4, 10, CBigNum::randBignum(coinRange), previousAccValue), 1);
+    BOOST_CHECK(previousAccValue == acc3);
+
+    // Rolling back uses the checkpoints built from the block index
+    CZerocoinState::CoinGroupInfo group;
+    state.Reset();
+    state.AddBlock(block1);
+    state.AddBlock(block3);
+    state.RemoveBlock(block3);
+    BOOST_CHECK(state.GetCoinGroupInfo(10, 1, group));
+    BOOST_CHECK(group.lastBlock == block1);
+    BOOST_CHECK_EQUAL(group.nCoins, 1);
+    BOOST_CHECK_EQUAL(state.GetAccumulatorValueForSpend(INT_MAX, 10, 1, accumulator, accumulatorBlockHash), 1);
+    BOOST_CHECK(accumulator == acc1);
+}
+
+BOOST_AUTO_TEST_CASE(zerocoin_witness_advance)
+{
+    const std::pair<int,int> denomAndId = std::make_pair((int)libzerocoin::ZQ_LOVELACE, 1);
+    const libzerocoin::Params &params = *ZerocoinParams();
+    libzerocoin::Accumulator accumulator(&params, libzerocoin::ZQ_LOVELACE);
+
+    // Three blocks with two coins each, the first coin is ours
+    CZerocoinState state;
+    std::vector<CBlockIndex*> blocks;
+    CBigNum pubCoin;
+    CBlockIndex *pprev = chainActive.Genesis();
+    for (int i = 0; i < 3; i++) {
+        CBlockIndex *pindex = AddTestBlock(pprev, i + 1);
+        CZerocoinBlockInfo info;
+        for (int j = 0; j < 2; j++) {
+            CBigNum coin = CBigNum::randBignum(CBigNum(2).pow(256));
+            if (pubCoin == 0)
+                pubCoin = coin;
+            accumulator += libzerocoin::PublicCoin(&params, coin, libzerocoin::ZQ_LOVELACE);
+            info.mintedPubCoins[denomAndId].push_back(coin);
+        }
+        info.accumulatorChanges[denomAndId] = std::make_pair(accumulator.getValue(), 2);
+        ZerocoinSetBlockInfo(pindex, info);
+        state.AddBlock(pindex);
+        blocks.push_back(pindex);
+        pprev = pindex;
+    }
+
+    CBigNum witnessValue;
+    uint256 witnessBlockHash;
+    BOOST_CHECK(state.AdvanceWitness(2, libzerocoin::ZQ_LOVELACE, 1, pubCoin, witnessValue, witnessBlockHash));
+    BOOST_CHECK(witnessBlockHash == blocks[1]->GetBlockHash());
+
+    // Advancing the cached witness gives the same value as making it from the mint
+    BOOST_CHECK(state.AdvanceWitness(INT_MAX, libzerocoin::ZQ_LOVELACE, 1, pubCoin, witnessValue, witnessBlockHash));
+    BOOST_CHECK(witnessBlockHash == blocks[2]->GetBlockHash());
+    CBigNum freshValue;
+    uint256 freshBlockHash;
+    BOOST_CHECK(state.AdvanceWitness(INT_MAX, libzerocoin::ZQ_LOVELACE, 1, pubCoin, freshValue, freshBlockHash));
+    BOOST_CHECK(freshValue == witnessValue && freshBlockHash == witnessBlockHash);
+
+    libzerocoin::AccumulatorWitness witness(&params, libzerocoin::Accumulator(&params, witnessValue, libzerocoin::ZQ_LOVELACE),
+                                            libzerocoin::PublicCoin(&params, pubCoin, libzerocoin::ZQ_LOVELACE));
+    BOOST_CHECK(witness.VerifyWitness(accumulator, libzerocoin::PublicCoin(&params, pubCoin, libzerocoin::ZQ_LOVELACE)));
+
+    // A witness for a disconnected block is made again
+    state.RemoveBlock(blocks[2]);
+    BOOST_CHECK(state.AdvanceWitness(INT_MAX, libzerocoin::ZQ_LOVELACE, 1, pubCoin, witnessValue, witnessBlockHash));
+    BOOST_CHECK(witnessBlockHash == blocks[1]->GetBlockHash());
+    libzerocoin::Accumulator accumulatorAtBlock2(&params, ZerocoinGetBlockInfo(blocks[1])->accumulatorChanges.at(denomAndId).first,
+                                                 libzerocoin::ZQ_LOVELACE);
+    libzerocoin::AccumulatorWitness witnessAtBlock2(&params, libzerocoin::Accumulator(&params, witnessValue, libzerocoin::ZQ_LOVELACE),
+                                                    libzerocoin::PublicCoin(&params, pubCoin, libzerocoin::ZQ_LOVELACE));
+    BOOST_CHECK(witnessAtBlock2.VerifyWitness(accumulatorAtBlock2, libzerocoin::PublicCoin(&params, pubCoin, libzerocoin::ZQ_LOVELACE)));
+}
+
+BOOST_AUTO_TEST_CASE(zerocoin_batch_verify)
+{
+    const libzerocoin::Params &params = *ZerocoinParams();
+
+    // A spend of the first of two coins, deserialized as it would be from a transaction
+    libzerocoin::PrivateCoin coin(&params, libzerocoin::ZQ_LOVELACE);
+    libzerocoin::PublicCoin otherCoin(&params, CBigNum::randBignum(params.accumulatorParams.maxCoinValue), libzerocoin::ZQ_LOVELACE);
+    libzerocoin::Accumulator accumulator(&params, libzerocoin::ZQ_LOVELACE);
+    libzerocoin::Accumulator accumulatorWithoutCoin(&params, libzerocoin::ZQ_LOVELACE);
+    libzerocoin::AccumulatorWitness witness(&params, accumulator, coin.getPublicCoin());
+    accumulator += coin.getPublicCoin();
+    accumulator += otherCoin;
+    accumulatorWithoutCoin += otherCoin;
+    witness += otherCoin;
+    libzerocoin::SpendMetaData metaData(1, GetRandHash());
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << libzerocoin::CoinSpend(&params, coin, accumulator, witness, metaData);
+    std::shared_ptr<libzerocoin::CoinSpend> spend = std::make_shared<libzerocoin::CoinSpend>(&params, ss);
+
+    // Every result is the one of CoinSpend::Verify
+    libzerocoin::BatchVerifier batch(&params);
+    size_t valid = batch.Add(*spend, accumulator, metaData);
+    size_t wrongAccumulator = batch.Add(*spend, accumulatorWithoutCoin, metaData);
+    size_t wrongDenomination = batch.Add(*spend, libzerocoin::Accumulator(&params, accumulator.getValue(), libzerocoin::ZQ_GOLDWASSER), metaData);
+    BOOST_CHECK(!batch.Verify());
+    BOOST_CHECK(batch.GetResult(valid) && spend->Verify(accumulator, metaData));
+    BOOST_CHECK(!batch.GetResult(wrongAccumulator) && !spend->Verify(accumulatorWithoutCoin, metaData));
+    BOOST_CHECK(!batch.GetResult(wrongDenomination));
+    batch.Clear();
+    batch.Add(*spend, accumulator, metaData);
+    batch.Add(*spend, accumulator, metaData);
+    BOOST_CHECK(batch.Verify());
+
+    // A spend that fails against the latest accumulator value is retried against the older ones
+    std::vector<CZerocoinSpendCheck> checks;
+    checks.push_back(CZerocoinSpendCheck(spend, libzerocoin::ZQ_LOVELACE, 1, metaData.txHash, 1));
+    checks.back().AddAccumulatorValue(accumulatorWithoutCoin.getValue());
+    checks.back().AddAccumulatorValue(accumulator.getValue());
+    BOOST_CHECK(CZerocoinSpendCheck::VerifyBatch(checks));
+    checks.push_back(CZerocoinSpendCheck(spend, libzerocoin::ZQ_LOVELACE, 1, metaData.txHash, 1));
+    checks.back().AddAccumulatorValue(accumulatorWithoutCoin.getValue());
+    BOOST_CHECK(!CZerocoinSpendCheck::VerifyBatch(checks));
+
+    // A spend proven on mempool acceptance is not proven again for the block, as long as the
+    // accumulator value is the same
+    uint256 hashTx = GetRandHash();
+    std::vector<CZerocoinSpendCheck> mempoolChecks(1, CZerocoinSpendCheck(spend, libzerocoin::ZQ_LOVELACE, 1, metaData.txHash, INT_MAX));
+    mempoolChecks[0].SetCacheKey(hashTx, 0);
+    mempoolChecks[0].AddAccumulatorValue(accumulator.getValue());
+    std::vector<CZerocoinSpendCheck> blockChecks = mempoolChecks, otherAccumulatorChecks = mempoolChecks;
+    BOOST_CHECK(CZerocoinSpendCheck::VerifyBatch(mempoolChecks, true));
+    CZerocoinSpendCacheStats stats = zerocoinSpendCache.GetStats();
+    BOOST_CHECK(CZerocoinSpendCheck::VerifyBatch(blockChecks));
+    BOOST_CHECK_EQUAL(zerocoinSpendCache.GetStats().nHits, stats.nHits + 1);
+    otherAccumulatorChecks[0] = CZerocoinSpendCheck(spend, libzerocoin::ZQ_LOVELACE, 1, metaData.txHash, 1);
+    otherAccumulatorChecks[0].SetCacheKey(hashTx, 0);
+    otherAccumulatorChecks[0].AddAccumulatorValue(accumulatorWithoutCoin.getValue());
+    BOOST_CHECK(!CZerocoinSpendCheck::VerifyBatch(otherAccumulatorChecks));
+    BOOST_CHECK_EQUAL(zerocoinSpendCache.GetStats().nMisses, stats.nMisses + 1);
+}
+
+// Fixed-base tables of a group against plain pow_mod, with negative exponents and exponents longer than the table
+static void CheckGroupTables(const libzerocoin::IntegerGroupParams &group, const CBigNum &modulus)
+{
+    BOOST_REQUIRE(group.gTable && group.hTable);
+    for (uint32_t i = 0; i < 10; i++) {
+        CBigNum e = CBigNum::randBignum(CBigNum(2).pow(i * modulus.bitSize() / 3 + 1));
+        if (i % 2)
+            e = 0 - e;
+        BOOST_CHECK(group.powG(e, modulus) == group.g.pow_mod(e, modulus));
+        BOOST_CHECK(group.powH(e, modulus) == group.h.pow_mod(e, modulus));
+    }
+    BOOST_CHECK(group.powG(CBigNum(0), modulus) == CBigNum(1));
+}
+
+BOOST_AUTO_TEST_CASE(zerocoin_fixed_base_exp)
+{
+    const libzerocoin::Params &params = *ZerocoinParams();
+
+    const libzerocoin::AccumulatorAndProofParams &acc = params.accumulatorParams;
+    CheckGroupTables(acc.accumulatorQRNCommitmentGroup, acc.accumulatorModulus);
+    CheckGroupTables(acc.accumulatorPoKCommitmentGroup, acc.accumulatorPoKCommitmentGroup.modulus);
+    CheckGroupTables(params.serialNumberSoKCommitmentGroup, params.serialNumberSoKCommitmentGroup.modulus);
+    CheckGroupTables(params.coinCommitmentGroup, params.coinCommitmentGroup.modulus);
+
+    // The coin group tables also serve the serial number proof, whose exponents are taken mod its order
+    const CBigNum &order = params.serialNumberSoKCommitmentGroup.groupOrder;
+    BOOST_CHECK(params.coinCommitmentGroup.powH(CBigNum(-12345), order) == params.coinCommitmentGroup.h.pow_mod(CBigNum(-12345), order));
+}
+
+BOOST_AUTO_TEST_CASE(zerocoin_multi_pow_mod)
+{
+    // Fixed vectors: 3^5 * 7^-2 * 11^0 mod 101 = 243 * 33 mod 101 = 40, an even modulus and no bases at all
+    BOOST_CHECK(CBigNum::multi_pow_mod({CBigNum(3), CBigNum(7), CBigNum(11)}, {CBigNum(5), CBigNum(-2), CBigNum(0)}, CBigNum(101)) == CBigNum(40));
+    BOOST_CHECK(CBigNum::multi_pow_mod({CBigNum(3), CBigNum(5)}, {CBigNum(4), CBigNum(3)}, CBigNum(1000)) == CBigNum(125));
+    BOOST_CHECK(CBigNum::multi_pow_mod(std::vector<CBigNum>(), std::vector<CBigNum>(), CBigNum(101)) == CBigNum(1));
+
+    const libzerocoin::Params &params = *ZerocoinParams();
+    const CBigNum &N = params.accumulatorParams.accumulatorModulus;
+    const CBigNum &p = params.coinCommitmentGroup.modulus;
+
+    // Random products of up to four powers against separate pow_mod calls
+    for (uint32_t i = 0; i < 20; i++) {
+        const CBigNum &m = (i % 2) ? N : p;
+        std::vector<CBigNum> bases, exponents;
+        CBigNum expected = 1;
+        for (uint32_t j = 0; j <= i % 4; j++) {
+            CBigNum base = CBigNum::randBignum(m * m);
+            CBigNum e = CBigNum::randBignum(CBigNum(2).pow((i + j) * 97 % 2600 + 1));
+            if ((i + j) % 3 == 0)
+                e = 0 - e;
+            bases.push_back(base);
+            exponents.push_back(e);
+            expected = expected.mul_mod(base.pow_mod(e, m), m);
+        }
+        BOOST_CHECK(CBigNum::multi_pow_mod(bases, exponents, m) == expected);
+    }
+
+    // Generators through the tables and the remaining bases through multi_pow_mod
+    const libzerocoin::IntegerGroupParams &qrn = params.accumulatorParams.accumulatorQRNCommitmentGroup;
+    CBigNum x = CBigNum::randBignum(N), ex = CBigNum::randBignum(N), eg = CBigNum::randBignum(N), eh = CBigNum::randBignum(N);
+    BOOST_CHECK(qrn.multiPow(eg, 0 - eh, {x}, {ex}, N) ==
+                qrn.g.pow_mod(eg, N).mul_mod(qrn.h.pow_mod(0 - eh, N), N).mul_mod(x.pow_mod(ex, N), N));
+}
+
+BOOST_AUTO_TEST_CASE(zerocoin_params_transcript)
+{
+    const libzerocoin::Params &params = *ZerocoinParams();
+
+    // The precomputed midstates must hash exactly like serializing the parameters
+    CHashWriter fullParams(0, 0), fullAcc(0, 0);
+    fullParams << params << CBigNum(42);
+    fullAcc << params.accumulatorParams << CBigNum(42);
+
+    BOOST_REQUIRE(params.transcript && params.accumulatorParams.transcript);
+    CHashWriter paramsTranscript = params.getTranscript();
+    CHashWriter accTranscript = params.accumulatorParams.getTranscript();
+    paramsTranscript << CBigNum(42);
+    accTranscript << CBigNum(42);
+    BOOST_CHECK(paramsTranscript.GetHash() == fullParams.GetHash());
+    BOOST_CHECK(accTranscript.GetHash() == fullAcc.GetHash());
+}
+
+BOOST_AUTO_TEST_CASE(zerocoin_serial_proof_size)
+{
+    const libzerocoin::Params &params = *ZerocoinParams();
+
+    libzerocoin::PrivateCoin coin(&params, libzerocoin::ZQ_LOVELACE);
+    libzerocoin::Commitment commitment(&params.serialNumberSoKCommitmentGroup, coin.getPublicCoin().getValue());
+    uint256 msghash = GetRandHash();
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << libzerocoin::SerialNumberSignatureOfKnowledge(&params, coin, commitment, msghash);
+    std::vector<CBigNum> vS, vSPrime;
+    ss >> vS >> vSPrime;
+    std::vector<char> vHash(ss.begin(), ss.end());
+
+    // Responses past the last iteration have always been accepted and ignored, missing ones are rejected
+    for (int nExtra = -1; nExtra <= 1; nExtra++) {
+        std::vector<CBigNum> vSResized = vS, vSPrimeResized = vSPrime;
+        vSResized.resize(vS.size() + nExtra, CBigNum(1));
+        vSPrimeResized.resize(vSPrime.size() + nExtra, CBigNum(1));
+        CDataStream ssResized(SER_NETWORK, PROTOCOL_VERSION);
+        ssResized << vSResized << vSPrimeResized;
+        ssResized.write(vHash.data(), vHash.size());
+        libzerocoin::SerialNumberSignatureOfKnowledge proof(&params);
+        ssResized >> proof;
+        BOOST_CHECK_EQUAL(proof.HasValidSize(), nExtra >= 0);
+        BOOST_CHECK_EQUAL(proof.Verify(coin.getSerialNumber(), commitment.getCommitmentValue(), msghash), nExtra >= 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(zerocoin_pubcoin_validate)
+{
+    const libzerocoin::Params *params = ZerocoinParams();
+
+    // Remembering a coin as prime does not let anything else through
+    libzerocoin::PrivateCoin coin(params, libzerocoin::ZQ_LOVELACE);
+    const CBigNum &value = coin.getPublicCoin().getValue();
+    BOOST_CHECK(ZerocoinValidatePubCoin(coin.getPublicCoin()));
+    BOOST_CHECK(ZerocoinValidatePubCoin(coin.getPublicCoin()));
+    BOOST_CHECK(!ZerocoinValidatePubCoin(libzerocoin::PublicCoin(params, value + 1, libzerocoin::ZQ_LOVELACE)));
+    BOOST_CHECK(!ZerocoinValidatePubCoin(libzerocoin::PublicCoin(params, value * 3, libzerocoin::ZQ_LOVELACE)));
+    BOOST_CHECK(!ZerocoinValidatePubCoin(libzerocoin::PublicCoin(params, params->accumulatorParams.maxCoinValue + value, libzerocoin::ZQ_LOVELACE)));
+}
+
+BOOST_AUTO_TEST_CASE(zerocoin_thread_pool)
+{
+    libzerocoin::ParallelTasksStats before = libzerocoin::ParallelTasks::GetStats();
+
+    // Tasks waiting for tasks of their own must not block the pool
+    std::atomic<int> nDone(0);
+    libzerocoin::ParallelTasks outer;
+    for (int i = 0; i < 8; i++) {
+        outer.Add([&nDone] {
+            libzerocoin::ParallelTasks inner;
+            for (int j = 0; j < 8; j++)
+                inner.Add([&nDone] { nDone++; });
+            inner.Wait();
+        });
+    }
+    outer.Wait();
+    BOOST_CHECK_EQUAL(nDone, 64);
+
+    {
+        libzerocoin::ParallelTasks::HighPriority highPriority;
+        libzerocoin::ParallelTasks tasks;
+        for (int i = 0; i < 4; i++)
+            tasks.Add([&nDone] { nDone++; });
+        tasks.Wait();
+    }
+    BOOST_CHECK_EQUAL(nDone, 68);
+
+    // A waiter runs tasks of its own only, never the ones another caller queued
+    boost::thread::id waiter = boost::this_thread::get_id();
+    std::atomic<bool> fOtherRunByWaiter(false);
+    libzerocoin::ParallelTasks others;
+    for (int i = 0; i < 64; i++) {
+        others.Add([&fOtherRunByWaiter, waiter] {
+            if (boost::this_thread::get_id() == waiter)
+                fOtherRunByWaiter = true;
+            MilliSleep(1);
+        });
+    }
+    libzerocoin::ParallelTasks own;
+    own.Add([&nDone] { nDone++; });
+    own.Wait();
+    BOOST_CHECK(!fOtherRunByWaiter);
+    others.Wait();
+    BOOST_CHECK_EQUAL(nDone, 69);
+
+    // Exceptions reach the waiting thread
+    libzerocoin::ParallelTasks failing;
+    failing.Add([] { throw std::runtime_error("failed"); });
+    BOOST_CHECK_THROW(failing.Wait(), std::runtime_error);
+
+    libzerocoin::ParallelTasksStats after = libzerocoin::ParallelTasks::GetStats();
+    BOOST_CHECK(after.nThreads > 0);
+    BOOST_CHECK_EQUAL(after.nHighPriorityTasks - before.nHighPriorityTasks, 4);
+    BOOST_CHECK_EQUAL(after.nTasks - before.nTasks, 138);
+    BOOST_CHECK_EQUAL(after.nQueued, 0);
+    BOOST_CHECK_EQUAL(after.nHighPriorityQueued, 0);
+    BOOST_CHECK(libzerocoin::ParallelTasks::SetThreadCount(1) == false);
+}
+
+BOOST_AUTO_TEST_CASE(zerocoin_mint_order)
+{
+    // Mints are ordered by denomination and then by serialized value, not by numeric value
+    CZerocoinTxInfo zerocoinTxInfo;
+    for (int i = 0; i < 50; i++)
+        zerocoinTxInfo.mints.push_back(std::make_pair(i % 2 ? 1 : 10, CBigNum::randBignum(CBigNum(2).pow(8 * (1 + i % 40)))));
+    zerocoinTxInfo.Complete();
+    BOOST_CHECK(zerocoinTxInfo.fInfoIsComplete);
+    BOOST_CHECK(std::is_sorted(zerocoinTxInfo.mints.begin(), zerocoinTxInfo.mints.end(),
+        [](const std::pair<int,CBigNum> &m1, const std::pair<int,CBigNum> &m2) {
+            CDataStream ds1(SER_DISK, CLIENT_VERSION), ds2(SER_DISK, CLIENT_VERSION);
+            ds1 << m1.second;
+            ds2 << m2.second;
+            return (m1.first < m2.first) || ((m1.first == m2.first) && (ds1.str() < ds2.str()));
+        }));
+
+    CZerocoinState::CBigNumHasher hasher;
+    BOOST_CHECK(hasher(CBigNum(12345)) == hasher(CBigNum(12345)));
+    BOOST_CHECK(hasher(CBigNum(12345)) != hasher(CBigNum(-12345)));
+}
+
+BOOST_AUTO_TEST_CASE(zerocoin_block_info)
+{
+    CZerocoinBlockInfo info;
+    info.mintedPubCoins[std::make_pair(10, 2)].push_back(CBigNum(12345));
+    info.accumulatorChanges[std::make_pair(10, 2)] = std::make_pair(CBigNum(67890), 1);
+    info.spentSerials.insert(CBigNum(42));
+
+    CBlockIndex *genesis = chainActive.Genesis();
+    CBlockIndex *block = AddTestBlock(genesis, 1);
+    CBlockIndex *emptyBlock = AddTestBlock(block, 2);
+    ZerocoinSetBlockInfo(block, info);
+    ZerocoinSetBlockInfo(emptyBlock, CZerocoinBlockInfo());
+    BOOST_CHECK(block->nStatus & BLOCK_HAVE_ZEROCOIN);
+    BOOST_CHECK(!(emptyBlock->nStatus & BLOCK_HAVE_ZEROCOIN));
+    BOOST_CHECK(ZerocoinGetBlockInfo(emptyBlock)->IsNull());
+
+    // Write the payload the way FlushStateToDisk does and read it back from the database
+    std::vector<std::pair<CBlockIndex*, std::shared_ptr<const CZerocoinBlockInfo> > > vZerocoinInfo;
+    ZerocoinTakeDirtyBlockInfo(vZerocoinInfo);
+    BOOST_CHECK_EQUAL(vZerocoinInfo.size(), 1U);
+    BOOST_CHECK(pblocktree->WriteBatchSync(std::vector<std::pair<int, const CBlockFileInfo*> >(), 0,
+                                           std::vector<const CBlockIndex*>(1, block), vZerocoinInfo,
+                                           std::vector<std::pair<uint256, CCoinbasePayees> >(), -1));
+    ZerocoinUnloadBlockInfo();
+
+    std::shared_ptr<const CZerocoinBlockInfo> read = ZerocoinGetBlockInfo(block);
+    BOOST_CHECK(read->mintedPubCoins == info.mintedPubCoins);
+    BOOST_CHECK(read->accumulatorChanges == info.accumulatorChanges);
+    BOOST_CHECK(read->spentSerials == info.spentSerials);
+
+    // Block index entries of older versions carry the payload inline
+    CDataStream ss(SER_DISK, ZC_ADVANCED_INDEX_VERSION);
+    CDiskBlockIndex legacy(block);
+    legacy.zerocoinInfo = info;
+    ss << legacy;
+    CDiskBlockIndex legacyRead;
+    ss >> legacyRead;
+    BOOST_CHECK(ss.empty());
+    BOOST_CHECK(legacyRead.zerocoinInfo.mintedPubCoins == info.mintedPubCoins);
+    BOOST_CHECK(legacyRead.zerocoinInfo.spentSerials == info.spentSerials);
+
+    // The current version doesn't
+    CDataStream ssCurrent(SER_DISK, CLIENT_VERSION);
+    ssCurrent << legacy;
+    CDiskBlockIndex currentRead;
+    ssCurrent >> currentRead;
+    BOOST_CHECK(ssCurrent.empty());
+    BOOST_CHECK(currentRead.zerocoinInfo.IsNull());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
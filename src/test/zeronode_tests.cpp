@@ -0,0 +1,111 @@
+// Copyright (c) 2016-2017 The Zerobitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "key.h"
+#include "random.h"
+#include "utiltime.h"
+#include "zeronode.h"
+#include "zeronodeman.h"
+
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(zeronode_tests, TestingSetup)
+
+// Zeronode with a random collateral that isn't in the UTXO set
+static CZeronode TestZeronode()
+{
+    CKey key;
+    key.MakeNewKey(true);
+    return CZeronode(CService("1.2.3.4", 8168), CTxIn(COutPoint(GetRandHash(), 0)), key.GetPubKey(), key.GetPubKey(), PROTOCOL_VERSION);
+}
+
+// Block with a coinbase and a transaction spending the given outpoint
+static CBlock TestSpendBlock(const COutPoint& outpoint)
+{
+    CBlock block;
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].prevout.SetNull();
+    coinbase.vout.resize(1);
+    block.vtx.push_back(coinbase);
+    CMutableTransaction spend;
+    spend.vin.push_back(CTxIn(outpoint));
+    spend.vout.resize(1);
+    block.vtx.push_back(spend);
+    return block;
+}
+
+BOOST_AUTO_TEST_CASE(zeronode_check_schedule)
+{
+    SetMockTime(1500000000);
+    mnodeman.Clear();
+
+    CZeronode mn = TestZeronode();
+    const COutPoint outpoint = mn.vin.prevout;
+    BOOST_CHECK(mnodeman.Add(mn));
+    BOOST_CHECK(!mnodeman.Add(mn));
+
+    // a new entry is checked on the next Check()
+    BOOST_CHECK_EQUAL(mnodeman.GetScheduledCheckTime(outpoint), GetTime());
+
+    // without a ping or a watchdog vote nothing can change by itself
+    mnodeman.Check();
+    BOOST_CHECK_EQUAL(mnodeman.GetScheduledCheckTime(outpoint), 0);
+
+    // a ping brings back its deadlines once the node is rescheduled
+    CZeronode* pmn = mnodeman.Find(mn.vin);
+    BOOST_REQUIRE(pmn);
+    pmn->lastPing.vin = mn.vin;
+    pmn->lastPing.sigTime = GetTime();
+    mnodeman.ScheduleCheck(outpoint);
+    BOOST_CHECK_EQUAL(mnodeman.GetScheduledCheckTime(outpoint), GetTime());
+    mnodeman.Check();
+    BOOST_CHECK_EQUAL(mnodeman.GetScheduledCheckTime(outpoint), GetTime() + ZERONODE_MIN_MNP_SECONDS);
+
+    // Check() does nothing before the deadline and moves on to the next one after it
+    SetMockTime(GetTime() + ZERONODE_MIN_MNP_SECONDS - 1);
+    mnodeman.Check();
+    BOOST_CHECK_EQUAL(mnodeman.GetScheduledCheckTime(outpoint), pmn->lastPing.sigTime + ZERONODE_MIN_MNP_SECONDS);
+    SetMockTime(GetTime() + 1);
+    mnodeman.Check();
+    BOOST_CHECK_EQUAL(mnodeman.GetScheduledCheckTime(outpoint), pmn->lastPing.sigTime + ZERONODE_EXPIRATION_SECONDS);
+
+    // copies and unknown outpoints are not scheduled
+    COutPoint unknown(GetRandHash(), 0);
+    mnodeman.ScheduleCheck(unknown);
+    BOOST_CHECK_EQUAL(mnodeman.GetScheduledCheckTime(unknown), 0);
+
+    // removed entries are unscheduled
+    mnodeman.Clear();
+    BOOST_CHECK_EQUAL(mnodeman.GetScheduledCheckTime(outpoint), 0);
+    SetMockTime(0);
+}
+
+BOOST_AUTO_TEST_CASE(zeronode_collateral_check)
+{
+    mnodeman.Clear();
+
+    CZeronode mn = TestZeronode();
+    const COutPoint outpoint = mn.vin.prevout;
+    BOOST_CHECK(mnodeman.Add(mn));
+    mnodeman.Check();
+    BOOST_CHECK(!mnodeman.Find(mn.vin)->IsOutpointSpent());
+
+    // blocks not spending the collateral are ignored
+    mnodeman.BlockConnected(TestSpendBlock(COutPoint(GetRandHash(), 0)));
+    BOOST_CHECK(!mnodeman.IsCollateralCheckPending(outpoint));
+
+    // a spending block has the collateral looked up on the next Check(), where it is missing from the UTXO set
+    mnodeman.BlockConnected(TestSpendBlock(outpoint));
+    BOOST_CHECK(mnodeman.IsCollateralCheckPending(outpoint));
+    mnodeman.Check();
+    BOOST_CHECK(!mnodeman.IsCollateralCheckPending(outpoint));
+    BOOST_CHECK(mnodeman.Find(mn.vin)->IsOutpointSpent());
+
+    mnodeman.Clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -9,6 +9,7 @@
 #include "hash.h"
 #include "pow.h"
 #include "uint256.h"
+#include "zeronode-payments.h"
 
 #include <stdint.h>
 
@@ -20,6 +21,9 @@ static const char DB_COINS = 'c';
 static const char DB_BLOCK_FILES = 'f';
 static const char DB_TXINDEX = 't';
 static const char DB_BLOCK_INDEX = 'b';
+static const char DB_ZEROCOIN_INFO = 'z';
+static const char DB_COINBASE_PAYEES = 'p';
+static const char DB_COINBASE_PAYEES_PRUNED = 'P';
 
 static const char DB_BEST_BLOCK = 'B';
 static const char DB_FLAG = 'F';
@@ -136,7 +140,9 @@ void CCoinsViewDBCursor::Next()
         keyTmp.first = 0; // Invalidate cached key after last record so that Valid() and GetKey() return false
 }
 
-bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo) {
+bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo,
+                                  const std::vector<std::pair<CBlockIndex*, std::shared_ptr<const CZerocoinBlockInfo> > >& zerocoinInfo,
+                                  const std::vector<std::pair<uint256, CCoinbasePayees> >& coinbasePayees, int nCoinbasePayeesPruned) {
     CDBBatch batch(*this);
     for (std::vector<std::pair<int, const CBlockFileInfo*> >::const_iterator it=fileInfo.begin(); it != fileInfo.end(); it++) {
         batch.Write(make_pair(DB_BLOCK_FILES, it->first), *it->second);
@@ -145,9 +151,35 @@ bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockF
     for (std::vector<const CBlockIndex*>::const_iterator it=blockinfo.begin(); it != blockinfo.end(); it++) {
         batch.Write(make_pair(DB_BLOCK_INDEX, (*it)->GetBlockHash()), CDiskBlockIndex(*it));
     }
+    for (std::vector<std::pair<CBlockIndex*, std::shared_ptr<const CZerocoinBlockInfo> > >::const_iterator it=zerocoinInfo.begin(); it != zerocoinInfo.end(); it++) {
+        if (it->second->IsNull())
+            batch.Erase(make_pair(DB_ZEROCOIN_INFO, it->first->GetBlockHash()));
+        else
+            batch.Write(make_pair(DB_ZEROCOIN_INFO, it->first->GetBlockHash()), *it->second);
+    }
+    for (std::vector<std::pair<uint256, CCoinbasePayees> >::const_iterator it=coinbasePayees.begin(); it != coinbasePayees.end(); it++) {
+        if (it->second.hashBlock.IsNull())
+            batch.Erase(make_pair(DB_COINBASE_PAYEES, it->first));
+        else
+            batch.Write(make_pair(DB_COINBASE_PAYEES, it->first), it->second);
+    }
+    if (nCoinbasePayeesPruned >= 0)
+        batch.Write(DB_COINBASE_PAYEES_PRUNED, nCoinbasePayeesPruned);
     return WriteBatch(batch, true);
 }
 
+bool CBlockTreeDB::ReadZerocoinBlockInfo(const uint256 &hash, CZerocoinBlockInfo &info) {
+    return Read(make_pair(DB_ZEROCOIN_INFO, hash), info);
+}
+
+bool CBlockTreeDB::ReadCoinbasePayees(const uint256 &hash, CCoinbasePayees &payees) {
+    return Read(make_pair(DB_COINBASE_PAYEES, hash), payees);
+}
+
+bool CBlockTreeDB::ReadCoinbasePayeesPruned(int &nHeight) {
+    return Read(DB_COINBASE_PAYEES_PRUNED, nHeight);
+}
+
 bool CBlockTreeDB::ReadTxIndex(const uint256 &txid, CDiskTxPos &pos) {
     return Read(make_pair(DB_TXINDEX, txid), pos);
 }
@@ -178,6 +210,11 @@ bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256
 
     pcursor->Seek(make_pair(DB_BLOCK_INDEX, uint256()));
 
+    // Entries written before ZC_BLOCK_INFO_INDEX_VERSION carry their zerocoin payload inline,
+    // these are moved to DB_ZEROCOIN_INFO records and rewritten in the current format
+    CDBBatch batchUpgrade(*this);
+    int nZerocoinUpgraded = 0;
+
     // Load mapBlockIndex
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
@@ -199,12 +236,19 @@ bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256
                 pindexNew->nNonce         = diskindex.nNonce;
                 pindexNew->nStatus        = diskindex.nStatus;
                 pindexNew->nTx            = diskindex.nTx;
-
-                pindexNew->accumulatorChanges = diskindex.accumulatorChanges;
-                pindexNew->mintedPubCoins     = diskindex.mintedPubCoins;
-                pindexNew->spentSerials       = diskindex.spentSerials;
-
-                if (!CheckProofOfWork(pindexNew->GetBlockPoWHash(), pindexNew->nBits, Params().GetConsensus()))
+                pindexNew->hashPoW        = diskindex.hashPoW;
+
+                if (!diskindex.zerocoinInfo.IsNull()) {
+                    pindexNew->nStatus |= BLOCK_HAVE_ZEROCOIN;
+                    batchUpgrade.Write(make_pair(DB_ZEROCOIN_INFO, pindexNew->GetBlockHash()), diskindex.zerocoinInfo);
+                    batchUpgrade.Write(make_pair(DB_BLOCK_INDEX, pindexNew->GetBlockHash()), CDiskBlockIndex(pindexNew));
+                    nZerocoinUpgraded++;
+                }
+
+                // Only the cheap target comparison is done here. Entries written before
+                // POW_HASH_INDEX_VERSION have no stored hash and are hashed by LoadBlockIndexDB.
+                if (!pindexNew->hashPoW.IsNull() &&
+                        !CheckProofOfWork(pindexNew->hashPoW, pindexNew->nBits, Params().GetConsensus()))
                     return error("LoadBlockIndex(): CheckProofOfWork failed: %s", pindexNew->ToString());
 
                 pcursor->Next();
@@ -216,6 +260,12 @@ bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256
         }
     }
 
+    if (nZerocoinUpgraded > 0) {
+        LogPrintf("LoadBlockIndex(): moving zerocoin data of %d block index entries\n", nZerocoinUpgraded);
+        if (!WriteBatch(batchUpgrade, true))
+            return error("LoadBlockIndex() : failed to write zerocoin data");
+    }
+
     return true;
 }
 
@@ -11,6 +11,7 @@
 #include "chain.h"
 
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -18,6 +19,7 @@
 #include <boost/function.hpp>
 
 class CBlockIndex;
+class CCoinbasePayees;
 class CCoinsViewDBCursor;
 class uint256;
 
@@ -107,7 +109,12 @@ private:
     CBlockTreeDB(const CBlockTreeDB&);
     void operator=(const CBlockTreeDB&);
 public:
-    bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo);
+    bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo,
+                        const std::vector<std::pair<CBlockIndex*, std::shared_ptr<const CZerocoinBlockInfo> > >& zerocoinInfo,
+                        const std::vector<std::pair<uint256, CCoinbasePayees> >& coinbasePayees, int nCoinbasePayeesPruned);
+    bool ReadZerocoinBlockInfo(const uint256 &hash, CZerocoinBlockInfo &info);
+    bool ReadCoinbasePayees(const uint256 &hash, CCoinbasePayees &payees);
+    bool ReadCoinbasePayeesPruned(int &nHeight);
     bool ReadBlockFileInfo(int nFile, CBlockFileInfo &fileinfo);
     bool ReadLastBlockFile(int &nFile);
     bool WriteReindexing(bool fReindex);
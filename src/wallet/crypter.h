@@ -182,6 +182,9 @@ public:
         return false;
     }
     bool GetKey(const CKeyID &address, CKey& keyOut) const;
+    //! encrypt or decrypt a secret other than a key with the master key, nIV must be unique to the secret
+    bool EncryptSecretWithMasterKey(const CKeyingMaterial& vchPlaintext, const uint256& nIV, std::vector<unsigned char> &vchCiphertext) const;
+    bool DecryptSecretWithMasterKey(const std::vector<unsigned char>& vchCiphertext, const uint256& nIV, CKeyingMaterial& vchPlaintext) const;
     bool GetPubKey(const CKeyID &address, CPubKey& vchPubKeyOut) const;
     void GetKeys(std::set<CKeyID> &setAddress) const
     {
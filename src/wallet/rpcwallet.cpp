@@ -2673,58 +2673,57 @@ UniValue mintzerocoin(const UniValue& params, bool fHelp)
     LogPrintf("rpcWallet.mintzerocoin() denomination = %s, nAmount = %s \n", denomination, nAmount);
 
 
-    // zerocoin init
-    CBigNum bnTrustedModulus;
+    // Take a coin from the mint pool if there is one, it was validated when it was made
+    CZerocoinEntry zerocoinTx;
+    bool fFromPool = pwalletMain->TakeZerocoinFromMintPool(denomination, zerocoinTx);
+    if (!fFromPool) {
+        // The following constructor does all the work of minting a brand
+        // new zerocoin. It stores all the private values inside the
+        // PrivateCoin object. This includes the coin secrets, which must be
+        // stored in a secure location (wallet) at the client.
+        libzerocoin::PrivateCoin newCoin(ZerocoinParams(), denomination, ZEROCOIN_TX_VERSION_2);
+        // Get a copy of the 'public' portion of the coin. You should
+        // embed this into a Zerocoin 'MINT' transaction along with a series
+        // of currency inputs totaling the assigned value of one zerocoin.
+        libzerocoin::PublicCoin pubCoin = newCoin.getPublicCoin();
+
+        // Validate
+        if (!ZerocoinValidatePubCoin(pubCoin))
+            return "";
 
-    // Loads a trusted Zerocoin modulus "N"
-    bnTrustedModulus.SetHex(ZEROCOIN_MODULUS);
-
-    // Set up the Zerocoin Params object
-    libzerocoin::Params *ZCParams = new libzerocoin::Params(bnTrustedModulus);
-
-    // The following constructor does all the work of minting a brand
-    // new zerocoin. It stores all the private values inside the
-    // PrivateCoin object. This includes the coin secrets, which must be
-    // stored in a secure location (wallet) at the client.
-    libzerocoin::PrivateCoin newCoin(ZCParams, denomination, ZEROCOIN_TX_VERSION_2);
-    // Get a copy of the 'public' portion of the coin. You should
-    // embed this into a Zerocoin 'MINT' transaction along with a series
-    // of currency inputs totaling the assigned value of one zerocoin.
-    libzerocoin::PublicCoin pubCoin = newCoin.getPublicCoin();
+        zerocoinTx.denomination = denomination;
+        zerocoinTx.value = pubCoin.getValue();
+        zerocoinTx.randomness = newCoin.getRandomness();
+        zerocoinTx.serialNumber = newCoin.getSerialNumber();
+    }
 
-    // Validate
-    if (pubCoin.validate()) {
-        CScript scriptSerializedCoin =
-                CScript() << OP_ZEROCOINMINT << pubCoin.getValue().getvch().size() << pubCoin.getValue().getvch();
+    CScript scriptSerializedCoin =
+            CScript() << OP_ZEROCOINMINT << zerocoinTx.value.getvch().size() << zerocoinTx.value.getvch();
 
-        if (pwalletMain->IsLocked())
-            throw JSONRPCError(RPC_WALLET_UNLOCK_NEEDED, "Error: Please enter the wallet passphrase with walletpassphrase first.");
+    if (pwalletMain->IsLocked()) {
+        if (fFromPool)
+            pwalletMain->ReturnZerocoinToMintPool(denomination, zerocoinTx.value);
+        throw JSONRPCError(RPC_WALLET_UNLOCK_NEEDED, "Error: Please enter the wallet passphrase with walletpassphrase first.");
+    }
 
-        // Wallet comments
-        CWalletTx wtx;
+    // Wallet comments
+    CWalletTx wtx;
 
-        string strError = pwalletMain->MintZerocoin(scriptSerializedCoin, nAmount, wtx);
+    string strError = pwalletMain->MintZerocoin(scriptSerializedCoin, nAmount, wtx);
 
-        if (strError != "")
-            throw JSONRPCError(RPC_WALLET_ERROR, strError);
+    if (strError != "") {
+        if (fFromPool)
+            pwalletMain->ReturnZerocoinToMintPool(denomination, zerocoinTx.value);
+        throw JSONRPCError(RPC_WALLET_ERROR, strError);
+    }
 
-        CWalletDB walletdb(pwalletMain->strWalletFile);
-        CZerocoinEntry zerocoinTx;
-        zerocoinTx.IsUsed = false;
-        zerocoinTx.denomination = denomination;
-        zerocoinTx.value = pubCoin.getValue();
-        libzerocoin::PublicCoin checkPubCoin(ZCParams, zerocoinTx.value, denomination);
-        if (!checkPubCoin.validate()) {
-            return false;
-        }
-        zerocoinTx.randomness = newCoin.getRandomness();
-        zerocoinTx.serialNumber = newCoin.getSerialNumber();
-        walletdb.WriteZerocoinEntry(zerocoinTx);
+    CWalletDB walletdb(pwalletMain->strWalletFile);
+    zerocoinTx.IsUsed = false;
+    if (walletdb.WriteZerocoinEntry(zerocoinTx) && fFromPool)
+        pwalletMain->KeepZerocoinFromMintPool(zerocoinTx.value);
+    pwalletMain->UpdateUnspentZerocoinMint(zerocoinTx);
 
-        return pubCoin.getValue().GetHex();
-    } else {
-        return "";
-    }
+    return zerocoinTx.value.GetHex();
 
 }
 
@@ -2801,6 +2800,7 @@ UniValue resetmintzerocoin(const UniValue& params, bool fHelp) {
             zerocoinTx.nHeight = -1;
             zerocoinTx.randomness = zerocoinItem.randomness;
             walletdb.WriteZerocoinEntry(zerocoinTx);
+            pwalletMain->UpdateUnspentZerocoinMint(zerocoinTx);
         }
     }
 
@@ -2917,6 +2917,7 @@ UniValue setmintzerocoinstatus(const UniValue& params, bool fHelp) {
                 zerocoinTx.randomness = zerocoinItem.randomness;
                 pwalletMain->NotifyZerocoinChanged(pwalletMain, zerocoinTx.value.GetHex(), zerocoinTx.IsUsed ? "Used" : "New", CT_UPDATED);
                 walletdb.WriteZerocoinEntry(zerocoinTx);
+                pwalletMain->UpdateUnspentZerocoinMint(zerocoinTx);
 
                 UniValue entry(UniValue::VOBJ);
                 entry.push_back(Pair("id", zerocoinTx.id));
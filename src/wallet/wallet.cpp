@@ -31,6 +31,7 @@
 #include "zeronode.h"
 #include "zeronode-sync.h"
 #include "random.h"
+#include "libzerocoin/ParallelTasks.h"
 
 #include <assert.h>
 #include <boost/algorithm/string/replace.hpp>
@@ -644,6 +645,8 @@ bool CWallet::EncryptWallet(const SecureString &strWalletPassphrase) {
         }
 
         NewKeyPool();
+        // coins of the mint pool were written in the clear
+        NewZerocoinMintPool();
         Lock();
 
         // Need to completely rewrite the wallet file; if we don't, bdb might keep
@@ -1046,6 +1049,107 @@ void CWallet::SyncTransaction(const CTransaction &tx, const CBlockIndex *pindex,
     }
 }
 
+void CWallet::UpdateUnspentZerocoinMint(const CZerocoinEntry &zerocoinEntry) {
+    LOCK(cs_wallet);
+    if (zerocoinEntry.IsUsed || zerocoinEntry.randomness == 0 || zerocoinEntry.serialNumber == 0)
+        mapUnspentZerocoinMints.erase(zerocoinEntry.value);
+    else
+        mapUnspentZerocoinMints[zerocoinEntry.value] = zerocoinEntry;
+}
+
+void CWallet::UpdatedBlockTip(const CBlockIndex *pindex) {
+    // Witnesses follow the accumulator value a spend would use, disconnected blocks make them start
+    // over from the mint. Only finding the coins to add needs cs_main, they are added without any lock held
+    int maxHeight = pindex->nHeight - (ZC_MINT_CONFIRMATIONS - 1);
+    CZerocoinState *zerocoinState = CZerocoinState::GetZerocoinState();
+
+    // public coin, block of the cached witness the update starts from and the update
+    typedef std::pair<CBigNum, std::pair<uint256, CZerocoinState::CWitnessUpdate> > WitnessUpdate;
+    vector<WitnessUpdate> vUpdates;
+    set<CBigNum> setUnspentMints;
+    {
+        LOCK2(cs_main, cs_wallet);
+        BOOST_FOREACH(const PAIRTYPE(CBigNum, CZerocoinEntry) &item, mapUnspentZerocoinMints) {
+            const CZerocoinEntry &zerocoinItem = item.second;
+            int id;
+            int coinHeight = zerocoinState->GetMintedCoinHeightAndId(zerocoinItem.value, zerocoinItem.denomination, id);
+            if (coinHeight <= 0 || coinHeight > maxHeight)
+                continue;
+
+            CZerocoinWitnessEntry &cachedWitness = mapZerocoinWitnesses[zerocoinItem.value];
+            if (cachedWitness.denomination != zerocoinItem.denomination || cachedWitness.id != id) {
+                cachedWitness.SetNull();
+                cachedWitness.denomination = zerocoinItem.denomination;
+                cachedWitness.id = id;
+            }
+
+            CZerocoinState::CWitnessUpdate update;
+            if (!zerocoinState->PrepareWitnessUpdate(maxHeight, zerocoinItem.denomination, id, zerocoinItem.value,
+                                                     cachedWitness.value, cachedWitness.hashBlock, update))
+                continue;
+            setUnspentMints.insert(zerocoinItem.value);
+            if (update.pubCoins.empty() && update.blockHash == cachedWitness.hashBlock)
+                continue;
+            vUpdates.push_back(make_pair(zerocoinItem.value, make_pair(cachedWitness.hashBlock, update)));
+        }
+    }
+
+    vector<CBigNum> vWitnessValues;
+    vWitnessValues.reserve(vUpdates.size());
+    BOOST_FOREACH(const WitnessUpdate &witnessUpdate, vUpdates)
+        vWitnessValues.push_back(CZerocoinState::ApplyWitnessUpdate(witnessUpdate.second.second));
+
+    LOCK(cs_wallet);
+    CWalletDB walletdb(strWalletFile);
+    for (size_t i = 0; i < vUpdates.size(); i++) {
+        const CBigNum &pubCoin = vUpdates[i].first;
+        map<CBigNum, CZerocoinWitnessEntry>::iterator it = mapZerocoinWitnesses.find(pubCoin);
+        // a spend may have advanced the witness in the meantime
+        if (it == mapZerocoinWitnesses.end() || it->second.hashBlock != vUpdates[i].second.first)
+            continue;
+        it->second.value = vWitnessValues[i];
+        it->second.hashBlock = vUpdates[i].second.second.blockHash;
+        if (!walletdb.WriteZerocoinWitness(pubCoin, it->second))
+            LogPrintf("UpdatedBlockTip(): failed to write witness of %s\n", pubCoin.GetHex());
+    }
+
+    // forget witnesses of spent coins
+    for (map<CBigNum, CZerocoinWitnessEntry>::iterator it = mapZerocoinWitnesses.begin(); it != mapZerocoinWitnesses.end(); ) {
+        if (setUnspentMints.count(it->first) == 0) {
+            walletdb.EraseZerocoinWitness(it->first);
+            mapZerocoinWitnesses.erase(it++);
+        }
+        else
+            ++it;
+    }
+}
+
+bool CWallet::UpdateZerocoinWitness(CWalletDB &walletdb, const CZerocoinEntry &zerocoinEntry, int id, int maxHeight, CZerocoinWitnessEntry &witness) {
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    CZerocoinWitnessEntry &cachedWitness = mapZerocoinWitnesses[zerocoinEntry.value];
+    if (cachedWitness.denomination != zerocoinEntry.denomination || cachedWitness.id != id) {
+        cachedWitness.SetNull();
+        cachedWitness.denomination = zerocoinEntry.denomination;
+        cachedWitness.id = id;
+    }
+
+    uint256 hashBlock = cachedWitness.hashBlock;
+    CZerocoinState *zerocoinState = CZerocoinState::GetZerocoinState();
+    if (!zerocoinState->AdvanceWitness(maxHeight, zerocoinEntry.denomination, id, zerocoinEntry.value,
+                                       cachedWitness.value, cachedWitness.hashBlock)) {
+        mapZerocoinWitnesses.erase(zerocoinEntry.value);
+        return false;
+    }
+
+    if (cachedWitness.hashBlock != hashBlock && !walletdb.WriteZerocoinWitness(zerocoinEntry.value, cachedWitness))
+        LogPrintf("UpdateZerocoinWitness(): failed to write witness of %s\n", zerocoinEntry.value.GetHex());
+
+    witness = cachedWitness;
+    return true;
+}
+
 
 isminetype CWallet::IsMine(const CTxIn &txin) const {
     {
@@ -3162,15 +3266,6 @@ bool CWallet::CreateZerocoinMintModel(string &stringError, string denomAmount) {
         return false;
     }
 
-    // zerocoin init
-    CBigNum bnTrustedModulus;
-
-    // Loads a trusted Zerocoin modulus "N"
-    bnTrustedModulus.SetHex(ZEROCOIN_MODULUS);
-
-    // Set up the Zerocoin Params object
-    libzerocoin::Params *ZCParams = new libzerocoin::Params(bnTrustedModulus);
-	
 	int mintVersion = ZEROCOIN_TX_VERSION_1;
 	
 	// do not use v2 mint until certain moment when it would be understood by peers
@@ -3182,49 +3277,60 @@ bool CWallet::CreateZerocoinMintModel(string &stringError, string denomAmount) {
 			mintVersion = ZEROCOIN_TX_VERSION_2;
 	}
 
-    // The following constructor does all the work of minting a brand
-    // new zerocoin. It stores all the private values inside the
-    // PrivateCoin object. This includes the coin secrets, which must be
-    // stored in a secure location (wallet) at the client.
-    libzerocoin::PrivateCoin newCoin(ZCParams, denomination, mintVersion);
-
-    // Get a copy of the 'public' portion of the coin. You should
-    // embed this into a Zerocoin 'MINT' transaction along with a series
-    // of currency inputs totaling the assigned value of one zerocoin.
-    libzerocoin::PublicCoin pubCoin = newCoin.getPublicCoin();
-
-    // Validate
-    if (pubCoin.validate()) {
-        //TODOS
-        CScript scriptSerializedCoin =
-                CScript() << OP_ZEROCOINMINT << pubCoin.getValue().getvch().size() << pubCoin.getValue().getvch();
-
-        // Wallet comments
-        CWalletTx wtx;
-
-        stringError = MintZerocoin(scriptSerializedCoin, nAmount, wtx);
-
-        if (stringError != "")
+    // Coins of the mint pool are v2 coins validated when they were made
+    CZerocoinEntry zerocoinTx;
+    bool fFromPool = mintVersion == ZEROCOIN_TX_VERSION_2 && TakeZerocoinFromMintPool(denomination, zerocoinTx);
+    if (!fFromPool) {
+        // The following constructor does all the work of minting a brand
+        // new zerocoin. It stores all the private values inside the
+        // PrivateCoin object. This includes the coin secrets, which must be
+        // stored in a secure location (wallet) at the client.
+        libzerocoin::PrivateCoin newCoin(ZerocoinParams(), denomination, mintVersion);
+
+        // Get a copy of the 'public' portion of the coin. You should
+        // embed this into a Zerocoin 'MINT' transaction along with a series
+        // of currency inputs totaling the assigned value of one zerocoin.
+        libzerocoin::PublicCoin pubCoin = newCoin.getPublicCoin();
+
+        // Validate
+        if (!ZerocoinValidatePubCoin(pubCoin))
             return false;
 
         const unsigned char *ecdsaSecretKey = newCoin.getEcdsaSeckey();
-        CZerocoinEntry zerocoinTx;
-        zerocoinTx.IsUsed = false;
         zerocoinTx.denomination = denomination;
         zerocoinTx.value = pubCoin.getValue();
         zerocoinTx.randomness = newCoin.getRandomness();
         zerocoinTx.serialNumber = newCoin.getSerialNumber();
         zerocoinTx.ecdsaSecretKey = std::vector<unsigned char>(ecdsaSecretKey, ecdsaSecretKey+32);
-        LogPrintf("CreateZerocoinMintModel() -> NotifyZerocoinChanged\n");
-        LogPrintf("pubcoin=%s, isUsed=%s\n", zerocoinTx.value.GetHex(), zerocoinTx.IsUsed);
-        LogPrintf("randomness=%s, serialNumber=%s\n", zerocoinTx.randomness, zerocoinTx.serialNumber);
-        NotifyZerocoinChanged(this, zerocoinTx.value.GetHex(), zerocoinTx.IsUsed ? "Used" : "New", CT_NEW);
-        if (!CWalletDB(strWalletFile).WriteZerocoinEntry(zerocoinTx))
-            return false;
-        return true;
-    } else {
+    }
+
+    //TODOS
+    CScript scriptSerializedCoin =
+            CScript() << OP_ZEROCOINMINT << zerocoinTx.value.getvch().size() << zerocoinTx.value.getvch();
+
+    // Wallet comments
+    CWalletTx wtx;
+
+    stringError = MintZerocoin(scriptSerializedCoin, nAmount, wtx);
+
+    if (stringError != "") {
+        if (fFromPool)
+            ReturnZerocoinToMintPool(denomination, zerocoinTx.value);
         return false;
     }
+
+    zerocoinTx.IsUsed = false;
+    LogPrintf("CreateZerocoinMintModel() -> NotifyZerocoinChanged\n");
+    LogPrintf("pubcoin=%s, isUsed=%s\n", zerocoinTx.value.GetHex(), zerocoinTx.IsUsed);
+    LogPrintf("randomness=%s, serialNumber=%s\n", zerocoinTx.randomness, zerocoinTx.serialNumber);
+    NotifyZerocoinChanged(this, zerocoinTx.value.GetHex(), zerocoinTx.IsUsed ? "Used" : "New", CT_NEW);
+    // the coin is minted: a pool coin keeps its pool record, which holds its secrets, unless the entry is written
+    if (!CWalletDB(strWalletFile).WriteZerocoinEntry(zerocoinTx))
+        return false;
+    if (fFromPool)
+        KeepZerocoinFromMintPool(zerocoinTx.value);
+    UpdateUnspentZerocoinMint(zerocoinTx);
+    return true;
 }
 
 bool CWallet::CreateZerocoinSpendModel(string &stringError, string denomAmount) {
@@ -3647,15 +3753,7 @@ bool CWallet::CreateZerocoinSpendTransaction(int64_t nValue, libzerocoin::CoinDe
             // Fill vin
 
             // Zerocoin
-            // zerocoin init
-            static CBigNum bnTrustedModulus;
-            bool setParams = bnTrustedModulus.SetHexBool(ZEROCOIN_MODULUS);
-            if (!setParams) {
-                LogPrintf("bnTrustedModulus.SetHexBool(ZEROCOIN_MODULUS) failed");
-            }
-
-            // Set up the Zerocoin Params object
-            static libzerocoin::Params *ZCParams = new libzerocoin::Params(bnTrustedModulus);
+            const libzerocoin::Params *ZCParams = ZerocoinParams();
 
             // Select not yet used coin from the wallet with minimal possible id
 
@@ -3700,12 +3798,16 @@ bool CWallet::CreateZerocoinSpendTransaction(int64_t nValue, libzerocoin::CoinDe
                 return false;
             }
 
+            // the loop above may have left the accumulator of another group
+            zerocoinState->GetAccumulatorValueForSpend(chainActive.Height()-(ZC_MINT_CONFIRMATIONS-1), denomination, coinId,
+                                                       accumulatorValue, accumulatorBlockHash);
+
             libzerocoin::Accumulator accumulator(ZCParams, accumulatorValue, denomination);
             // 2. Get pubcoin from the private coin
             libzerocoin::PublicCoin pubCoinSelected(ZCParams, coinToUse.value, denomination);
 
             // Now make sure the coin is valid.
-            if (!pubCoinSelected.validate()) {
+            if (!ZerocoinValidatePubCoin(pubCoinSelected)) {
                 // If this returns false, don't accept the coin for any purpose!
                 // Any ZEROCOIN_MINT with an invalid coin should NOT be
                 // accepted as a valid transaction in the block chain.
@@ -3713,12 +3815,17 @@ bool CWallet::CreateZerocoinSpendTransaction(int64_t nValue, libzerocoin::CoinDe
                 return false;
             }
 
-            // 4. Get witness from the index
-            libzerocoin::AccumulatorWitness witness =
-                    zerocoinState->GetWitnessForSpend(&chainActive,
-                                                      chainActive.Height()-(ZC_MINT_CONFIRMATIONS-1),
-                                                      denomination, coinId,
-                                                      coinToUse.value);
+            // 4. Get witness from the wallet, normally it is up to date already
+            CZerocoinWitnessEntry witnessEntry;
+            CWalletDB walletdb(strWalletFile);
+            if (!UpdateZerocoinWitness(walletdb, coinToUse, coinId, chainActive.Height()-(ZC_MINT_CONFIRMATIONS-1), witnessEntry)
+                    || witnessEntry.hashBlock != accumulatorBlockHash) {
+                strFailReason = _("failed to build the witness of the selected mint coin");
+                return false;
+            }
+            libzerocoin::AccumulatorWitness witness(ZCParams,
+                                                    libzerocoin::Accumulator(ZCParams, witnessEntry.value, denomination),
+                                                    pubCoinSelected);
 
             CTxIn newTxIn;
             newTxIn.nSequence = coinId;
@@ -3805,6 +3912,7 @@ bool CWallet::CreateZerocoinSpendTransaction(int64_t nValue, libzerocoin::CoinDe
                     pubCoinTx.serialNumber = coinToUse.serialNumber;
                     pubCoinTx.value = coinToUse.value;
                     CWalletDB(strWalletFile).WriteZerocoinEntry(pubCoinTx);
+                    UpdateUnspentZerocoinMint(pubCoinTx);
                     LogPrintf("CreateZerocoinSpendTransaction() -> NotifyZerocoinChanged\n");
                     LogPrintf("pubcoin=%s, isUsed=Used\n", coinToUse.value.GetHex());
                     pwalletMain->NotifyZerocoinChanged(pwalletMain, coinToUse.value.GetHex(), "Used",
@@ -3835,6 +3943,7 @@ bool CWallet::CreateZerocoinSpendTransaction(int64_t nValue, libzerocoin::CoinDe
             coinToUse.id = coinId;
             coinToUse.nHeight = coinHeight;
             CWalletDB(strWalletFile).WriteZerocoinEntry(coinToUse);
+            UpdateUnspentZerocoinMint(coinToUse);
             pwalletMain->NotifyZerocoinChanged(pwalletMain, coinToUse.value.GetHex(), "Used",
                                                CT_UPDATED);
         }
@@ -3998,6 +4107,7 @@ string CWallet::SpendZerocoin(int64_t nValue, libzerocoin::CoinDenomination deno
                 pubCoinTx.serialNumber = pubCoinItem.serialNumber;
                 pubCoinTx.denomination = pubCoinItem.denomination;
                 CWalletDB(strWalletFile).WriteZerocoinEntry(pubCoinTx);
+                UpdateUnspentZerocoinMint(pubCoinTx);
                 LogPrintf("SpendZerocoin failed, re-updated status -> NotifyZerocoinChanged\n");
                 LogPrintf("pubcoin=%s, isUsed=New\n", pubCoinItem.value.GetHex());
                 pwalletMain->NotifyZerocoinChanged(pwalletMain, pubCoinItem.value.GetHex(), "New", CT_UPDATED);
@@ -4227,6 +4337,170 @@ bool CWallet::TopUpKeyPool(unsigned int kpSize) {
     return true;
 }
 
+static const libzerocoin::CoinDenomination zerocoinMintPoolDenominations[] = {
+    libzerocoin::ZQ_LOVELACE, libzerocoin::ZQ_GOLDWASSER, libzerocoin::ZQ_RACKOFF, libzerocoin::ZQ_PEDERSEN, libzerocoin::ZQ_WILLIAMSON
+};
+
+static bool MakeZerocoinMintPoolEntry(const CCryptoKeyStore &keystore, const CZerocoinEntry &zerocoinEntry, CZerocoinMintPoolEntry &entry) {
+    CDataStream ssSecret(SER_DISK, CLIENT_VERSION);
+    ssSecret << zerocoinEntry.randomness << zerocoinEntry.serialNumber << zerocoinEntry.ecdsaSecretKey;
+    CKeyingMaterial vchSecret(ssSecret.begin(), ssSecret.end());
+
+    entry.denomination = zerocoinEntry.denomination;
+    entry.value = zerocoinEntry.value;
+    entry.fCrypted = keystore.IsCrypted();
+    if (!entry.fCrypted) {
+        entry.vchSecret.assign(vchSecret.begin(), vchSecret.end());
+        return true;
+    }
+
+    std::vector<unsigned char> vchValue = zerocoinEntry.value.getvch();
+    return keystore.EncryptSecretWithMasterKey(vchSecret, Hash(vchValue.begin(), vchValue.end()), entry.vchSecret);
+}
+
+static bool ReadZerocoinMintPoolEntry(const CCryptoKeyStore &keystore, const CZerocoinMintPoolEntry &entry, CZerocoinEntry &zerocoinEntry) {
+    CKeyingMaterial vchSecret;
+    if (!entry.fCrypted) {
+        vchSecret.assign(entry.vchSecret.begin(), entry.vchSecret.end());
+    }
+    else {
+        std::vector<unsigned char> vchValue = entry.value.getvch();
+        if (!keystore.DecryptSecretWithMasterKey(entry.vchSecret, Hash(vchValue.begin(), vchValue.end()), vchSecret))
+            return false;
+    }
+
+    zerocoinEntry.SetNull();
+    zerocoinEntry.denomination = entry.denomination;
+    zerocoinEntry.value = entry.value;
+    try {
+        CDataStream ssSecret((const char *)vchSecret.data(), (const char *)vchSecret.data() + vchSecret.size(), SER_DISK, CLIENT_VERSION);
+        ssSecret >> zerocoinEntry.randomness >> zerocoinEntry.serialNumber >> zerocoinEntry.ecdsaSecretKey;
+    } catch (const std::exception &) {
+        return false;
+    }
+    return zerocoinEntry.IsCorrectV2Mint();
+}
+
+bool CWallet::NewZerocoinMintPool() {
+    LOCK(cs_wallet);
+    CWalletDB walletdb(strWalletFile);
+    BOOST_FOREACH(const PAIRTYPE(int, set<CBigNum>) &pool, mapZerocoinMintPool) {
+        BOOST_FOREACH(const CBigNum &pubCoin, pool.second)
+            walletdb.EraseZerocoinMintPoolEntry(pubCoin);
+    }
+    mapZerocoinMintPool.clear();
+    return true;
+}
+
+bool CWallet::TopUpZerocoinMintPool(unsigned int nSize) {
+    unsigned int nTargetSize;
+    if (nSize > 0)
+        nTargetSize = nSize;
+    else
+        nTargetSize = max(GetArg("-zerocoinmintpool", DEFAULT_ZEROCOIN_MINT_POOL_SIZE), (int64_t) 0);
+
+    // Mint in batches of one coin per core, without holding cs_wallet: every coin takes a search for a prime
+    unsigned int nBatchSize = max(boost::thread::hardware_concurrency(), 1u);
+    for (;;) {
+        vector<CZerocoinEntry> vCoins;
+        {
+            LOCK(cs_wallet);
+            if (IsLocked())
+                return false;
+
+            BOOST_FOREACH(libzerocoin::CoinDenomination denomination, zerocoinMintPoolDenominations) {
+                for (size_t n = mapZerocoinMintPool[denomination].size(); n < nTargetSize && vCoins.size() < nBatchSize; n++) {
+                    vCoins.push_back(CZerocoinEntry());
+                    vCoins.back().denomination = denomination;
+                }
+            }
+        }
+        if (vCoins.empty())
+            return true;
+
+        {
+            // the tasks write into vCoins, so waiting for them mustn't be interrupted
+            libzerocoin::ParallelTasks::DoNotDisturb dnd;
+            libzerocoin::ParallelTasks mintTasks(vCoins.size());
+            BOOST_FOREACH(CZerocoinEntry &zerocoinEntry, vCoins) {
+                mintTasks.Add([&zerocoinEntry]() {
+                    libzerocoin::PrivateCoin newCoin(ZerocoinParams(), (libzerocoin::CoinDenomination)zerocoinEntry.denomination, ZEROCOIN_TX_VERSION_2);
+                    libzerocoin::PublicCoin pubCoin = newCoin.getPublicCoin();
+                    // a coin that fails validation keeps a zero value and is left out of the pool
+                    if (!ZerocoinValidatePubCoin(pubCoin))
+                        return;
+                    const unsigned char *ecdsaSecretKey = newCoin.getEcdsaSeckey();
+                    zerocoinEntry.value = pubCoin.getValue();
+                    zerocoinEntry.randomness = newCoin.getRandomness();
+                    zerocoinEntry.serialNumber = newCoin.getSerialNumber();
+                    zerocoinEntry.ecdsaSecretKey = std::vector<unsigned char>(ecdsaSecretKey, ecdsaSecretKey+32);
+                });
+            }
+            mintTasks.Wait();
+        }
+
+        {
+            LOCK(cs_wallet);
+            // the coins can't be encrypted if the wallet was locked meanwhile
+            if (IsLocked())
+                return false;
+
+            CWalletDB walletdb(strWalletFile);
+            BOOST_FOREACH(const CZerocoinEntry &zerocoinEntry, vCoins) {
+                if (!zerocoinEntry.value)
+                    continue;
+                CZerocoinMintPoolEntry entry;
+                if (!MakeZerocoinMintPoolEntry(*this, zerocoinEntry, entry) || !walletdb.WriteZerocoinMintPoolEntry(entry))
+                    throw runtime_error(std::string(__func__) + ": writing generated coin failed");
+                mapZerocoinMintPool[entry.denomination].insert(entry.value);
+                LogPrint("zerocoin", "zerocoin mint pool added coin of denomination %d, size=%u\n",
+                         entry.denomination, mapZerocoinMintPool[entry.denomination].size());
+            }
+        }
+
+        boost::this_thread::interruption_point();
+    }
+}
+
+bool CWallet::TakeZerocoinFromMintPool(int denomination, CZerocoinEntry &zerocoinEntry) {
+    LOCK(cs_wallet);
+    if (IsLocked())
+        return false;
+
+    set<CBigNum> &pool = mapZerocoinMintPool[denomination];
+    CWalletDB walletdb(strWalletFile);
+    while (!pool.empty()) {
+        CBigNum pubCoin = *pool.begin();
+        pool.erase(pool.begin());
+
+        // the record stays on disk until the coin is kept, unreadable coins are dropped
+        CZerocoinMintPoolEntry entry;
+        if (walletdb.ReadZerocoinMintPoolEntry(pubCoin, entry) && ReadZerocoinMintPoolEntry(*this, entry, zerocoinEntry))
+            return true;
+        walletdb.EraseZerocoinMintPoolEntry(pubCoin);
+        LogPrintf("TakeZerocoinFromMintPool(): dropped unreadable coin %s\n", pubCoin.GetHex());
+    }
+    return false;
+}
+
+void CWallet::KeepZerocoinFromMintPool(const CBigNum &pubCoin) {
+    // Remove from the mint pool
+    if (fFileBacked) {
+        CWalletDB walletdb(strWalletFile);
+        walletdb.EraseZerocoinMintPoolEntry(pubCoin);
+    }
+    LogPrint("zerocoin", "zerocoin mint pool keep %s\n", pubCoin.GetHex());
+}
+
+void CWallet::ReturnZerocoinToMintPool(int denomination, const CBigNum &pubCoin) {
+    // Return to the mint pool
+    {
+        LOCK(cs_wallet);
+        mapZerocoinMintPool[denomination].insert(pubCoin);
+    }
+    LogPrint("zerocoin", "zerocoin mint pool return %s\n", pubCoin.GetHex());
+}
+
 void CWallet::ReserveKeyFromKeyPool(int64_t &nIndex, CKeyPool &keypool) {
     nIndex = -1;
     keypool.vchPubKey = CPubKey();
@@ -4703,6 +4977,9 @@ std::string CWallet::GetWalletHelpString(bool showDebug) {
     strUsage += HelpMessageOpt("-disablewallet", _("Do not load the wallet and disable wallet RPC calls"));
     strUsage += HelpMessageOpt("-keypool=<n>",
                                strprintf(_("Set key pool size to <n> (default: %u)"), DEFAULT_KEYPOOL_SIZE));
+    strUsage += HelpMessageOpt("-zerocoinmintpool=<n>",
+                               strprintf(_("Keep <n> pre-minted zerocoins of every denomination ready, 0 to disable (default: %u)"),
+                                         DEFAULT_ZEROCOIN_MINT_POOL_SIZE));
     strUsage += HelpMessageOpt("-fallbackfee=<amt>", strprintf(
             _("A fee rate (in %s/kB) that will be used when fee estimation has insufficient data (default: %s)"),
             CURRENCY_UNIT, FormatMoney(DEFAULT_FALLBACK_FEE)));
@@ -42,6 +42,8 @@ extern bool bSpendZeroConfChange;
 extern bool fSendFreeTransactions;
 
 static const unsigned int DEFAULT_KEYPOOL_SIZE = 100;
+//! -zerocoinmintpool default, coins per denomination
+static const unsigned int DEFAULT_ZEROCOIN_MINT_POOL_SIZE = 0;
 //! -paytxfee default
 static const CAmount DEFAULT_TRANSACTION_FEE = 0;
 //! -fallbackfee default
@@ -569,6 +571,44 @@ private:
 };
 
 
+/**
+ * Accumulator witness of an unspent zerocoin mint: the accumulator value of all the coins of its group up to
+ * hashBlock except the mint itself. Kept up to date as blocks connect so a spend doesn't have to accumulate
+ * the group's coins again.
+ */
+class CZerocoinWitnessEntry
+{
+public:
+    int denomination;
+    int id;
+    Bignum value;
+    uint256 hashBlock;
+
+    CZerocoinWitnessEntry()
+    {
+        SetNull();
+    }
+
+    void SetNull()
+    {
+        denomination = 0;
+        id = 0;
+        value = 0;
+        hashBlock.SetNull();
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+        READWRITE(denomination);
+        READWRITE(id);
+        READWRITE(value);
+        READWRITE(hashBlock);
+    }
+};
+
+
 /**
  * A CWallet is an extension of a keystore, which also maintains a set of transactions and balances,
  * and provides the ability to create new transactions.
@@ -689,6 +729,15 @@ public:
 
     std::map<CTxDestination, CAddressBookData> mapAddressBook;
 
+    //! accumulator witnesses of unspent zerocoin mints by public coin value
+    std::map<CBigNum, CZerocoinWitnessEntry> mapZerocoinWitnesses;
+
+    //! zerocoin mints of the wallet not spent yet by public coin value, kept in step with the database entries
+    std::map<CBigNum, CZerocoinEntry> mapUnspentZerocoinMints;
+
+    //! public coin values of the pre-minted zerocoins in the mint pool by denomination
+    std::map<int, std::set<CBigNum> > mapZerocoinMintPool;
+
     CPubKey vchDefaultKey;
 
     std::set<COutPoint> setLockedCoins;
@@ -786,6 +835,7 @@ public:
     void MarkDirty();
     bool AddToWallet(const CWalletTx& wtxIn, bool fFromLoadWallet, CWalletDB* pwalletdb);
     void SyncTransaction(const CTransaction& tx, const CBlockIndex *pindex, const CBlock* pblock);
+    void UpdatedBlockTip(const CBlockIndex *pindex);
     bool AddToWalletIfInvolvingMe(const CTransaction& tx, const CBlock* pblock, bool fUpdate);
     int ScanForWalletTransactions(CBlockIndex* pindexStart, bool fUpdate = false);
     void ReacceptWalletTransactions();
@@ -843,6 +893,13 @@ public:
     bool CreateZerocoinMintModel(string &stringError, string denomAmount);
     bool CreateZerocoinSpendModel(string &stringError, string denomAmount);
     bool SetZerocoinBook(const CZerocoinEntry& zerocoinEntry);
+    //! Bring mapUnspentZerocoinMints in step with a zerocoin entry loaded or written to the database
+    void UpdateUnspentZerocoinMint(const CZerocoinEntry &zerocoinEntry);
+    /**
+     * Bring the cached accumulator witness of the mint up to the accumulator value at maxHeight, writing it to
+     * pwalletdb if it changed. Requires cs_main and cs_wallet.
+     */
+    bool UpdateZerocoinWitness(CWalletDB &walletdb, const CZerocoinEntry &zerocoinEntry, int id, int maxHeight, CZerocoinWitnessEntry &witness);
 
     bool CommitTransaction(CWalletTx& wtxNew, CReserveKey& reservekey);
 
@@ -866,6 +923,17 @@ public:
 
     bool NewKeyPool();
     bool TopUpKeyPool(unsigned int kpSize = 0);
+    /**
+     * Zerocoin mint pool: private coins are expensive to make (the commitment has to be prime), so a background
+     * thread keeps -zerocoinmintpool of them per denomination ready, encrypted like keys if the wallet is.
+     */
+    bool NewZerocoinMintPool();
+    bool TopUpZerocoinMintPool(unsigned int nSize = 0);
+    //! take a v2 coin of the denomination from the pool, false if the pool has none or the wallet is locked;
+    //! like a reserved key, the coin is kept once its zerocoin entry is written or returned if minting fails
+    bool TakeZerocoinFromMintPool(int denomination, CZerocoinEntry &zerocoinEntry);
+    void KeepZerocoinFromMintPool(const CBigNum &pubCoin);
+    void ReturnZerocoinToMintPool(int denomination, const CBigNum &pubCoin);
     void ReserveKeyFromKeyPool(int64_t& nIndex, CKeyPool& keypool);
     void KeepKey(int64_t nIndex);
     void ReturnKey(int64_t nIndex);
@@ -1174,6 +1242,40 @@ public:
     }
 };
 
+class CZerocoinMintPoolEntry
+{
+public:
+    int denomination;
+    Bignum value;
+    //! randomness, serial number and ECDSA secret key of the coin, encrypted with the master key if fCrypted
+    std::vector<unsigned char> vchSecret;
+    bool fCrypted;
+
+    CZerocoinMintPoolEntry()
+    {
+        SetNull();
+    }
+
+    void SetNull()
+    {
+        denomination = 0;
+        value = 0;
+        vchSecret.clear();
+        fCrypted = false;
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+        READWRITE(denomination);
+        READWRITE(value);
+        READWRITE(vchSecret);
+        READWRITE(fCrypted);
+    }
+};
+
 bool CompHeight(const CZerocoinEntry & a, const CZerocoinEntry & b);
 bool CompID(const CZerocoinEntry & a, const CZerocoinEntry & b);
+
 #endif // BITCOIN_WALLET_WALLET_H
@@ -258,6 +258,26 @@ bool CWalletDB::EraseZerocoinEntry(const CZerocoinEntry &zerocoin) {
     return Erase(make_pair(string("zerocoin"), zerocoin.value));
 }
 
+bool CWalletDB::WriteZerocoinWitness(const CBigNum &pubCoin, const CZerocoinWitnessEntry &witness) {
+    return Write(make_pair(string("zcwitness"), pubCoin), witness, true);
+}
+
+bool CWalletDB::EraseZerocoinWitness(const CBigNum &pubCoin) {
+    return Erase(make_pair(string("zcwitness"), pubCoin));
+}
+
+bool CWalletDB::WriteZerocoinMintPoolEntry(const CZerocoinMintPoolEntry &entry) {
+    return Write(make_pair(string("zcmintpool"), entry.value), entry, true);
+}
+
+bool CWalletDB::ReadZerocoinMintPoolEntry(const CBigNum &pubCoin, CZerocoinMintPoolEntry &entry) {
+    return Read(make_pair(string("zcmintpool"), pubCoin), entry);
+}
+
+bool CWalletDB::EraseZerocoinMintPoolEntry(const CBigNum &pubCoin) {
+    return Erase(make_pair(string("zcmintpool"), pubCoin));
+}
+
 // Check Calculated Blocked for Zerocoin
 bool CWalletDB::ReadCalculatedZCBlock(int &height) {
     height = 0;
@@ -637,6 +657,22 @@ bool ReadKeyValue(CWallet *pwallet, CDataStream &ssKey, CDataStream &ssValue,
                 strErr = "Error reading wallet database: SetHDChain failed";
                 return false;
             }
+        } else if (strType == "zcwitness") {
+            CBigNum pubCoin;
+            ssKey >> pubCoin;
+            ssValue >> pwallet->mapZerocoinWitnesses[pubCoin];
+        } else if (strType == "zerocoin") {
+            CBigNum pubCoin;
+            ssKey >> pubCoin;
+            CZerocoinEntry zerocoinItem;
+            ssValue >> zerocoinItem;
+            pwallet->UpdateUnspentZerocoinMint(zerocoinItem);
+        } else if (strType == "zcmintpool") {
+            CBigNum pubCoin;
+            ssKey >> pubCoin;
+            CZerocoinMintPoolEntry entry;
+            ssValue >> entry;
+            pwallet->mapZerocoinMintPool[entry.denomination].insert(pubCoin);
         }
     } catch (...) {
         return false;
@@ -923,6 +959,21 @@ void ThreadFlushWalletDB(const string &strFile) {
     }
 }
 
+void ThreadZerocoinMintPool() {
+    // Named like the other zerocoin threads
+    RenameThread("zerobitcoin-zcmintpool");
+    while (true) {
+        if (pwalletMain) {
+            try {
+                pwalletMain->TopUpZerocoinMintPool();
+            } catch (const std::exception &e) {
+                LogPrintf("ThreadZerocoinMintPool(): %s\n", e.what());
+            }
+        }
+        MilliSleep(5000);
+    }
+}
+
 // This should be called carefully:
 // either supply "wallet" (if already loaded) or "strWalletFile" (if wallet wasn't loaded yet)
 bool AutoBackupWallet (CWallet* wallet, std::string strWalletFile, std::string& strBackupWarning, std::string& strBackupError)
@@ -32,6 +32,8 @@ class CWalletTx;
 class uint160;
 class uint256;
 class CZerocoinEntry;
+class CZerocoinWitnessEntry;
+class CZerocoinMintPoolEntry;
 class CZerocoinSpendEntry;
 
 /** Error statuses for the wallet database */
@@ -173,6 +175,11 @@ public:
 
     bool WriteZerocoinEntry(const CZerocoinEntry& zerocoin);
     bool EraseZerocoinEntry(const CZerocoinEntry& zerocoin);
+    bool WriteZerocoinWitness(const CBigNum& pubCoin, const CZerocoinWitnessEntry& witness);
+    bool EraseZerocoinWitness(const CBigNum& pubCoin);
+    bool WriteZerocoinMintPoolEntry(const CZerocoinMintPoolEntry& entry);
+    bool ReadZerocoinMintPoolEntry(const CBigNum& pubCoin, CZerocoinMintPoolEntry& entry);
+    bool EraseZerocoinMintPoolEntry(const CBigNum& pubCoin);
     void ListPubCoin(std::list<CZerocoinEntry>& listPubCoin);
     void ListCoinSpendSerial(std::list<CZerocoinSpendEntry>& listCoinSpendSerial);
     bool WriteCoinSpendSerialEntry(const CZerocoinSpendEntry& zerocoinSpend);
@@ -203,6 +210,7 @@ private:
 };
 
 void ThreadFlushWalletDB(const std::string& strFile);
+void ThreadZerocoinMintPool();
 bool AutoBackupWallet (CWallet* wallet, std::string strWalletFile, std::string& strBackupWarning, std::string& strBackupError);
 
 #endif // BITCOIN_WALLET_WALLETDB_H
@@ -1,10 +1,15 @@
 #include "main.h"
 #include "zerocoin.h"
 #include "timedata.h"
+#include "txdb.h"
+#include "ui_interface.h"
 #include "chainparams.h"
 #include "util.h"
 #include "base58.h"
+#include "crypto/common.h"
 #include "definition.h"
+#include "hash.h"
+#include "random.h"
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
 
@@ -20,17 +25,40 @@ using namespace std;
 int64_t nTransactionFee = 0;
 int64_t nMinimumInputValue = DUST_HARD_LIMIT;
 
-// btzc: add zerocoin init
-// zerocoin init
-static CBigNum bnTrustedModulus;
-bool setParams = bnTrustedModulus.SetHexBool(ZEROCOIN_MODULUS);
-
 // Set up the Zerocoin Params object
 uint32_t securityLevel = 80;
-static libzerocoin::Params *ZCParams = new libzerocoin::Params(bnTrustedModulus);
 
 static CZerocoinState zerocoinState;
 
+static CZerocoinBlockInfoCache zerocoinBlockInfo;
+
+CZerocoinDB *pzerocoindb = NULL;
+
+static const char DB_ZC_MINT = 'M';
+static const char DB_ZC_SERIAL = 'S';
+static const char DB_ZC_GROUP = 'G';
+static const char DB_ZC_BEST_BLOCK = 'B';
+
+// Coin group as stored in the zerocoin database, blocks are referred to by hash
+struct CDiskCoinGroupInfo {
+    uint256 hashFirstBlock;
+    uint256 hashLastBlock;
+    int nCoins;
+
+    CDiskCoinGroupInfo() : nCoins(0) {}
+    CDiskCoinGroupInfo(const CZerocoinState::CoinGroupInfo &group) :
+        hashFirstBlock(group.firstBlock->GetBlockHash()), hashLastBlock(group.lastBlock->GetBlockHash()), nCoins(group.nCoins) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+        READWRITE(hashFirstBlock);
+        READWRITE(hashLastBlock);
+        READWRITE(nCoins);
+    }
+};
+
 bool CheckSpendZerobitcoinTransaction(const CTransaction &tx,
                                 libzerocoin::CoinDenomination targetDenomination,
                                 CValidationState &state,
@@ -38,13 +66,15 @@ bool CheckSpendZerobitcoinTransaction(const CTransaction &tx,
                                 bool isVerifyDB,
                                 int nHeight,
                                 bool isCheckWallet,
-                                CZerocoinTxInfo *zerocoinTxInfo) {
+                                CZerocoinTxInfo *zerocoinTxInfo,
+                                vector<CZerocoinSpendCheck> *pvChecks) {
 
     // Check for inputs only, everything else was checked before
 	LogPrintf("CheckSpendZerobitcoinTransaction denomination=%d nHeight=%d\n", targetDenomination, nHeight);
 
-	BOOST_FOREACH(const CTxIn &txin, tx.vin)
+	for (uint32_t nIn = 0; nIn < tx.vin.size(); nIn++)
 	{
+        const CTxIn &txin = tx.vin[nIn];
         if (!txin.scriptSig.IsZerocoinSpend())
             continue;
 
@@ -67,7 +97,8 @@ bool CheckSpendZerobitcoinTransaction(const CTransaction &tx,
         CDataStream serializedCoinSpend((const char *)&*(txin.scriptSig.begin() + 4),
                                         (const char *)&*txin.scriptSig.end(),
                                         SER_NETWORK, PROTOCOL_VERSION);
-        libzerocoin::CoinSpend newSpend(ZCParams, serializedCoinSpend);
+        std::shared_ptr<libzerocoin::CoinSpend> spend = std::make_shared<libzerocoin::CoinSpend>(ZerocoinParams(), serializedCoinSpend);
+        libzerocoin::CoinSpend &newSpend = *spend;
 
         int spendVersion = newSpend.getVersion();
         if (spendVersion != ZEROCOIN_TX_VERSION_1 &&
@@ -123,85 +154,45 @@ bool CheckSpendZerobitcoinTransaction(const CTransaction &tx,
             }
         }
 
-        libzerocoin::SpendMetaData newMetadata(txin.nSequence, txHashForMetadata);
-
         CZerocoinState::CoinGroupInfo coinGroup;
         if (!zerocoinState.GetCoinGroupInfo(targetDenomination, pubcoinId, coinGroup))
             return state.DoS(100, false, NO_MINT_ZEROCOIN, "CheckSpendZerobitcoinTransaction: Error: no coins were minted with such parameters");
 
-        bool passVerify = false;
-        CBlockIndex *index = coinGroup.lastBlock;
-        pair<int,int> denominationAndId = make_pair(targetDenomination, pubcoinId);
-		
-		bool spendHasBlockHash = false;
-		
-        // Zerocoin v1.5/v2 transaction can cointain block hash of the last mint tx seen at the moment of spend. It speeds
-		// up verification
-        if (spendVersion > ZEROCOIN_TX_VERSION_1 && !newSpend.getAccumulatorBlockHash().IsNull()) {
-			spendHasBlockHash = true;
-			uint256 accumulatorBlockHash = newSpend.getAccumulatorBlockHash();
-			
-			// find index for block with hash of accumulatorBlockHash or set index to the coinGroup.firstBlock if not found
-			while (index != coinGroup.firstBlock && index->GetBlockHash() != accumulatorBlockHash)
-				index = index->pprev;
-		}
+        CZerocoinSpendCheck check(spend, targetDenomination, txin.nSequence, txHashForMetadata, nHeight);
+        check.SetCacheKey(tx.GetHash(), nIn);
 
-        // Enumerate all the accumulator changes seen in the blockchain starting with the latest block
-        // In most cases the latest accumulator value will be used for verification
-        do {
-            if (index->accumulatorChanges.count(denominationAndId) > 0) {						
-                libzerocoin::Accumulator accumulator(ZCParams,
-                                                     index->accumulatorChanges[denominationAndId].first,
-                                                     targetDenomination);
-                LogPrintf("CheckSpendZerobitcoinTransaction: accumulator=%s\n", accumulator.getValue().ToString().substr(0,15));
-                passVerify = newSpend.Verify(accumulator, newMetadata);
-            }
+        // Zerocoin v1.5/v2 transaction can cointain block hash of the last mint tx seen at the moment of spend. It speeds
+        // up verification. Otherwise all the accumulator values of the group are collected starting with the latest
+        // one, in most cases the latest accumulator value will be used for verification
+        uint256 accumulatorBlockHash;
+        if (spendVersion > ZEROCOIN_TX_VERSION_1)
+            accumulatorBlockHash = newSpend.getAccumulatorBlockHash();
 
-	        // if spend has block hash we don't need to look further
-			if (index == coinGroup.firstBlock || spendHasBlockHash)
-                break;
-            else
-                index = index->pprev;
-        } while (!passVerify);
+        vector<CBigNum> accumulatorValues;
+        zerocoinState.GetAccumulatorValuesForSpend(targetDenomination, pubcoinId, accumulatorBlockHash, accumulatorValues);
+        BOOST_FOREACH(const CBigNum &accumulatorValue, accumulatorValues)
+            check.AddAccumulatorValue(accumulatorValue);
 
         // Rare case: accumulator value contains some but NOT ALL coins from one block. In this case we will
-        // have to enumerate over coins manually. No optimization is really needed here because it's a rarity
+        // have to enumerate over coins manually, so the check needs all the coins of the group
         // This can't happen if spend is of version 1.5 or 2.0
-        if (!passVerify && spendVersion == ZEROCOIN_TX_VERSION_1) {
+        if (spendVersion == ZEROCOIN_TX_VERSION_1) {
             // Build vector of coins sorted by the time of mint
-            index = coinGroup.lastBlock;
-            vector<CBigNum> pubCoins = index->mintedPubCoins[denominationAndId];
-            if (index != coinGroup.firstBlock) {
-                do {
-                    index = index->pprev;
-                    if (index->mintedPubCoins.count(denominationAndId) > 0)
-                        pubCoins.insert(pubCoins.begin(),
-                                        index->mintedPubCoins[denominationAndId].cbegin(),
-                                        index->mintedPubCoins[denominationAndId].cend());
-                } while (index != coinGroup.firstBlock);
-            }
-
-            libzerocoin::Accumulator accumulator(ZCParams, targetDenomination);
-            BOOST_FOREACH(const CBigNum &pubCoin, pubCoins) {
-                accumulator += libzerocoin::PublicCoin(ZCParams, pubCoin, (libzerocoin::CoinDenomination)targetDenomination);
-                LogPrintf("CheckSpendZerobitcoinTransaction: accumulator=%s\n", accumulator.getValue().ToString().substr(0,15));
-                if ((passVerify = newSpend.Verify(accumulator, newMetadata)) == true)
-                    break;
-            }
-
-            if (!passVerify) {
-                // One more time now in reverse direction. The only reason why it's required is compatibility with
-                // previous client versions
-                libzerocoin::Accumulator accumulator(ZCParams, targetDenomination);
-                BOOST_REVERSE_FOREACH(const CBigNum &pubCoin, pubCoins) {
-                    accumulator += libzerocoin::PublicCoin(ZCParams, pubCoin, (libzerocoin::CoinDenomination)targetDenomination);
-                    LogPrintf("CheckSpendZerobitcoinTransaction: accumulatorRev=%s\n", accumulator.getValue().ToString().substr(0,15));
-                    if ((passVerify = newSpend.Verify(accumulator, newMetadata)) == true)
-                        break;
-                }
-            }
+            vector<CBigNum> pubCoins;
+            zerocoinState.GetCoinGroupPubCoins(targetDenomination, pubcoinId, pubCoins);
+            check.SetPubCoins(pubCoins);
         }
 
+        // The proof is verified either right now or later with the others of the block or transaction
+        // by CZerocoinSpendCheck::VerifyBatch, serials are checked here either way so that spends within
+        // the block are handled in order
+        bool passVerify = true;
+        if (pvChecks) {
+            pvChecks->push_back(std::move(check));
+        }
+        else {
+            passVerify = check();
+        }
 
         if (passVerify) {
             // Pull the serial number out of the CoinSpend object. If we
@@ -233,13 +224,197 @@ bool CheckSpendZerobitcoinTransaction(const CTransaction &tx,
             }
         }
         else {
-            LogPrintf("CheckSpendZerobitcoinTransaction: verification failed at block %d\n", nHeight);
             return false;
         }
 	}
 	return true;
 }
 
+CZerocoinSpendCache zerocoinSpendCache;
+
+CZerocoinSpendCache::CZerocoinSpendCache(size_t nMaxUsageIn) : CSaltedHashSet<>(nMaxUsageIn), nHits(0), nMisses(0)
+{
+}
+
+uint256 CZerocoinSpendCache::ComputeEntry(const uint256 &hashTx, uint32_t nIn, int spendVersion,
+                                          libzerocoin::CoinDenomination denomination, uint32_t pubcoinId,
+                                          const uint256 &txHashForMetadata, const CBigNum &accumulatorValue) const
+{
+    uint256 entry;
+    unsigned char buf[16];
+    WriteLE32(buf, nIn);
+    WriteLE32(buf + 4, (uint32_t)spendVersion);
+    WriteLE32(buf + 8, (uint32_t)denomination);
+    WriteLE32(buf + 12, pubcoinId);
+    vector<unsigned char> vchAccumulator = accumulatorValue.getvch();
+    Salted().Write(hashTx.begin(), 32).Write(buf, sizeof(buf))
+            .Write(txHashForMetadata.begin(), 32).Write(vchAccumulator.data(), vchAccumulator.size()).Finalize(entry.begin());
+    return entry;
+}
+
+CZerocoinSpendCacheStats CZerocoinSpendCache::GetStats() const
+{
+    CZerocoinSpendCacheStats stats;
+    stats.nEntries = Size();
+    stats.nUsage = DynamicUsage();
+    stats.nMaxUsage = GetMaxUsage();
+    stats.nHits = nHits;
+    stats.nMisses = nMisses;
+    return stats;
+}
+
+namespace {
+
+/** Entries are SHA256(nonce || rounds || coin value) */
+class CValidPubCoinCache : public CSaltedHashSet<>
+{
+public:
+    CValidPubCoinCache() : CSaltedHashSet<>(ZEROCOIN_VALID_COIN_CACHE_SIZE) {}
+
+    uint256 ComputeEntry(const CBigNum &value, uint32_t rounds) const
+    {
+        uint256 entry;
+        unsigned char buf[4];
+        WriteLE32(buf, rounds);
+        vector<unsigned char> vch = value.getvch();
+        Salted().Write(buf, sizeof(buf)).Write(vch.data(), vch.size()).Finalize(entry.begin());
+        return entry;
+    }
+};
+
+CValidPubCoinCache validPubCoinCache;
+
+}
+
+bool ZerocoinValidatePubCoin(const libzerocoin::PublicCoin &pubCoin)
+{
+    // the range check is cheap and depends on the params, it isn't cached
+    const libzerocoin::Params *params = ZerocoinParams();
+    const CBigNum &value = pubCoin.getValue();
+    if (!(params->accumulatorParams.minCoinValue < value) || !(value < params->accumulatorParams.maxCoinValue))
+        return false;
+
+    uint256 entry = validPubCoinCache.ComputeEntry(value, params->zkp_iterations);
+    if (validPubCoinCache.Contains(entry))
+        return true;
+    if (!pubCoin.validate())
+        return false;
+    validPubCoinCache.Insert(entry);
+    return true;
+}
+
+bool CZerocoinSpendCheck::IsCached() const {
+    if (hashTx.IsNull())
+        return false;
+    bool fHit = false;
+    BOOST_FOREACH(const CBigNum &value, accumulatorValues) {
+        if (zerocoinSpendCache.Contains(zerocoinSpendCache.ComputeEntry(hashTx, nIn, spend->getVersion(), denomination,
+                                                                        pubcoinId, txHashForMetadata, value))) {
+            fHit = true;
+            break;
+        }
+    }
+    zerocoinSpendCache.CountLookup(fHit);
+    return fHit;
+}
+
+void CZerocoinSpendCheck::SetCached(const CBigNum &accumulatorValue) const {
+    if (!hashTx.IsNull())
+        zerocoinSpendCache.Insert(zerocoinSpendCache.ComputeEntry(hashTx, nIn, spend->getVersion(), denomination,
+                                                                  pubcoinId, txHashForMetadata, accumulatorValue));
+}
+
+bool CZerocoinSpendCheck::Verify(bool fCacheStore) {
+    if (spend && IsCached())
+        return true;
+    return VerifyUncached(fCacheStore);
+}
+
+bool CZerocoinSpendCheck::VerifyUncached(bool fCacheStore) {
+    libzerocoin::SpendMetaData newMetadata(pubcoinId, txHashForMetadata);
+    bool passVerify = false;
+
+    try {
+        BOOST_FOREACH(const CBigNum &value, accumulatorValues) {
+            libzerocoin::Accumulator accumulator(ZerocoinParams(), value, denomination);
+            LogPrintf("CheckSpendZerobitcoinTransaction: accumulator=%s\n", accumulator.getValue().ToString().substr(0,15));
+            if ((passVerify = spend->Verify(accumulator, newMetadata)) == true) {
+                if (fCacheStore)
+                    SetCached(value);
+                break;
+            }
+        }
+
+        if (!passVerify && !pubCoins.empty()) {
+            libzerocoin::Accumulator accumulator(ZerocoinParams(), denomination);
+            BOOST_FOREACH(const CBigNum &pubCoin, pubCoins) {
+                accumulator += libzerocoin::PublicCoin(ZerocoinParams(), pubCoin, denomination);
+                LogPrintf("CheckSpendZerobitcoinTransaction: accumulator=%s\n", accumulator.getValue().ToString().substr(0,15));
+                if ((passVerify = spend->Verify(accumulator, newMetadata)) == true)
+                    break;
+            }
+
+            if (!passVerify) {
+                // One more time now in reverse direction. The only reason why it's required is compatibility with
+                // previous client versions
+                libzerocoin::Accumulator accumulator(ZerocoinParams(), denomination);
+                BOOST_REVERSE_FOREACH(const CBigNum &pubCoin, pubCoins) {
+                    accumulator += libzerocoin::PublicCoin(ZerocoinParams(), pubCoin, denomination);
+                    LogPrintf("CheckSpendZerobitcoinTransaction: accumulatorRev=%s\n", accumulator.getValue().ToString().substr(0,15));
+                    if ((passVerify = spend->Verify(accumulator, newMetadata)) == true)
+                        break;
+                }
+            }
+        }
+    } catch (const std::exception &e) {
+        // A malformed proof fails the check, VerifyBatch relies on this returning rather than throwing
+        LogPrintf("CheckSpendZerobitcoinTransaction: exception %s\n", e.what());
+        passVerify = false;
+    }
+
+    if (!passVerify)
+        LogPrintf("CheckSpendZerobitcoinTransaction: verification failed at block %d\n", nHeight);
+    return passVerify;
+}
+
+bool CZerocoinSpendCheck::VerifyBatch(vector<CZerocoinSpendCheck> &checks, bool fCacheStore) {
+    libzerocoin::BatchVerifier batch(ZerocoinParams());
+    // index of every check in the batch, none for the ones found in the cache or without accumulator values
+    static const size_t nNotInBatch = (size_t)-1;
+    vector<size_t> batchIndex(checks.size(), nNotInBatch);
+    vector<bool> fCached(checks.size(), false);
+    for (size_t i = 0; i < checks.size(); i++) {
+        const CZerocoinSpendCheck &check = checks[i];
+        if (!check.spend)
+            continue;
+        if ((fCached[i] = check.IsCached()) == true)
+            continue;
+        if (!check.accumulatorValues.empty())
+            batchIndex[i] = batch.Add(*check.spend, libzerocoin::Accumulator(ZerocoinParams(), check.accumulatorValues[0], check.denomination),
+                                      libzerocoin::SpendMetaData(check.pubcoinId, check.txHashForMetadata));
+    }
+
+    try {
+        if (batch.size() > 0)
+            batch.Verify();
+    } catch (const std::exception &e) {
+        LogPrintf("CZerocoinSpendCheck::VerifyBatch: exception %s\n", e.what());
+    }
+
+    for (size_t i = 0; i < checks.size(); i++) {
+        if (fCached[i])
+            continue;
+        if (batchIndex[i] != nNotInBatch && batch.GetResult(batchIndex[i])) {
+            if (fCacheStore)
+                checks[i].SetCached(checks[i].accumulatorValues[0]);
+            continue;
+        }
+        if (!checks[i].VerifyUncached(fCacheStore))
+            return false;
+    }
+    return true;
+}
+
 bool CheckMintZerobitcoinTransaction(const CTxOut &txout,
                                CValidationState &state,
                                uint256 hashTx,
@@ -288,8 +463,8 @@ bool CheckMintZerobitcoinTransaction(const CTxOut &txout,
     case libzerocoin::ZQ_PEDERSEN*COIN:
     case libzerocoin::ZQ_WILLIAMSON*COIN:
         libzerocoin::CoinDenomination denomination = (libzerocoin::CoinDenomination)(txout.nValue / COIN);
-        libzerocoin::PublicCoin checkPubCoin(ZCParams, pubCoin, denomination);
-        if (!checkPubCoin.validate())
+        libzerocoin::PublicCoin checkPubCoin(ZerocoinParams(), pubCoin, denomination);
+        if (!ZerocoinValidatePubCoin(checkPubCoin))
             return state.DoS(100,
                 false,
                 PUBCOIN_NOT_VALIDATE,
@@ -435,7 +610,8 @@ bool CheckZerocoinTransaction(const CTransaction &tx,
                               bool isVerifyDB,
                               int nHeight,
                               bool isCheckWallet,
-                              CZerocoinTxInfo *zerocoinTxInfo)
+                              CZerocoinTxInfo *zerocoinTxInfo,
+                              vector<CZerocoinSpendCheck> *pvChecks)
 {
 	// Check Mint Zerocoin Transaction
 	BOOST_FOREACH(const CTxOut &txout, tx.vout) {
@@ -458,7 +634,7 @@ bool CheckZerocoinTransaction(const CTransaction &tx,
                 case libzerocoin::ZQ_RACKOFF*COIN:
                 case libzerocoin::ZQ_PEDERSEN*COIN:
                 case libzerocoin::ZQ_WILLIAMSON*COIN:
-                    if(!CheckSpendZerobitcoinTransaction(tx, (libzerocoin::CoinDenomination)(txout.nValue / COIN), state, hashTx, isVerifyDB, nHeight, isCheckWallet, zerocoinTxInfo))
+                    if(!CheckSpendZerobitcoinTransaction(tx, (libzerocoin::CoinDenomination)(txout.nValue / COIN), state, hashTx, isVerifyDB, nHeight, isCheckWallet, zerocoinTxInfo, pvChecks))
                         return false;
                     break;
 
@@ -498,36 +674,41 @@ bool ConnectTipZC(CValidationState &state, const CChainParams &chainparams, CBlo
             }
         }
 
-        pindexNew->spentSerials = pblock->zerocoinTxInfo->spentSerials;
+        CZerocoinBlockInfo info;
+        info.spentSerials = pblock->zerocoinTxInfo->spentSerials;
 
         // Update minted values and accumulators
         BOOST_FOREACH(const PAIRTYPE(int,CBigNum) &mint, pblock->zerocoinTxInfo->mints) {
             int denomination = mint.first;
-            CBigNum oldAccValue = ZCParams->accumulatorParams.accumulatorBase;
+            CBigNum oldAccValue = ZerocoinParams()->accumulatorParams.accumulatorBase;
             int mintId = zerocoinState.AddMint(pindexNew, denomination, mint.second, oldAccValue);
             LogPrintf("ConnectTipZC: mint added denomination=%d, id=%d\n", denomination, mintId);
             pair<int,int> denomAndId = make_pair(denomination, mintId);
 
-            pindexNew->mintedPubCoins[denomAndId].push_back(mint.second);
+            info.mintedPubCoins[denomAndId].push_back(mint.second);
 
-            CZerocoinState::CoinGroupInfo coinGroupInfo;
-            zerocoinState.GetCoinGroupInfo(denomination, mintId, coinGroupInfo);
+            // previous mint of the group may be in this very block
+            map<pair<int,int>, pair<CBigNum,int> >::iterator accChange = info.accumulatorChanges.find(denomAndId);
+            if (accChange != info.accumulatorChanges.end())
+                oldAccValue = accChange->second.first;
 
-            libzerocoin::PublicCoin pubCoin(ZCParams, mint.second, (libzerocoin::CoinDenomination)denomination);
-            libzerocoin::Accumulator accumulator(ZCParams,
+            libzerocoin::PublicCoin pubCoin(ZerocoinParams(), mint.second, (libzerocoin::CoinDenomination)denomination);
+            libzerocoin::Accumulator accumulator(ZerocoinParams(),
                                                  oldAccValue,
                                                  (libzerocoin::CoinDenomination)denomination);
             accumulator += pubCoin;
 
-            if (pindexNew->accumulatorChanges.count(denomAndId) > 0) {
-                pair<CBigNum,int> &accChange = pindexNew->accumulatorChanges[denomAndId];
-                accChange.first = accumulator.getValue();
-                accChange.second++;
+            if (accChange != info.accumulatorChanges.end()) {
+                accChange->second.first = accumulator.getValue();
+                accChange->second.second++;
             }
             else {
-                pindexNew->accumulatorChanges[denomAndId] = make_pair(accumulator.getValue(), 1);
+                info.accumulatorChanges[denomAndId] = make_pair(accumulator.getValue(), 1);
             }
-        }               
+        }
+
+        ZerocoinSetBlockInfo(pindexNew, info);
+        zerocoinState.AddAccumulatorChanges(pindexNew, info);
     }
     else {
         zerocoinState.AddBlock(pindexNew);
@@ -548,11 +729,45 @@ int ZerocoinGetNHeight(const CBlockHeader &block) {
 }
 
 
+const libzerocoin::Params *ZerocoinParams() {
+    // Built on first use and not during static initialization: the generator tables take megabytes and
+    // most of a second, and the arguments aren't parsed yet at that point
+    static const libzerocoin::Params *params = [] {
+        CBigNum bnTrustedModulus;
+        bnTrustedModulus.SetHex(ZEROCOIN_MODULUS);
+        return new libzerocoin::Params(bnTrustedModulus);
+    }();
+    return params;
+}
+
 bool ZerocoinBuildStateFromIndex(CChain *chain) {
+    uint256 hashBestBlock;
+    if (pzerocoindb && chain->Tip() && pzerocoindb->ReadBestBlock(hashBestBlock) &&
+            hashBestBlock == chain->Tip()->GetBlockHash()) {
+        if (zerocoinState.Load()) {
+            LogPrintf("Zerocoin state loaded from database, %u coin groups\n", zerocoinState.coinGroups.size());
+            LogPrintf("Latest IDs are %d, %d, %d, %d, %d\n",
+                      zerocoinState.latestCoinIds[1],
+                      zerocoinState.latestCoinIds[10],
+                      zerocoinState.latestCoinIds[25],
+                      zerocoinState.latestCoinIds[50],
+                      zerocoinState.latestCoinIds[100]);
+            return true;
+        }
+        LogPrintf("ZerocoinBuildStateFromIndex: zerocoin database is inconsistent, rebuilding\n");
+    }
+
+    // The database doesn't match the chain tip, replay the whole chain and write the result
     zerocoinState.Reset();
+    if (pzerocoindb && !pzerocoindb->Wipe())
+        return error("ZerocoinBuildStateFromIndex: failed to wipe zerocoin database");
+
     for (CBlockIndex *blockIndex = chain->Genesis(); blockIndex; blockIndex=chain->Next(blockIndex))
         zerocoinState.AddBlock(blockIndex);
 
+    if (chain->Tip() && !zerocoinState.Flush(chain->Tip()->GetBlockHash()))
+        return error("ZerocoinBuildStateFromIndex: failed to write zerocoin database");
+
     // DEBUG
     LogPrintf("Latest IDs are %d, %d, %d, %d, %d\n",
               zerocoinState.latestCoinIds[1],
@@ -563,36 +778,47 @@ bool ZerocoinBuildStateFromIndex(CChain *chain) {
 	return true;
 }
 
+bool ZerocoinFlushState(const uint256 &hashBlock) {
+    return zerocoinState.Flush(hashBlock);
+}
+
 // CZerocoinTxInfo
 
 void CZerocoinTxInfo::Complete() {
     // We need to sort mints lexicographically by serialized value of pubCoin. That's the way old code
-    // works, we need to stick to it. Denomination doesn't matter but we will sort by it as well
-    sort(mints.begin(), mints.end(),
-         [](decltype(mints)::const_reference m1, decltype(mints)::const_reference m2)->bool {
-            CDataStream ds1(SER_DISK, CLIENT_VERSION), ds2(SER_DISK, CLIENT_VERSION);
-            ds1 << m1.second;
-            ds2 << m2.second;
-            return (m1.first < m2.first) || ((m1.first == m2.first) && (ds1.str() < ds2.str()));
-         });
+    // works, we need to stick to it. Denomination doesn't matter but we will sort by it as well.
+    // Serialize every coin once and sort the keys
+    vector<pair<pair<int, string>, size_t> > sortKeys;
+    sortKeys.reserve(mints.size());
+    for (size_t i = 0; i < mints.size(); i++) {
+        CDataStream ds(SER_DISK, CLIENT_VERSION);
+        ds << mints[i].second;
+        sortKeys.push_back(make_pair(make_pair(mints[i].first, ds.str()), i));
+    }
+    sort(sortKeys.begin(), sortKeys.end());
+
+    decltype(mints) sortedMints;
+    sortedMints.reserve(mints.size());
+    for (const auto &sortKey: sortKeys)
+        sortedMints.push_back(mints[sortKey.second]);
+    mints.swap(sortedMints);
 
     // Mark this info as complete
     fInfoIsComplete = true;
 }
 
-// CZerocoinState::CBigNumHash
+// CZerocoinState
 
-std::size_t CZerocoinState::CBigNumHash::operator ()(const CBigNum &bn) const noexcept {
-    // we are operating on almost random big numbers and least significant bytes (save for few last bytes) give us a good hash
-    vector<unsigned char> bnData = bn.ToBytes();
-    if (bnData.size() < sizeof(size_t)*3)
-        // rare case, put ones like that into one hash bin
-        return 0;
-    else
-        return ((size_t*)bnData.data())[1];
-}
+CZerocoinState::CBigNumHasher::CBigNumHasher() :
+        k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())),
+        nModulus(0x80000000 | GetRand(0x80000000) | 1) {}
 
-// CZerocoinState
+size_t CZerocoinState::CBigNumHasher::operator()(const CBigNum &bn) const {
+    // a secret modulus keeps peers from choosing numbers that collide, BN_mod_word doesn't allocate for
+    // moduli of up to 32 bits
+    return CSipHasher(k0, k1).Write(((uint64_t)BN_num_bits(&bn) << 1) | (BN_is_negative(&bn) ? 1 : 0))
+                             .Write((uint64_t)BN_mod_word(&bn, nModulus)).Finalize();
+}
 
 CZerocoinState::CZerocoinState() {
 }
@@ -611,12 +837,16 @@ int CZerocoinState::AddMint(CBlockIndex *index, int denomination, const CBigNum
     CoinGroupInfo &coinGroup = coinGroups[make_pair(denomination, mintId)];
 	int coinsPerId = IsZerocoinTxV2((libzerocoin::CoinDenomination)denomination, mintId) ? ZC_SPEND_V2_COINSPERID : ZC_SPEND_V1_COINSPERID;
     if (coinGroup.nCoins < coinsPerId || coinGroup.lastBlock == index) {
+        dirtyCoinGroups.insert(make_pair(denomination, mintId));
         if (coinGroup.nCoins++ == 0) {
             // first groups of coins for given denomination
             coinGroup.firstBlock = coinGroup.lastBlock = index;
+            accumulatorCheckpoints[make_pair(denomination, mintId)].clear();
         }
         else {
-            previousAccValue = coinGroup.lastBlock->accumulatorChanges[make_pair(denomination,mintId)].first;
+            // mints of the same block are accumulated by the caller
+            if (coinGroup.lastBlock != index)
+                previousAccValue = GetCheckpoints(make_pair(denomination, mintId)).back().value;
             coinGroup.lastBlock = index;
         }
     }
@@ -625,90 +855,130 @@ int CZerocoinState::AddMint(CBlockIndex *index, int denomination, const CBigNum
         CoinGroupInfo &newCoinGroup = coinGroups[make_pair(denomination, mintId)];
         newCoinGroup.firstBlock = newCoinGroup.lastBlock = index;
         newCoinGroup.nCoins = 1;
+        dirtyCoinGroups.insert(make_pair(denomination, mintId));
+        accumulatorCheckpoints[make_pair(denomination, mintId)].clear();
     }
 
     CMintedCoinInfo coinInfo;
     coinInfo.denomination = denomination;
     coinInfo.id = mintId;
     coinInfo.nHeight = index->nHeight;
-    mintedPubCoins.insert(pair<CBigNum,CMintedCoinInfo>(pubCoin, coinInfo));
+    CMintedCoinsEntry &entry = FetchMintedCoins(pubCoin);
+    entry.coins.push_back(coinInfo);
+    entry.fDirty = true;
 
     return mintId;
 }
 
 void CZerocoinState::AddSpend(const CBigNum &serial) {
-    usedCoinSerials.insert(serial);
+    CCoinSerialEntry &entry = FetchCoinSerial(serial);
+    entry.nSpends++;
+    entry.fDirty = true;
+}
+
+void CZerocoinState::AddAccumulatorChanges(CBlockIndex *index, const CZerocoinBlockInfo &info) {
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), PAIRTYPE(CBigNum,int)) &accUpdate, info.accumulatorChanges)
+    {
+        // groups without checkpoints get them from the block index when first needed
+        auto checkpointsIt = accumulatorCheckpoints.find(accUpdate.first);
+        if (checkpointsIt == accumulatorCheckpoints.end())
+            continue;
+
+        vector<CAccumulatorCheckpoint> &checkpoints = checkpointsIt->second;
+        if (!checkpoints.empty() && checkpoints.back().block == index)
+            checkpoints.pop_back();
+        assert(checkpoints.empty() || checkpoints.back().block->nHeight < index->nHeight);
+
+        CAccumulatorCheckpoint checkpoint;
+        checkpoint.block = index;
+        checkpoint.value = accUpdate.second.first;
+        checkpoint.nCoins = (checkpoints.empty() ? 0 : checkpoints.back().nCoins) + accUpdate.second.second;
+        checkpoints.push_back(checkpoint);
+    }
 }
 
 void CZerocoinState::AddBlock(CBlockIndex *index) {
-    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), PAIRTYPE(CBigNum,int)) &accUpdate, index->accumulatorChanges)
+    std::shared_ptr<const CZerocoinBlockInfo> info = ZerocoinGetBlockInfo(index);
+
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), PAIRTYPE(CBigNum,int)) &accUpdate, info->accumulatorChanges)
     {
         CoinGroupInfo   &coinGroup = coinGroups[accUpdate.first];
+        dirtyCoinGroups.insert(accUpdate.first);
 
         if (coinGroup.firstBlock == NULL)
             coinGroup.firstBlock = index;
         coinGroup.lastBlock = index;
         coinGroup.nCoins += accUpdate.second.second;
     }
+    AddAccumulatorChanges(index, *info);
 
-    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int),vector<CBigNum>) &pubCoins, index->mintedPubCoins) {
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int),vector<CBigNum>) &pubCoins, info->mintedPubCoins) {
         latestCoinIds[pubCoins.first.first] = pubCoins.first.second;
         BOOST_FOREACH(const CBigNum &coin, pubCoins.second) {
             CMintedCoinInfo coinInfo;
             coinInfo.denomination = pubCoins.first.first;
             coinInfo.id = pubCoins.first.second;
             coinInfo.nHeight = index->nHeight;
-            mintedPubCoins.insert(pair<CBigNum,CMintedCoinInfo>(coin, coinInfo));
+            CMintedCoinsEntry &entry = FetchMintedCoins(coin);
+            entry.coins.push_back(coinInfo);
+            entry.fDirty = true;
         }
     }
 
     if (index->nHeight > ZC_CHECK_BUG_FIXED_AT_BLOCK) {
-        BOOST_FOREACH(const CBigNum &serial, index->spentSerials) {
-           usedCoinSerials.insert(serial);
+        BOOST_FOREACH(const CBigNum &serial, info->spentSerials) {
+           AddSpend(serial);
         }
     }
 }
 
 void CZerocoinState::RemoveBlock(CBlockIndex *index) {
+    std::shared_ptr<const CZerocoinBlockInfo> info = ZerocoinGetBlockInfo(index);
+
     // roll back accumulator updates
-    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), PAIRTYPE(CBigNum,int)) &accUpdate, index->accumulatorChanges)
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), PAIRTYPE(CBigNum,int)) &accUpdate, info->accumulatorChanges)
     {
         CoinGroupInfo   &coinGroup = coinGroups[accUpdate.first];
         int  nMintsToForget = accUpdate.second.second;
+        dirtyCoinGroups.insert(accUpdate.first);
 
         assert(coinGroup.nCoins >= nMintsToForget);
 
         if ((coinGroup.nCoins -= nMintsToForget) == 0) {
             // all the coins of this group have been erased, remove the group altogether
             coinGroups.erase(accUpdate.first);
+            accumulatorCheckpoints.erase(accUpdate.first);
             // decrease pubcoin id for this denomination
             latestCoinIds[accUpdate.first.first]--;
         }
         else {
             // roll back lastBlock to previous position
-            do {
-                assert(coinGroup.lastBlock != coinGroup.firstBlock);
-                coinGroup.lastBlock = coinGroup.lastBlock->pprev;
-            } while (coinGroup.lastBlock->accumulatorChanges.count(accUpdate.first) == 0);
+            vector<CAccumulatorCheckpoint> &checkpoints = GetCheckpoints(accUpdate.first);
+            assert(checkpoints.size() > 1 && checkpoints.back().block == index);
+            checkpoints.pop_back();
+            coinGroup.lastBlock = checkpoints.back().block;
         }
     }
 
     // roll back mints
-    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int),vector<CBigNum>) &pubCoins, index->mintedPubCoins) {
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int),vector<CBigNum>) &pubCoins, info->mintedPubCoins) {
         BOOST_FOREACH(const CBigNum &coin, pubCoins.second) {
-            auto coins = mintedPubCoins.equal_range(coin);
-            auto coinIt = find_if(coins.first, coins.second, [=](const decltype(mintedPubCoins)::value_type &v) {
-                return v.second.denomination == pubCoins.first.first &&
-                        v.second.id == pubCoins.first.second;
+            CMintedCoinsEntry &entry = FetchMintedCoins(coin);
+            auto coinIt = find_if(entry.coins.begin(), entry.coins.end(), [=](const CMintedCoinInfo &v) {
+                return v.denomination == pubCoins.first.first &&
+                        v.id == pubCoins.first.second;
             });
-            assert(coinIt != mintedPubCoins.end());
-            mintedPubCoins.erase(coinIt);
+            assert(coinIt != entry.coins.end());
+            entry.coins.erase(coinIt);
+            entry.fDirty = true;
         }
     }
 
     // roll back spends
-    BOOST_FOREACH(const CBigNum &serial, index->spentSerials) {
-        usedCoinSerials.erase(serial);
+    BOOST_FOREACH(const CBigNum &serial, info->spentSerials) {
+        CCoinSerialEntry &entry = FetchCoinSerial(serial);
+        entry.nSpends = 0;
+        entry.fDirty = true;
     }
 }
 
@@ -722,11 +992,23 @@ bool CZerocoinState::GetCoinGroupInfo(int denomination, int id, CoinGroupInfo &r
 }
 
 bool CZerocoinState::IsUsedCoinSerial(const CBigNum &coinSerial) {
-    return usedCoinSerials.count(coinSerial) != 0;
+    const CCoinSerialEntry *entry = FindCoinSerial(coinSerial);
+    return entry != NULL && entry->nSpends != 0;
 }
 
 bool CZerocoinState::HasCoin(const CBigNum &pubCoin) {
-    return mintedPubCoins.count(pubCoin) != 0;
+    const CMintedCoinsEntry *entry = FindMintedCoins(pubCoin);
+    return entry != NULL && !entry->coins.empty();
+}
+
+// Checkpoint of the given block or end() if the block has no mints of the group
+static vector<CZerocoinState::CAccumulatorCheckpoint>::const_iterator FindAccumulatorCheckpoint(
+        const vector<CZerocoinState::CAccumulatorCheckpoint> &checkpoints, const CBlockIndex *block) {
+    auto checkpointIt = lower_bound(checkpoints.begin(), checkpoints.end(), block->nHeight,
+                                    [](const CZerocoinState::CAccumulatorCheckpoint &c, int nHeight) { return c.block->nHeight < nHeight; });
+    if (checkpointIt != checkpoints.end() && checkpointIt->block != block)
+        return checkpoints.end();
+    return checkpointIt;
 }
 
 int CZerocoinState::GetAccumulatorValueForSpend(int maxHeight, int denomination, int id, CBigNum &accumulator, uint256 &blockHash) {
@@ -735,86 +1017,160 @@ int CZerocoinState::GetAccumulatorValueForSpend(int maxHeight, int denomination,
     if (coinGroups.count(denomAndId) == 0)
         return 0;
 
-    CoinGroupInfo coinGroup = coinGroups[denomAndId];
-    CBlockIndex *lastBlock = coinGroup.lastBlock;
-
-    assert(lastBlock->accumulatorChanges.count(denomAndId) > 0);
-    assert(coinGroup.firstBlock->accumulatorChanges.count(denomAndId) > 0);
-
-    int numberOfCoins = 0;
-    for (;;) {
-        if (lastBlock->accumulatorChanges.count(denomAndId) > 0) {
-            if (lastBlock->nHeight <= maxHeight) {
-                if (numberOfCoins == 0) {
-                    // latest block satisfying given conditions
-                    // remember accumulator value and block hash
-                    accumulator = lastBlock->accumulatorChanges[denomAndId].first;
-                    blockHash = lastBlock->GetBlockHash();
-                }
-                numberOfCoins += lastBlock->accumulatorChanges[denomAndId].second;
-            }
-        }
+    // latest block satisfying given conditions
+    const vector<CAccumulatorCheckpoint> &checkpoints = GetCheckpoints(denomAndId);
+    auto checkpointIt = upper_bound(checkpoints.begin(), checkpoints.end(), maxHeight,
+                                    [](int nHeight, const CAccumulatorCheckpoint &c) { return nHeight < c.block->nHeight; });
+    if (checkpointIt == checkpoints.begin())
+        return 0;
 
-        if (lastBlock == coinGroup.firstBlock)
-            break;
-        else
-            lastBlock = lastBlock->pprev;
+    --checkpointIt;
+    accumulator = checkpointIt->value;
+    blockHash = checkpointIt->block->GetBlockHash();
+    return checkpointIt->nCoins;
+}
+
+void CZerocoinState::GetAccumulatorValuesForSpend(int denomination, int id, const uint256 &accumulatorBlockHash, vector<CBigNum> &values) {
+    pair<int, int> denomAndId = pair<int, int>(denomination, id);
+
+    if (coinGroups.count(denomAndId) == 0)
+        return;
+
+    const vector<CAccumulatorCheckpoint> &checkpoints = GetCheckpoints(denomAndId);
+    if (accumulatorBlockHash.IsNull()) {
+        for (auto checkpointIt = checkpoints.rbegin(); checkpointIt != checkpoints.rend(); ++checkpointIt)
+            values.push_back(checkpointIt->value);
+        return;
     }
 
-    return numberOfCoins;
+    // The block must be one of the group's blocks, otherwise the first block of the group is used. A block of the
+    // group without mints of the group gives no value at all
+    const CoinGroupInfo &coinGroup = coinGroups[denomAndId];
+    const CBlockIndex *block = coinGroup.firstBlock;
+    BlockMap::const_iterator mi = mapBlockIndex.find(accumulatorBlockHash);
+    if (mi != mapBlockIndex.end()) {
+        const CBlockIndex *pindex = mi->second;
+        if (pindex->nHeight >= coinGroup.firstBlock->nHeight && pindex->nHeight <= coinGroup.lastBlock->nHeight &&
+                coinGroup.lastBlock->GetAncestor(pindex->nHeight) == pindex)
+            block = pindex;
+    }
+
+    auto checkpointIt = FindAccumulatorCheckpoint(checkpoints, block);
+    if (checkpointIt != checkpoints.end())
+        values.push_back(checkpointIt->value);
 }
 
-libzerocoin::AccumulatorWitness CZerocoinState::GetWitnessForSpend(CChain *chain, int maxHeight, int denomination, int id, const CBigNum &pubCoin) {
-    libzerocoin::CoinDenomination d = (libzerocoin::CoinDenomination)denomination;
+void CZerocoinState::GetCoinGroupPubCoins(int denomination, int id, vector<CBigNum> &pubCoins) {
     pair<int, int> denomAndId = pair<int, int>(denomination, id);
 
-    assert(coinGroups.count(denomAndId) > 0);
+    if (coinGroups.count(denomAndId) == 0)
+        return;
 
-    CoinGroupInfo coinGroup = coinGroups[denomAndId];
+    BOOST_FOREACH(const CAccumulatorCheckpoint &checkpoint, GetCheckpoints(denomAndId)) {
+        std::shared_ptr<const CZerocoinBlockInfo> info = ZerocoinGetBlockInfo(checkpoint.block);
+        const vector<CBigNum> &blockPubCoins = info->mintedPubCoins.at(denomAndId);
+        pubCoins.insert(pubCoins.end(), blockPubCoins.cbegin(), blockPubCoins.cend());
+    }
+}
 
-    int coinId;
-    int mintHeight = GetMintedCoinHeightAndId(pubCoin, denomination, coinId);
+bool CZerocoinState::AdvanceWitness(int maxHeight, int denomination, int id, const CBigNum &pubCoin, CBigNum &witnessValue, uint256 &witnessBlockHash) {
+    CWitnessUpdate update;
+    if (!PrepareWitnessUpdate(maxHeight, denomination, id, pubCoin, witnessValue, witnessBlockHash, update))
+        return false;
+    witnessValue = ApplyWitnessUpdate(update);
+    witnessBlockHash = update.blockHash;
+    return true;
+}
 
-    assert(coinId == id);
+bool CZerocoinState::PrepareWitnessUpdate(int maxHeight, int denomination, int id, const CBigNum &pubCoin, const CBigNum &witnessValue,
+                                          const uint256 &witnessBlockHash, CWitnessUpdate &update) {
+    libzerocoin::CoinDenomination d = (libzerocoin::CoinDenomination)denomination;
+    pair<int, int> denomAndId = pair<int, int>(denomination, id);
 
-    // Find accumulator value preceding mint operation
-    CBlockIndex *mintBlock = (*chain)[mintHeight];
-    CBlockIndex *block = mintBlock;
-    libzerocoin::Accumulator accumulator(ZCParams, d);
-    if (block != coinGroup.firstBlock) {
-        do {
-            block = block->pprev;
-        } while (block->accumulatorChanges.count(denomAndId) == 0);
-        accumulator = libzerocoin::Accumulator(ZCParams, block->accumulatorChanges[denomAndId].first, d);
+    if (coinGroups.count(denomAndId) == 0)
+        return false;
+
+    const vector<CAccumulatorCheckpoint> &checkpoints = GetCheckpoints(denomAndId);
+    auto checkpointIt = checkpoints.cend();
+    if (!witnessBlockHash.IsNull()) {
+        BlockMap::const_iterator mi = mapBlockIndex.find(witnessBlockHash);
+        if (mi != mapBlockIndex.end())
+            checkpointIt = FindAccumulatorCheckpoint(checkpoints, mi->second);
+    }
+
+    update.denomination = denomination;
+    update.pubCoins.clear();
+    auto mintCheckpointIt = checkpoints.cend();
+    if (checkpointIt != checkpoints.cend() && checkpointIt->block->nHeight <= maxHeight) {
+        // only coins of the blocks after the witness are missing
+        update.startValue = witnessValue;
+        update.blockHash = witnessBlockHash;
+        ++checkpointIt;
+    }
+    else {
+        // start from the accumulator value preceding mint operation
+        int coinId;
+        int mintHeight = GetMintedCoinHeightAndId(pubCoin, denomination, coinId);
+        if (mintHeight < 0 || coinId != id)
+            return false;
+
+        mintCheckpointIt = lower_bound(checkpoints.cbegin(), checkpoints.cend(), mintHeight,
+                                       [](const CAccumulatorCheckpoint &c, int nHeight) { return c.block->nHeight < nHeight; });
+        assert(mintCheckpointIt != checkpoints.cend() && mintCheckpointIt->block->nHeight == mintHeight);
+        if (mintCheckpointIt != checkpoints.cbegin())
+            update.startValue = (mintCheckpointIt - 1)->value;
+        else
+            update.startValue = libzerocoin::Accumulator(ZerocoinParams(), d).getValue();
+        checkpointIt = mintCheckpointIt;
+        update.blockHash.SetNull();
     }
 
     // Now add to the accumulator every coin minted since that moment except pubCoin
-    block = coinGroup.lastBlock;
-    while(true) {
-        if (block->nHeight <= maxHeight && block->mintedPubCoins.count(denomAndId) > 0) {
-            vector<CBigNum> &pubCoins = block->mintedPubCoins[denomAndId];
-            for (const CBigNum &coin: pubCoins) {
-                if (block != mintBlock || coin != pubCoin)
-                    accumulator += libzerocoin::PublicCoin(ZCParams, coin, d);
-            }
+    for (; checkpointIt != checkpoints.cend() && checkpointIt->block->nHeight <= maxHeight; ++checkpointIt) {
+        std::shared_ptr<const CZerocoinBlockInfo> info = ZerocoinGetBlockInfo(checkpointIt->block);
+        const vector<CBigNum> &pubCoins = info->mintedPubCoins.at(denomAndId);
+        for (const CBigNum &coin: pubCoins) {
+            if (checkpointIt != mintCheckpointIt || coin != pubCoin)
+                update.pubCoins.push_back(coin);
         }
-        if (block != mintBlock)
-            block = block->pprev;
-        else
-            break;
+        update.blockHash = checkpointIt->block->GetBlockHash();
     }
 
-    return libzerocoin::AccumulatorWitness(ZCParams, accumulator, libzerocoin::PublicCoin(ZCParams, pubCoin, d));
+    return true;
+}
+
+CBigNum CZerocoinState::ApplyWitnessUpdate(const CWitnessUpdate &update) {
+    libzerocoin::CoinDenomination d = (libzerocoin::CoinDenomination)update.denomination;
+    libzerocoin::Accumulator accumulator(ZerocoinParams(), update.startValue, d);
+    for (const CBigNum &coin: update.pubCoins)
+        accumulator += libzerocoin::PublicCoin(ZerocoinParams(), coin, d);
+    return accumulator.getValue();
+}
+
+libzerocoin::AccumulatorWitness CZerocoinState::GetWitnessForSpend(int maxHeight, int denomination, int id, const CBigNum &pubCoin) {
+    libzerocoin::CoinDenomination d = (libzerocoin::CoinDenomination)denomination;
+
+    CBigNum witnessValue;
+    uint256 witnessBlockHash;
+    bool fWitness = AdvanceWitness(maxHeight, denomination, id, pubCoin, witnessValue, witnessBlockHash);
+    assert(fWitness);
+
+    return libzerocoin::AccumulatorWitness(ZerocoinParams(), libzerocoin::Accumulator(ZerocoinParams(), witnessValue, d),
+                                           libzerocoin::PublicCoin(ZerocoinParams(), pubCoin, d));
 }
 
 int CZerocoinState::GetMintedCoinHeightAndId(const CBigNum &pubCoin, int denomination, int &id) {
-    auto coins = mintedPubCoins.equal_range(pubCoin);
-    auto coinIt = find_if(coins.first, coins.second,
-                          [=](const decltype(mintedPubCoins)::value_type &v) { return v.second.denomination == denomination; });
+    const CMintedCoinsEntry *entry = FindMintedCoins(pubCoin);
+    if (entry == NULL)
+        return -1;
+
+    const vector<CMintedCoinInfo> &coins = entry->coins;
+    auto coinIt = find_if(coins.begin(), coins.end(),
+                          [=](const CMintedCoinInfo &v) { return v.denomination == denomination; });
 
-    if (coinIt != mintedPubCoins.end()) {
-        id = coinIt->second.id;
-        return coinIt->second.nHeight;
+    if (coinIt != coins.end()) {
+        id = coinIt->id;
+        return coinIt->nHeight;
     }
     else
         return -1;
@@ -822,11 +1178,312 @@ int CZerocoinState::GetMintedCoinHeightAndId(const CBigNum &pubCoin, int denomin
 
 void CZerocoinState::Reset() {
     coinGroups.clear();
+    dirtyCoinGroups.clear();
     usedCoinSerials.clear();
     mintedPubCoins.clear();
     latestCoinIds.clear();
+    accumulatorCheckpoints.clear();
+}
+
+vector<CZerocoinState::CAccumulatorCheckpoint> &CZerocoinState::GetCheckpoints(const pair<int, int> &denomAndId) {
+    auto checkpointsIt = accumulatorCheckpoints.find(denomAndId);
+    if (checkpointsIt != accumulatorCheckpoints.end())
+        return checkpointsIt->second;
+
+    // walk the blocks of the group once, the checkpoints are maintained incrementally afterwards
+    assert(coinGroups.count(denomAndId) > 0);
+    const CoinGroupInfo &coinGroup = coinGroups[denomAndId];
+    vector<CAccumulatorCheckpoint> &checkpoints = accumulatorCheckpoints[denomAndId];
+    for (CBlockIndex *block = coinGroup.lastBlock; ; block = block->pprev) {
+        std::shared_ptr<const CZerocoinBlockInfo> info = ZerocoinGetBlockInfo(block);
+        auto accChange = info->accumulatorChanges.find(denomAndId);
+        if (accChange != info->accumulatorChanges.end()) {
+            CAccumulatorCheckpoint checkpoint;
+            checkpoint.block = block;
+            checkpoint.value = accChange->second.first;
+            checkpoint.nCoins = accChange->second.second;
+            checkpoints.push_back(checkpoint);
+        }
+        if (block == coinGroup.firstBlock)
+            break;
+    }
+
+    reverse(checkpoints.begin(), checkpoints.end());
+    for (size_t i = 1; i < checkpoints.size(); i++)
+        checkpoints[i].nCoins += checkpoints[i-1].nCoins;
+
+    assert(!checkpoints.empty() && checkpoints.front().block == coinGroup.firstBlock && checkpoints.back().block == coinGroup.lastBlock);
+    return checkpoints;
+}
+
+CZerocoinState::CMintedCoinsEntry &CZerocoinState::FetchMintedCoins(const CBigNum &pubCoin) {
+    auto it = mintedPubCoins.find(pubCoin);
+    if (it != mintedPubCoins.end())
+        return it->second;
+
+    CMintedCoinsEntry &entry = mintedPubCoins[pubCoin];
+    if (pzerocoindb)
+        pzerocoindb->ReadMintedCoins(pubCoin, entry.coins);
+    return entry;
+}
+
+CZerocoinState::CCoinSerialEntry &CZerocoinState::FetchCoinSerial(const CBigNum &serial) {
+    auto it = usedCoinSerials.find(serial);
+    if (it != usedCoinSerials.end())
+        return it->second;
+
+    CCoinSerialEntry &entry = usedCoinSerials[serial];
+    if (pzerocoindb)
+        pzerocoindb->ReadCoinSerial(serial, entry.nSpends);
+    return entry;
+}
+
+const CZerocoinState::CMintedCoinsEntry *CZerocoinState::FindMintedCoins(const CBigNum &pubCoin) {
+    auto it = mintedPubCoins.find(pubCoin);
+    if (it != mintedPubCoins.end())
+        return &it->second;
+
+    vector<CMintedCoinInfo> coins;
+    if (!pzerocoindb || !pzerocoindb->ReadMintedCoins(pubCoin, coins))
+        return NULL;
+    CMintedCoinsEntry &entry = mintedPubCoins[pubCoin];
+    entry.coins.swap(coins);
+    return &entry;
+}
+
+const CZerocoinState::CCoinSerialEntry *CZerocoinState::FindCoinSerial(const CBigNum &serial) {
+    auto it = usedCoinSerials.find(serial);
+    if (it != usedCoinSerials.end())
+        return &it->second;
+
+    int nSpends = 0;
+    if (!pzerocoindb || !pzerocoindb->ReadCoinSerial(serial, nSpends))
+        return NULL;
+    CCoinSerialEntry &entry = usedCoinSerials[serial];
+    entry.nSpends = nSpends;
+    return &entry;
+}
+
+bool CZerocoinState::Load() {
+    Reset();
+    if (!pzerocoindb || !pzerocoindb->LoadCoinGroups(coinGroups)) {
+        Reset();
+        return false;
+    }
+
+    // groups are ordered by id within a denomination and ids of a denomination have no gaps
+    BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(int,int), CoinGroupInfo) &coinGroup, coinGroups)
+        latestCoinIds[coinGroup.first.first] = coinGroup.first.second;
+    return true;
+}
+
+bool CZerocoinState::Flush(const uint256 &hashBlock) {
+    if (!pzerocoindb)
+        return true;
+
+    CDBBatch batch(*pzerocoindb);
+    size_t changed = 0;
+    for (auto it = mintedPubCoins.cbegin(); it != mintedPubCoins.cend(); ++it) {
+        if (it->second.fDirty) {
+            if (it->second.coins.empty())
+                batch.Erase(make_pair(DB_ZC_MINT, it->first));
+            else
+                batch.Write(make_pair(DB_ZC_MINT, it->first), it->second.coins);
+            changed++;
+        }
+    }
+    for (auto it = usedCoinSerials.cbegin(); it != usedCoinSerials.cend(); ++it) {
+        if (it->second.fDirty) {
+            if (it->second.nSpends == 0)
+                batch.Erase(make_pair(DB_ZC_SERIAL, it->first));
+            else
+                batch.Write(make_pair(DB_ZC_SERIAL, it->first), it->second.nSpends);
+            changed++;
+        }
+    }
+    BOOST_FOREACH(const PAIRTYPE(int,int) &denomAndId, dirtyCoinGroups) {
+        auto it = coinGroups.find(denomAndId);
+        if (it == coinGroups.end())
+            batch.Erase(make_pair(DB_ZC_GROUP, denomAndId));
+        else
+            batch.Write(make_pair(DB_ZC_GROUP, denomAndId), CDiskCoinGroupInfo(it->second));
+    }
+    batch.Write(DB_ZC_BEST_BLOCK, hashBlock);
+
+    LogPrint("zerocoin", "Committing %u changed coins and serials, %u coin groups to zerocoin database...\n",
+             (unsigned int)changed, (unsigned int)dirtyCoinGroups.size());
+    if (!pzerocoindb->WriteBatch(batch))
+        return false;
+
+    mintedPubCoins.clear();
+    usedCoinSerials.clear();
+    dirtyCoinGroups.clear();
+    return true;
 }
 
 CZerocoinState *CZerocoinState::GetZerocoinState() {
     return &zerocoinState;
 }
+
+// CZerocoinBlockInfoCache
+
+void CZerocoinBlockInfoCache::AddToLRU(const CBlockIndex *pindex, const InfoPtr &info) {
+    auto it = lruIndex.find(pindex);
+    if (it != lruIndex.end()) {
+        lruList.erase(it->second);
+        lruIndex.erase(it);
+    }
+    lruList.push_front(make_pair(pindex, info));
+    lruIndex[pindex] = lruList.begin();
+    while (lruList.size() > nMaxSize) {
+        lruIndex.erase(lruList.back().first);
+        lruList.pop_back();
+    }
+}
+
+CZerocoinBlockInfoCache::InfoPtr CZerocoinBlockInfoCache::Get(const CBlockIndex *pindex) {
+    static const InfoPtr emptyInfo = std::make_shared<const CZerocoinBlockInfo>();
+    // most blocks have no zerocoin transactions and never touch the cache
+    if (!(pindex->nStatus & BLOCK_HAVE_ZEROCOIN))
+        return emptyInfo;
+
+    LOCK(cs);
+    auto dirtyIt = mapDirty.find(const_cast<CBlockIndex*>(pindex));
+    if (dirtyIt != mapDirty.end())
+        return dirtyIt->second;
+
+    auto it = lruIndex.find(pindex);
+    if (it != lruIndex.end()) {
+        lruList.splice(lruList.begin(), lruList, it->second);
+        return it->second->second;
+    }
+
+    std::shared_ptr<CZerocoinBlockInfo> info = std::make_shared<CZerocoinBlockInfo>();
+    if (!pblocktree || !pblocktree->ReadZerocoinBlockInfo(pindex->GetBlockHash(), *info)) {
+        uiInterface.ThreadSafeMessageBox(_("Error reading from database, shutting down."), "",
+                                         CClientUIInterface::MSG_ERROR);
+        LogPrintf("CZerocoinBlockInfoCache::Get: failed to read zerocoin data of block %s\n", pindex->GetBlockHash().ToString());
+        // Returning the empty info would pass the block off as one without mints or spends, exit
+        // instead like CCoinsViewErrorCatcher does on coins database errors
+        abort();
+    }
+    AddToLRU(pindex, info);
+    return info;
+}
+
+void CZerocoinBlockInfoCache::Set(CBlockIndex *pindex, const CZerocoinBlockInfo &info) {
+    LOCK(cs);
+    if (info.IsNull()) {
+        if (!(pindex->nStatus & BLOCK_HAVE_ZEROCOIN))
+            return;
+        pindex->nStatus &= ~BLOCK_HAVE_ZEROCOIN;
+    }
+    else {
+        pindex->nStatus |= BLOCK_HAVE_ZEROCOIN;
+    }
+
+    auto it = lruIndex.find(pindex);
+    if (it != lruIndex.end()) {
+        lruList.erase(it->second);
+        lruIndex.erase(it);
+    }
+    mapDirty[pindex] = std::make_shared<const CZerocoinBlockInfo>(info);
+}
+
+void CZerocoinBlockInfoCache::TakeDirty(vector<pair<CBlockIndex*, InfoPtr> > &dirty) {
+    LOCK(cs);
+    BOOST_FOREACH(const PAIRTYPE(CBlockIndex*, InfoPtr) &item, mapDirty) {
+        dirty.push_back(item);
+        if (!item.second->IsNull())
+            AddToLRU(item.first, item.second);
+    }
+    mapDirty.clear();
+}
+
+void CZerocoinBlockInfoCache::Clear() {
+    LOCK(cs);
+    mapDirty.clear();
+    lruList.clear();
+    lruIndex.clear();
+}
+
+std::shared_ptr<const CZerocoinBlockInfo> ZerocoinGetBlockInfo(const CBlockIndex *pindex) {
+    return zerocoinBlockInfo.Get(pindex);
+}
+
+void ZerocoinSetBlockInfo(CBlockIndex *pindex, const CZerocoinBlockInfo &info) {
+    zerocoinBlockInfo.Set(pindex, info);
+}
+
+void ZerocoinTakeDirtyBlockInfo(vector<pair<CBlockIndex*, std::shared_ptr<const CZerocoinBlockInfo> > > &dirty) {
+    zerocoinBlockInfo.TakeDirty(dirty);
+}
+
+void ZerocoinUnloadBlockInfo() {
+    zerocoinBlockInfo.Clear();
+}
+
+// CZerocoinDB
+
+CZerocoinDB::CZerocoinDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "zerocoin", nCacheSize, fMemory, fWipe, true) {
+}
+
+bool CZerocoinDB::ReadBestBlock(uint256 &hashBlock) {
+    return Read(DB_ZC_BEST_BLOCK, hashBlock);
+}
+
+bool CZerocoinDB::ReadMintedCoins(const CBigNum &pubCoin, vector<CZerocoinState::CMintedCoinInfo> &coins) {
+    return Read(make_pair(DB_ZC_MINT, pubCoin), coins);
+}
+
+bool CZerocoinDB::ReadCoinSerial(const CBigNum &serial, int &nSpends) {
+    return Read(make_pair(DB_ZC_SERIAL, serial), nSpends);
+}
+
+bool CZerocoinDB::LoadCoinGroups(map<pair<int,int>, CZerocoinState::CoinGroupInfo> &groups) {
+    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(make_pair(DB_ZC_GROUP, make_pair(0, 0)));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        pair<char, pair<int,int> > key;
+        if (!pcursor->GetKey(key) || key.first != DB_ZC_GROUP)
+            break;
+
+        CDiskCoinGroupInfo diskGroup;
+        if (!pcursor->GetValue(diskGroup))
+            return error("%s: failed to read coin group", __func__);
+
+        BlockMap::iterator first = mapBlockIndex.find(diskGroup.hashFirstBlock);
+        BlockMap::iterator last = mapBlockIndex.find(diskGroup.hashLastBlock);
+        if (first == mapBlockIndex.end() || last == mapBlockIndex.end())
+            return error("%s: coin group %d/%d refers to an unknown block", __func__, key.second.first, key.second.second);
+
+        CZerocoinState::CoinGroupInfo &group = groups[key.second];
+        group.firstBlock = first->second;
+        group.lastBlock = last->second;
+        group.nCoins = diskGroup.nCoins;
+        pcursor->Next();
+    }
+    return true;
+}
+
+template <typename K>
+static void EraseZerocoinRecords(CDBWrapper &db, CDBBatch &batch, char prefix) {
+    boost::scoped_ptr<CDBIterator> pcursor(db.NewIterator());
+    pcursor->Seek(prefix);
+    pair<char, K> key;
+    while (pcursor->Valid() && pcursor->GetKey(key) && key.first == prefix) {
+        batch.Erase(key);
+        pcursor->Next();
+    }
+}
+
+bool CZerocoinDB::Wipe() {
+    CDBBatch batch(*this);
+    EraseZerocoinRecords<CBigNum>(*this, batch, DB_ZC_MINT);
+    EraseZerocoinRecords<CBigNum>(*this, batch, DB_ZC_SERIAL);
+    EraseZerocoinRecords<pair<int,int> >(*this, batch, DB_ZC_GROUP);
+    batch.Erase(DB_ZC_BEST_BLOCK);
+    return WriteBatch(batch, true);
+}
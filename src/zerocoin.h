@@ -5,11 +5,18 @@
 #include "chain.h"
 #include "coins.h"
 #include "consensus/validation.h"
+#include "dbwrapper.h"
 #include "libzerocoin/Zerocoin.h"
+#include "libzerocoin/ParallelTasks.h"
+#include "script/sigcache.h"
 #include "zerocoin_params.h"
+#include "sync.h"
 #include <unordered_set>
 #include <unordered_map>
 #include <functional>
+#include <atomic>
+#include <list>
+#include <memory>
 
 // Test for zerocoin transaction version 2
 inline bool IsZerocoinTxV2(libzerocoin::CoinDenomination denomination, int coinId) {
@@ -53,21 +60,189 @@ public:
     void Complete();
 };
 
+//! Default for -zerocoinspendcachesize, maximum memory used by the verified spend cache in MiB
+static const unsigned int DEFAULT_ZEROCOIN_SPEND_CACHE_SIZE = 1;
+//! Default for -zcthreads, number of zerocoin proof threads, 0 = one per core
+static const int DEFAULT_ZEROCOIN_THREADS = 0;
+//! Maximum number of zerocoin proof threads allowed
+static const int MAX_ZEROCOIN_THREADS = 64;
+
+/** Snapshot of the verified spend cache counters, see getzerocoinspendcacheinfo */
+struct CZerocoinSpendCacheStats
+{
+    size_t nEntries;
+    size_t nUsage;
+    size_t nMaxUsage;
+    uint64_t nHits;
+    uint64_t nMisses;
+};
+
+/**
+ * Spend proofs known to verify, so that a spend proven when it entered the mempool is not proven
+ * again when the block containing it is checked
+ */
+class CZerocoinSpendCache : public CSaltedHashSet<>
+{
+private:
+    std::atomic<uint64_t> nHits;
+    std::atomic<uint64_t> nMisses;
+
+public:
+    CZerocoinSpendCache(size_t nMaxUsageIn = DEFAULT_ZEROCOIN_SPEND_CACHE_SIZE << 20);
+
+    /**
+     * Entry for the spend input nIn of transaction hashTx verified against an accumulator value,
+     * the proof itself is committed to by the transaction hash
+     */
+    uint256 ComputeEntry(const uint256 &hashTx, uint32_t nIn, int spendVersion, libzerocoin::CoinDenomination denomination,
+                         uint32_t pubcoinId, const uint256 &txHashForMetadata, const CBigNum &accumulatorValue) const;
+
+    // Hit and miss counters are updated by the caller, once per spend rather than per lookup
+    void CountLookup(bool fHit) { (fHit ? nHits : nMisses)++; }
+
+    CZerocoinSpendCacheStats GetStats() const;
+};
+
+/** Process-wide cache shared by mempool acceptance and block validation */
+extern CZerocoinSpendCache zerocoinSpendCache;
+
+//! Maximum memory used by the cache of public coins that passed the primality test
+static const size_t ZEROCOIN_VALID_COIN_CACHE_SIZE = 8 << 20;
+
+/**
+ * PublicCoin::validate() for coins of ZerocoinParams(), remembering the coins found to be prime so that a
+ * coin checked when it was minted by the wallet or accepted to the mempool goes through the Miller-Rabin
+ * rounds only once
+ */
+bool ZerocoinValidatePubCoin(const libzerocoin::PublicCoin &pubCoin);
+
+/**
+ * Closure verifying the proof of one zerocoin spend input. The accumulator values the spend may
+ * have been made against are collected from the index beforehand, so the check does not touch
+ * the block index or the zerocoin state and the checks of a block can be verified together by
+ * VerifyBatch() once all its transactions are checked.
+ */
+class CZerocoinSpendCheck
+{
+private:
+    std::shared_ptr<libzerocoin::CoinSpend> spend;
+    libzerocoin::CoinDenomination denomination;
+    uint32_t pubcoinId;
+    uint256 txHashForMetadata;
+    // accumulator values to verify against, most recent first
+    vector<CBigNum> accumulatorValues;
+    // all the coins of the group in the order of mint, for v1 spends only
+    vector<CBigNum> pubCoins;
+    int nHeight;
+    // transaction and input the spend comes from, null if the result is not to be cached
+    uint256 hashTx;
+    uint32_t nIn;
+
+    // Look up every accumulator value in zerocoinSpendCache
+    bool IsCached() const;
+    void SetCached(const CBigNum &accumulatorValue) const;
+    bool VerifyUncached(bool fCacheStore);
+
+public:
+    CZerocoinSpendCheck(): denomination(libzerocoin::ZQ_LOVELACE), pubcoinId(0), nHeight(0), nIn(0) {}
+    CZerocoinSpendCheck(const std::shared_ptr<libzerocoin::CoinSpend> &spendIn, libzerocoin::CoinDenomination denominationIn,
+                        uint32_t pubcoinIdIn, const uint256 &txHashForMetadataIn, int nHeightIn) :
+        spend(spendIn), denomination(denominationIn), pubcoinId(pubcoinIdIn), txHashForMetadata(txHashForMetadataIn),
+        nHeight(nHeightIn), nIn(0) {}
+
+    void AddAccumulatorValue(const CBigNum &value) { accumulatorValues.push_back(value); }
+    void SetPubCoins(const vector<CBigNum> &coins) { pubCoins = coins; }
+    void SetCacheKey(const uint256 &hashTxIn, uint32_t nInIn) { hashTx = hashTxIn; nIn = nInIn; }
+
+    bool operator()() { return Verify(false); }
+
+    /**
+     * Verifies the proof unless zerocoinSpendCache already has it for one of the accumulator values.
+     * With fCacheStore a proof that verifies against one of them is added to the cache.
+     */
+    bool Verify(bool fCacheStore);
+
+    /**
+     * Verifies the spends of a block or a transaction together. Every spend is first checked against
+     * its most recent accumulator value in one libzerocoin::BatchVerifier, the ones that fail there go
+     * through Verify() to try the older values. Spends in zerocoinSpendCache are skipped.
+     */
+    static bool VerifyBatch(vector<CZerocoinSpendCheck> &checks, bool fCacheStore = false);
+};
+
 bool CheckZerocoinFoundersInputs(const CTransaction &tx, CValidationState &state, int nHeight, bool fTestNet);
+/**
+ * If pvChecks is not NULL, the spend proofs are not verified but appended to pvChecks,
+ * while the serial number bookkeeping in zerocoinTxInfo is still done in place.
+ */
 bool CheckZerocoinTransaction(const CTransaction &tx,
 	CValidationState &state,
 	uint256 hashTx,
 	bool isVerifyDB,
 	int nHeight,
     bool isCheckWallet,
-    CZerocoinTxInfo *zerocoinTxInfo);
+    CZerocoinTxInfo *zerocoinTxInfo,
+    vector<CZerocoinSpendCheck> *pvChecks = NULL);
 
 void DisconnectTipZC(CBlock &block, CBlockIndex *pindexDelete);
 bool ConnectTipZC(CValidationState &state, const CChainParams &chainparams, CBlockIndex *pindexNew, const CBlock *pblock);
 
 int ZerocoinGetNHeight(const CBlockHeader &block);
 
+// Zerocoin params of the chain, shared by the whole process
+const libzerocoin::Params *ZerocoinParams();
+
 bool ZerocoinBuildStateFromIndex(CChain *chain);
+// Write the zerocoin state changes to the database, hashBlock is the block the state corresponds to
+bool ZerocoinFlushState(const uint256 &hashBlock);
+
+//! Max memory allocated to zerocoin state DB specific cache (MiB)
+static const int64_t nMaxZerocoinDBCache = 8;
+//! Number of decoded zerocoin block payloads kept in memory
+static const size_t nZerocoinBlockInfoCacheSize = 2000;
+
+/**
+ * Zerocoin payloads of the blocks. Blocks with BLOCK_HAVE_ZEROCOIN have theirs in the block tree database,
+ * read on demand and kept decoded in a LRU cache. Payloads set by ConnectTipZC stay in memory until
+ * FlushStateToDisk writes them together with the block index entries.
+ */
+class CZerocoinBlockInfoCache {
+public:
+    typedef std::shared_ptr<const CZerocoinBlockInfo> InfoPtr;
+
+private:
+    CCriticalSection cs;
+    size_t nMaxSize;
+    // payloads not written to the database yet
+    map<CBlockIndex*, InfoPtr> mapDirty;
+    // most recently used first
+    std::list<pair<const CBlockIndex*, InfoPtr> > lruList;
+    std::unordered_map<const CBlockIndex*, std::list<pair<const CBlockIndex*, InfoPtr> >::iterator> lruIndex;
+
+    void AddToLRU(const CBlockIndex *pindex, const InfoPtr &info);
+
+public:
+    CZerocoinBlockInfoCache(size_t nMaxSizeIn = nZerocoinBlockInfoCacheSize) : nMaxSize(nMaxSizeIn) {}
+
+    // Payload of the block, empty if it has none
+    InfoPtr Get(const CBlockIndex *pindex);
+    // Replace payload of the block, sets or clears BLOCK_HAVE_ZEROCOIN
+    void Set(CBlockIndex *pindex, const CZerocoinBlockInfo &info);
+    // Take the payloads to be written, these move to the LRU cache
+    void TakeDirty(vector<pair<CBlockIndex*, InfoPtr> > &dirty);
+    // Forget everything, block index entries are about to be deleted
+    void Clear();
+};
+
+// Zerocoin payload of the block, empty if the block has none
+std::shared_ptr<const CZerocoinBlockInfo> ZerocoinGetBlockInfo(const CBlockIndex *pindex);
+// Replace zerocoin payload of the block
+void ZerocoinSetBlockInfo(CBlockIndex *pindex, const CZerocoinBlockInfo &info);
+// Payloads changed since the last call, to be written to the block tree database
+void ZerocoinTakeDirtyBlockInfo(vector<pair<CBlockIndex*, std::shared_ptr<const CZerocoinBlockInfo> > > &dirty);
+void ZerocoinUnloadBlockInfo();
+
+class CZerocoinDB;
 
 /*
  * State of minted/spent coins as extracted from the index
@@ -86,26 +261,93 @@ public:
         int nCoins;
     };
 
-private:
-    // Custom hash for big numbers
-    struct CBigNumHash {
-        std::size_t operator()(const CBigNum &bn) const noexcept;
+    // Accumulator value of a coin group after the mints of one block
+    struct CAccumulatorCheckpoint {
+        CBlockIndex *block;
+        CBigNum value;
+        // number of coins of the group minted up to and including this block
+        int nCoins;
     };
 
+    // What advancing a witness takes: gathered from the state under cs_main, the accumulator arithmetic can
+    // then be done without it by ApplyWitnessUpdate
+    struct CWitnessUpdate {
+        int denomination;
+        CBigNum startValue;
+        // coins to add to startValue, in order
+        vector<CBigNum> pubCoins;
+        // block of the accumulator value the witness is for once the coins are added
+        uint256 blockHash;
+    };
+
+    // Height and id of a minted coin
     struct CMintedCoinInfo {
         int         denomination;
         int         id;
         int         nHeight;
+
+        ADD_SERIALIZE_METHODS;
+
+        template <typename Stream, typename Operation>
+        inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+            READWRITE(denomination);
+            READWRITE(id);
+            READWRITE(nHeight);
+        }
+    };
+
+    // Salted hash of a coin or serial for the caches keyed by them: SipHash of the number reduced modulo a
+    // random 32-bit word. The reduction reads the number in place, hashing doesn't allocate or serialize.
+    // The caches are keyed by the number rather than a digest of it, which cost more per lookup than it saved
+    class CBigNumHasher {
+    private:
+        const uint64_t k0, k1;
+        const uint32_t nModulus;
+
+    public:
+        CBigNumHasher();
+        size_t operator()(const CBigNum &bn) const;
+    };
+
+private:
+    // Cached database entries. Entries are dirty if changed since the last flush, an empty entry is an
+    // erased record
+    struct CMintedCoinsEntry {
+        CMintedCoinsEntry() : fDirty(false) {}
+        vector<CMintedCoinInfo> coins;
+        bool fDirty;
     };
 
-    // Collection of coin groups. Map from <denomination,id> to CoinGroupInfo structure
+    struct CCoinSerialEntry {
+        CCoinSerialEntry() : nSpends(0), fDirty(false) {}
+        int nSpends;
+        bool fDirty;
+    };
+
+    // Collection of coin groups. Map from <denomination,id> to CoinGroupInfo structure. Always fully in memory
     map<pair<int, int>, CoinGroupInfo> coinGroups;
-    // Set of all used coin serials. Allows multiple entries for the same coin serial for historical reasons
-    unordered_multiset<CBigNum,CBigNumHash> usedCoinSerials;
-    // Set of all minted pubCoin values
-    unordered_multimap<CBigNum,CMintedCoinInfo,CBigNumHash> mintedPubCoins;
+    // Coin groups changed since the last flush
+    set<pair<int, int> > dirtyCoinGroups;
+    // Used coin serials with the number of times they were spent. Allows multiple spends of the same coin
+    // serial for historical reasons
+    unordered_map<CBigNum,CCoinSerialEntry,CBigNumHasher> usedCoinSerials;
+    // Minted pubCoin values
+    unordered_map<CBigNum,CMintedCoinsEntry,CBigNumHasher> mintedPubCoins;
     // Latest IDs of coins by denomination
     map<int, int> latestCoinIds;
+    // Accumulator checkpoints of coin groups ordered by height. Built from the block index on first use
+    // and kept up to date from then on
+    map<pair<int, int>, vector<CAccumulatorCheckpoint> > accumulatorCheckpoints;
+
+    vector<CAccumulatorCheckpoint> &GetCheckpoints(const pair<int, int> &denomAndId);
+
+    // Look up an entry in the cache, reading it from pzerocoindb on a miss
+    CMintedCoinsEntry &FetchMintedCoins(const CBigNum &pubCoin);
+    CCoinSerialEntry &FetchCoinSerial(const CBigNum &serial);
+    // Same for lookups that don't change the entry but only entries found in pzerocoindb are cached, looking
+    // up unknown coins and serials doesn't grow the cache. NULL if there is no such entry
+    const CMintedCoinsEntry *FindMintedCoins(const CBigNum &pubCoin);
+    const CCoinSerialEntry *FindCoinSerial(const CBigNum &serial);
 
 public:
     CZerocoinState();
@@ -114,6 +356,8 @@ public:
     int AddMint(CBlockIndex *index, int denomination, const CBigNum &pubCoin, CBigNum &previousAccValue);
     // Add serial to the list of used ones
     void AddSpend(const CBigNum &serial);
+    // Record accumulator values of the block once its mints are added
+    void AddAccumulatorChanges(CBlockIndex *index, const CZerocoinBlockInfo &info);
 
     // Add everything from the block to the state
     void AddBlock(CBlockIndex *index);
@@ -133,8 +377,26 @@ public:
     // Returns number of coins satisfying conditions
     int GetAccumulatorValueForSpend(int maxHeight, int denomination, int id, CBigNum &accumulator, uint256 &blockHash);
 
+    // Accumulator values a spend from the group may have been made against, most recent first. If
+    // accumulatorBlockHash is not null only the value at that block (or at the first block of the group
+    // if the hash is not one of the group's blocks) is returned
+    void GetAccumulatorValuesForSpend(int denomination, int id, const uint256 &accumulatorBlockHash, vector<CBigNum> &values);
+
+    // All the coins of the group in the order of mint
+    void GetCoinGroupPubCoins(int denomination, int id, vector<CBigNum> &pubCoins);
+
+    // Bring the witness of pubCoin up to the latest accumulator value at or below maxHeight. witnessBlockHash is the
+    // block of the accumulator value witnessValue was made for, a witness for a block that is not in the group any
+    // more (or is above maxHeight) is made anew from the mint. Returns false if the coin is not in the group
+    bool AdvanceWitness(int maxHeight, int denomination, int id, const CBigNum &pubCoin, CBigNum &witnessValue, uint256 &witnessBlockHash);
+
+    // AdvanceWitness in two steps, only the first one reads the state
+    bool PrepareWitnessUpdate(int maxHeight, int denomination, int id, const CBigNum &pubCoin, const CBigNum &witnessValue,
+                              const uint256 &witnessBlockHash, CWitnessUpdate &update);
+    static CBigNum ApplyWitnessUpdate(const CWitnessUpdate &update);
+
     // Get witness
-    libzerocoin::AccumulatorWitness GetWitnessForSpend(CChain *chain, int maxHeight, int denomination, int id, const CBigNum &pubCoin);
+    libzerocoin::AccumulatorWitness GetWitnessForSpend(int maxHeight, int denomination, int id, const CBigNum &pubCoin);
 
     // Return height of mint transaction and id of minted coin
     int GetMintedCoinHeightAndId(const CBigNum &pubCoin, int denomination, int &id);
@@ -142,7 +404,31 @@ public:
     // Reset to initial values
     void Reset();
 
+    // Read coin groups from pzerocoindb, the rest of the state is read on demand
+    bool Load();
+    // Write changes to pzerocoindb and drop the cached entries
+    bool Flush(const uint256 &hashBlock);
+
     static CZerocoinState *GetZerocoinState();
 };
 
+/** Access to the zerocoin state database (zerocoin/) */
+class CZerocoinDB : public CDBWrapper
+{
+public:
+    CZerocoinDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+private:
+    CZerocoinDB(const CZerocoinDB&);
+    void operator=(const CZerocoinDB&);
+public:
+    bool ReadBestBlock(uint256 &hashBlock);
+    bool ReadMintedCoins(const CBigNum &pubCoin, vector<CZerocoinState::CMintedCoinInfo> &coins);
+    bool ReadCoinSerial(const CBigNum &serial, int &nSpends);
+    bool LoadCoinGroups(map<pair<int,int>, CZerocoinState::CoinGroupInfo> &groups);
+    // Erase all the records, used when the state has to be rebuilt from the block index
+    bool Wipe();
+};
+
+extern CZerocoinDB *pzerocoindb;
+
 #endif
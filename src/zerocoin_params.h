@@ -40,6 +40,9 @@ static const int64_t DUST_HARD_LIMIT = 1000;   // 0.00001 ZRO mininput
 
 // Version of index that introduced storing accumulators and coin serials
 #define ZC_ADVANCED_INDEX_VERSION           130500
+// Version of index that introduced storing the proof-of-work hash of each header
+#define POW_HASH_INDEX_VERSION              130506
+#define ZC_BLOCK_INFO_INDEX_VERSION         130507
 // Version of wallet.db entry that introduced storing extra information for mints
 #define ZC_ADVANCED_WALLETDB_MINT_VERSION	130504
 
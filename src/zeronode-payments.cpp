@@ -9,6 +9,7 @@
 #include "zeronodeman.h"
 #include "netfulfilledman.h"
 #include "spork.h"
+#include "txdb.h"
 #include "util.h"
 
 #include <boost/lexical_cast.hpp>
@@ -16,6 +17,9 @@
 /** Object for who's going to get paid on which blocks */
 CZeronodePayments mnpayments;
 
+/** Zeronode payments made by the blocks */
+CCoinbasePayeeIndex coinbasePayeeIndex;
+
 CCriticalSection cs_vecPayees;
 CCriticalSection cs_mapZeronodeBlocks;
 CCriticalSection cs_mapZeronodePaymentVotes;
@@ -374,9 +378,7 @@ void CZeronodePayments::ProcessMessage(CNode *pfrom, std::string &strCommand, CD
 
 bool CZeronodePaymentVote::Sign() {
     std::string strError;
-    std::string strMessage = vinZeronode.prevout.ToStringShort() +
-                             boost::lexical_cast<std::string>(nBlockHeight) +
-                             ScriptToAsmStr(payee);
+    std::string strMessage = GetSignatureMessage();
 
     if (!darkSendSigner.SignMessage(strMessage, vchSig, activeZeronode.keyZeronode)) {
         LogPrintf("CZeronodePaymentVote::Sign -- SignMessage() failed\n");
@@ -447,6 +449,11 @@ bool CZeronodePayments::HasVerifiedPaymentVote(uint256 hashIn) {
     return it != mapZeronodePaymentVotes.end() && it->second.IsVerified();
 }
 
+bool CZeronodePayments::HasPaymentVote(uint256 hashIn) {
+    LOCK(cs_mapZeronodePaymentVotes);
+    return mapZeronodePaymentVotes.count(hashIn);
+}
+
 void CZeronodeBlockPayees::AddPayee(const CZeronodePaymentVote &vote) {
     LOCK(cs_vecPayees);
 
@@ -743,9 +750,7 @@ bool CZeronodePaymentVote::CheckSignature(const CPubKey &pubKeyZeronode, int nVa
     // do not ban by default
     nDos = 0;
 
-    std::string strMessage = vinZeronode.prevout.ToStringShort() +
-                             boost::lexical_cast<std::string>(nBlockHeight) +
-                             ScriptToAsmStr(payee);
+    std::string strMessage = GetSignatureMessage();
 
     std::string strError = "";
     if (!darkSendSigner.VerifyMessage(pubKeyZeronode, vchSig, strMessage, strError)) {
@@ -761,6 +766,12 @@ bool CZeronodePaymentVote::CheckSignature(const CPubKey &pubKeyZeronode, int nVa
     return true;
 }
 
+std::string CZeronodePaymentVote::GetSignatureMessage() const {
+    return vinZeronode.prevout.ToStringShort() +
+           boost::lexical_cast<std::string>(nBlockHeight) +
+           ScriptToAsmStr(payee);
+}
+
 std::string CZeronodePaymentVote::ToString() const {
     std::ostringstream info;
 
@@ -904,3 +915,91 @@ void CZeronodePayments::UpdatedBlockTip(const CBlockIndex *pindex) {
     
     ProcessBlock(pindex->nHeight + 5);
 }
+
+CCoinbasePayees::CCoinbasePayees(const CBlock& block, int nHeight) :
+    hashBlock(block.GetHash()),
+    vecPayees()
+{
+    CAmount nZeronodePayment = GetZeronodePayment(nHeight, block.vtx[0].GetValueOut());
+    BOOST_FOREACH(const CTxOut& txout, block.vtx[0].vout) {
+        if (txout.nValue == nZeronodePayment)
+            vecPayees.push_back(txout);
+    }
+}
+
+void CCoinbasePayeeIndex::AddRecent(int nHeight, const CCoinbasePayees& payees) {
+    if (nHeight <= nBestHeight - RECENT_BLOCKS)
+        return;
+    mapRecent[nHeight] = payees;
+}
+
+void CCoinbasePayeeIndex::SetPrunedHeight(int nHeight) {
+    LOCK(cs);
+    nPrunedHeight = nHeight;
+}
+
+void CCoinbasePayeeIndex::BlockConnected(const CBlock& block, const CBlockIndex* pindex) {
+    CCoinbasePayees payees(block, pindex->nHeight);
+    // UpdateLastPaid doesn't scan further back than the storage limit
+    int nPruneHeight = pindex->nHeight - mnpayments.GetStorageLimit();
+
+    LOCK(cs);
+    nBestHeight = pindex->nHeight;
+    mapRecent.erase(mapRecent.begin(), mapRecent.lower_bound(nBestHeight - RECENT_BLOCKS + 1));
+    AddRecent(pindex->nHeight, payees);
+    mapDirty[payees.hashBlock] = payees;
+
+    // without a stored pruned height the index is new and holds nothing older
+    if (nPrunedHeight < 0)
+        nPrunedHeight = std::max(nPruneHeight - 1, -1);
+    while (nPrunedHeight < nPruneHeight) {
+        nPrunedHeight++;
+        mapDirty[pindex->GetAncestor(nPrunedHeight)->GetBlockHash()] = CCoinbasePayees();
+    }
+}
+
+void CCoinbasePayeeIndex::BlockDisconnected(const CBlockIndex* pindex) {
+    LOCK(cs);
+    std::map<int, CCoinbasePayees>::iterator it = mapRecent.find(pindex->nHeight);
+    if (it != mapRecent.end() && it->second.hashBlock == pindex->GetBlockHash())
+        mapRecent.erase(it);
+    mapDirty[pindex->GetBlockHash()] = CCoinbasePayees();
+}
+
+bool CCoinbasePayeeIndex::Get(const CBlockIndex* pindex, CCoinbasePayees& payeesRet) {
+    {
+        LOCK(cs);
+        std::map<int, CCoinbasePayees>::const_iterator it = mapRecent.find(pindex->nHeight);
+        if (it != mapRecent.end() && it->second.hashBlock == pindex->GetBlockHash()) {
+            payeesRet = it->second;
+            return true;
+        }
+    }
+
+    if (!pblocktree->ReadCoinbasePayees(pindex->GetBlockHash(), payeesRet)) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+            LogPrintf("CCoinbasePayeeIndex::Get -- ReadBlockFromDisk failed, nHeight=%d\n", pindex->nHeight);
+            return false;
+        }
+        payeesRet = CCoinbasePayees(block, pindex->nHeight);
+        LOCK(cs);
+        // keep it only where pruning will reach it, the pruned height is known once a block is connected
+        if (nPrunedHeight >= 0 && pindex->nHeight > nPrunedHeight)
+            mapDirty[payeesRet.hashBlock] = payeesRet;
+    }
+
+    LOCK(cs);
+    AddRecent(pindex->nHeight, payeesRet);
+    return true;
+}
+
+void CCoinbasePayeeIndex::TakeDirty(std::vector<std::pair<uint256, CCoinbasePayees> >& dirty, int& nPrunedHeightRet) {
+    LOCK(cs);
+    nPrunedHeightRet = nPrunedHeight;
+    dirty.reserve(dirty.size() + mapDirty.size());
+    BOOST_FOREACH(const PAIRTYPE(uint256, CCoinbasePayees)& item, mapDirty) {
+        dirty.push_back(item);
+    }
+    mapDirty.clear();
+}
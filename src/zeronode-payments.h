@@ -150,6 +150,7 @@ public:
 
     bool Sign();
     bool CheckSignature(const CPubKey& pubKeyZeronode, int nValidationHeight, int &nDos);
+    std::string GetSignatureMessage() const;
 
     bool IsValid(CNode* pnode, int nValidationHeight, std::string& strError);
     void Relay();
@@ -160,6 +161,75 @@ public:
     std::string ToString() const;
 };
 
+//
+// Zeronode payments made by the coinbase of a block
+//
+
+class CCoinbasePayees
+{
+public:
+    uint256 hashBlock;
+    // coinbase outputs paying exactly the zeronode payment of the block
+    std::vector<CTxOut> vecPayees;
+
+    CCoinbasePayees() :
+        hashBlock(),
+        vecPayees()
+        {}
+
+    CCoinbasePayees(const CBlock& block, int nHeight);
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+        READWRITE(hashBlock);
+        READWRITE(vecPayees);
+    }
+};
+
+//
+// Coinbase Payee Index
+// Keeps the zeronode payments of connected blocks in the block tree db and the recent ones in memory,
+// so that the last paid blocks of zeronodes are found without reading blocks from disk. Records are
+// written along with the block index and only kept for the blocks payments are looked up in
+//
+
+class CCoinbasePayeeIndex
+{
+private:
+    // recent blocks of the active chain are kept in memory
+    static const int RECENT_BLOCKS = 10000;
+
+    CCriticalSection cs;
+    // by height, an entry is only valid for the block with its hash
+    std::map<int, CCoinbasePayees> mapRecent;
+    int nBestHeight;
+    // records to write with the block index by block hash, null ones are to be erased
+    std::map<uint256, CCoinbasePayees> mapDirty;
+    // records of the active chain up to this height have been erased, -1 if not known
+    int nPrunedHeight;
+
+    void AddRecent(int nHeight, const CCoinbasePayees& payees);
+
+public:
+    CCoinbasePayeeIndex() : nBestHeight(0), nPrunedHeight(-1) {}
+
+    // pruned height stored with the block index, read when the block index is loaded
+    void SetPrunedHeight(int nHeight);
+    // add a block connected to the active chain, the records of blocks older than the payments storage
+    // limit are dropped
+    void BlockConnected(const CBlock& block, const CBlockIndex* pindex);
+    // drop the record of a block disconnected from the active chain
+    void BlockDisconnected(const CBlockIndex* pindex);
+    // payments of the given block, blocks connected before the index existed are read from disk once
+    bool Get(const CBlockIndex* pindex, CCoinbasePayees& payeesRet);
+    // records changed since the last call and the pruned height, for FlushStateToDisk to write with the block index
+    void TakeDirty(std::vector<std::pair<uint256, CCoinbasePayees> >& dirty, int& nPrunedHeightRet);
+};
+
+extern CCoinbasePayeeIndex coinbasePayeeIndex;
+
 //
 // Zeronode Payments Class
 // Keeps track of who should get paid for which blocks
@@ -195,6 +265,7 @@ public:
 
     bool AddPaymentVote(const CZeronodePaymentVote& vote);
     bool HasVerifiedPaymentVote(uint256 hashIn);
+    bool HasPaymentVote(uint256 hashIn);
     bool ProcessBlock(int nBlockHeight);
 
     void Sync(CNode* node);
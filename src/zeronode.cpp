@@ -107,7 +107,12 @@ CZeronode::CZeronode(const CZeronodeBroadcast &mnb) :
 bool CZeronode::UpdateFromNewBroadcast(CZeronodeBroadcast &mnb) {
     if (mnb.sigTime <= sigTime && !mnb.fRecovery) return false;
 
+    CPubKey pubKeyZeronodeOld = pubKeyZeronode;
     pubKeyZeronode = mnb.pubKeyZeronode;
+    if (pubKeyZeronode != pubKeyZeronodeOld)
+        mnodeman.UpdatedPubKeyZeronode(*this, pubKeyZeronodeOld);
+    // protocol version, ping and PoSe score can all change below
+    mnodeman.ScheduleCheck(vin.prevout);
     sigTime = mnb.sigTime;
     vchSig = mnb.vchSig;
     nProtocolVersion = mnb.nProtocolVersion;
@@ -186,6 +191,15 @@ void CZeronode::Check(bool fForce) {
         nHeight = chainActive.Height();
     }
 
+    CheckState(nHeight);
+}
+
+void CZeronode::CheckState(int nHeight) {
+    LOCK(cs);
+
+    //once spent, stop doing the checks
+    if (IsOutpointSpent()) return;
+
     if (IsPoSeBanned()) {
         if (nHeight < nPoSeBanHeight) return; // too early?
         // Otherwise give it a chance to proceed further to do all the usual checks and to change its state.
@@ -276,6 +290,26 @@ void CZeronode::Check(bool fForce) {
     }
 }
 
+int64_t CZeronode::GetNextCheckTime() {
+    LOCK(cs);
+
+    int64_t nNow = GetTime();
+    int64_t nNextTime = 0;
+    std::vector<int64_t> vTimes;
+    if (lastPing != CZeronodePing()) {
+        // IsPingedWithin() goes by the adjusted time
+        int64_t nTimeOffset = GetTimeOffset();
+        vTimes.push_back(lastPing.sigTime + ZERONODE_MIN_MNP_SECONDS - nTimeOffset);
+        vTimes.push_back(lastPing.sigTime + ZERONODE_EXPIRATION_SECONDS - nTimeOffset);
+        vTimes.push_back(lastPing.sigTime + ZERONODE_NEW_START_REQUIRED_SECONDS - nTimeOffset);
+    }
+    vTimes.push_back(nTimeLastWatchdogVote + ZERONODE_WATCHDOG_MAX_SECONDS + 1);
+    BOOST_FOREACH(int64_t nTime, vTimes) {
+        if (nTime > nNow && (nNextTime == 0 || nTime < nNextTime)) nNextTime = nTime;
+    }
+    return nNextTime;
+}
+
 bool CZeronode::IsValidNetAddr() {
     return IsValidNetAddr(addr);
 }
@@ -389,48 +423,26 @@ int CZeronode::GetCollateralAge() {
     return nHeight - nCacheCollateralBlock;
 }
 
-void CZeronode::UpdateLastPaid(const CBlockIndex *pindex, int nMaxBlocksToScanBack) {
-    if (!pindex) {
-        LogPrintf("CZeronode::UpdateLastPaid pindex is NULL\n");
-        return;
-    }
-
-    const CBlockIndex *BlockReading = pindex;
-
+void CZeronode::UpdateLastPaid(const payments_map_t& mapPayments) {
     CScript mnpayee = GetScriptForDestination(pubKeyCollateralAddress.GetID());
     LogPrint("zeronode", "CZeronode::UpdateLastPaidBlock -- searching for block with payment to %s\n", vin.prevout.ToStringShort());
 
-    LOCK(cs_mapZeronodeBlocks);
-
-    for (int i = 0; BlockReading && BlockReading->nHeight > nBlockLastPaid && i < nMaxBlocksToScanBack; i++) {
-//        LogPrintf("mnpayments.mapZeronodeBlocks.count(BlockReading->nHeight)=%s\n", mnpayments.mapZeronodeBlocks.count(BlockReading->nHeight));
-//        LogPrintf("mnpayments.mapZeronodeBlocks[BlockReading->nHeight].HasPayeeWithVotes(mnpayee, 2)=%s\n", mnpayments.mapZeronodeBlocks[BlockReading->nHeight].HasPayeeWithVotes(mnpayee, 2));
-        if (mnpayments.mapZeronodeBlocks.count(BlockReading->nHeight) &&
-            mnpayments.mapZeronodeBlocks[BlockReading->nHeight].HasPayeeWithVotes(mnpayee, 2)) {
-            // LogPrintf("i=%s, BlockReading->nHeight=%s\n", i, BlockReading->nHeight);
-            CBlock block;
-            if (!ReadBlockFromDisk(block, BlockReading, Params().GetConsensus())) // shouldn't really happen
-            {
-                LogPrintf("ReadBlockFromDisk failed\n");
-                continue;
-            }
-
-            CAmount nZeronodePayment = GetZeronodePayment(BlockReading->nHeight, block.vtx[0].GetValueOut());
+    payments_map_t::const_iterator it = mapPayments.find(mnpayee);
+    if (it == mapPayments.end())
+        return;
 
-            BOOST_FOREACH(CTxOut txout, block.vtx[0].vout)
-            if (mnpayee == txout.scriptPubKey && nZeronodePayment == txout.nValue) {
-                nBlockLastPaid = BlockReading->nHeight;
-                nTimeLastPaid = BlockReading->nTime;
-                LogPrint("zeronode", "CZeronode::UpdateLastPaidBlock -- searching for block with payment to %s -- found new %d\n", vin.prevout.ToStringShort(), nBlockLastPaid);
-                return;
-            }
-        }
+    LOCK(cs_mapZeronodeBlocks);
 
-        if (BlockReading->pprev == NULL) {
-            assert(BlockReading);
+    BOOST_FOREACH(const CBlockIndex* pindex, it->second) {
+        if (pindex->nHeight <= nBlockLastPaid)
             break;
+        if (mnpayments.mapZeronodeBlocks.count(pindex->nHeight) &&
+            mnpayments.mapZeronodeBlocks[pindex->nHeight].HasPayeeWithVotes(mnpayee, 2)) {
+            nBlockLastPaid = pindex->nHeight;
+            nTimeLastPaid = pindex->nTime;
+            LogPrint("zeronode", "CZeronode::UpdateLastPaidBlock -- searching for block with payment to %s -- found new %d\n", vin.prevout.ToStringShort(), nBlockLastPaid);
+            return;
         }
-        BlockReading = BlockReading->pprev;
     }
 
     // Last payment for this zeronode wasn't found in latest mnpayments blocks
@@ -709,9 +721,7 @@ bool CZeronodeBroadcast::Sign(CKey &keyCollateralAddress) {
 
     sigTime = GetAdjustedTime();
 
-    strMessage = addr.ToString() + boost::lexical_cast<std::string>(sigTime) +
-                 pubKeyCollateralAddress.GetID().ToString() + pubKeyZeronode.GetID().ToString() +
-                 boost::lexical_cast<std::string>(nProtocolVersion);
+    strMessage = GetSignatureMessage();
 
     if (!darkSendSigner.SignMessage(strMessage, vchSig, keyCollateralAddress)) {
         LogPrintf("CZeronodeBroadcast::Sign -- SignMessage() failed\n");
@@ -731,9 +741,7 @@ bool CZeronodeBroadcast::CheckSignature(int &nDos) {
     std::string strError = "";
     nDos = 0;
 
-    strMessage = addr.ToString() + boost::lexical_cast<std::string>(sigTime) +
-                 pubKeyCollateralAddress.GetID().ToString() + pubKeyZeronode.GetID().ToString() +
-                 boost::lexical_cast<std::string>(nProtocolVersion);
+    strMessage = GetSignatureMessage();
 
     LogPrint("zeronode", "CZeronodeBroadcast::CheckSignature -- strMessage: %s  pubKeyCollateralAddress address: %s  sig: %s\n", strMessage, CBitcoinAddress(pubKeyCollateralAddress.GetID()).ToString(), EncodeBase64(&vchSig[0], vchSig.size()));
 
@@ -746,6 +754,12 @@ bool CZeronodeBroadcast::CheckSignature(int &nDos) {
     return true;
 }
 
+std::string CZeronodeBroadcast::GetSignatureMessage() const {
+    return addr.ToString() + boost::lexical_cast<std::string>(sigTime) +
+           pubKeyCollateralAddress.GetID().ToString() + pubKeyZeronode.GetID().ToString() +
+           boost::lexical_cast<std::string>(nProtocolVersion);
+}
+
 void CZeronodeBroadcast::RelayZNode() {
     LogPrintf("CZeronodeBroadcast::RelayZNode\n");
     CInv inv(MSG_ZERONODE_ANNOUNCE, GetHash());
@@ -767,7 +781,7 @@ bool CZeronodePing::Sign(CKey &keyZeronode, CPubKey &pubKeyZeronode) {
     std::string strZNodeSignMessage;
 
     sigTime = GetAdjustedTime();
-    std::string strMessage = vin.ToString() + blockHash.ToString() + boost::lexical_cast<std::string>(sigTime);
+    std::string strMessage = GetSignatureMessage();
 
     if (!darkSendSigner.SignMessage(strMessage, vchSig, keyZeronode)) {
         LogPrintf("CZeronodePing::Sign -- SignMessage() failed\n");
@@ -783,7 +797,7 @@ bool CZeronodePing::Sign(CKey &keyZeronode, CPubKey &pubKeyZeronode) {
 }
 
 bool CZeronodePing::CheckSignature(CPubKey &pubKeyZeronode, int &nDos) {
-    std::string strMessage = vin.ToString() + blockHash.ToString() + boost::lexical_cast<std::string>(sigTime);
+    std::string strMessage = GetSignatureMessage();
     std::string strError = "";
     nDos = 0;
 
@@ -795,6 +809,10 @@ bool CZeronodePing::CheckSignature(CPubKey &pubKeyZeronode, int &nDos) {
     return true;
 }
 
+std::string CZeronodePing::GetSignatureMessage() const {
+    return vin.ToString() + blockHash.ToString() + boost::lexical_cast<std::string>(sigTime);
+}
+
 bool CZeronodePing::SimpleCheck(int &nDos) {
     // don't ban by default
     nDos = 0;
@@ -890,6 +908,8 @@ bool CZeronodePing::CheckAndUpdate(CZeronode *pmn, bool fFromNewBroadcast, int &
     }
 
     pmn->Check(true); // force update, ignoring cache
+    // the deadlines of the node now run from this ping
+    mnodeman.ScheduleCheck(vin.prevout);
     if (!pmn->IsEnabled()) return false;
 
     LogPrint("zeronode", "CZeronodePing::CheckAndUpdate -- Zeronode ping acceepted and relayed, zeronode=%s\n", vin.prevout.ToStringShort());
@@ -82,6 +82,7 @@ public:
 
     bool Sign(CKey& keyZeronode, CPubKey& pubKeyZeronode);
     bool CheckSignature(CPubKey& pubKeyZeronode, int &nDos);
+    std::string GetSignatureMessage() const;
     bool SimpleCheck(int& nDos);
     bool CheckAndUpdate(CZeronode* pmn, bool fFromNewBroadcast, int& nDos);
     void Relay();
@@ -247,6 +248,10 @@ public:
     bool UpdateFromNewBroadcast(CZeronodeBroadcast& mnb);
 
     void Check(bool fForce = false);
+    // the part of Check() that doesn't look the collateral up, at the given chain height
+    void CheckState(int nHeight);
+    // time at which the state found by CheckState() expires without any new ping or vote, 0 if it never does
+    int64_t GetNextCheckTime();
 
     bool IsBroadcastedWithin(int nSeconds) { return GetAdjustedTime() - sigTime < nSeconds; }
 
@@ -298,7 +303,9 @@ public:
 
     int GetLastPaidTime() { return nTimeLastPaid; }
     int GetLastPaidBlock() { return nBlockLastPaid; }
-    void UpdateLastPaid(const CBlockIndex *pindex, int nMaxBlocksToScanBack);
+    // blocks of the active chain that paid each payee, newest first
+    typedef std::map<CScript, std::vector<const CBlockIndex*> > payments_map_t;
+    void UpdateLastPaid(const payments_map_t& mapPayments);
 
     // KEEP TRACK OF EACH GOVERNANCE ITEM INCASE THIS NODE GOES OFFLINE, SO WE CAN RECALC THEIR STATUS
     void AddGovernanceVote(uint256 nGovernanceObjectHash);
@@ -374,6 +381,7 @@ public:
 
     bool Sign(CKey& keyCollateralAddress);
     bool CheckSignature(int& nDos);
+    std::string GetSignatureMessage() const;
     void RelayZNode();
 };
 
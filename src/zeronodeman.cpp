@@ -10,6 +10,9 @@
 #include "zeronode-sync.h"
 #include "zeronodeman.h"
 #include "netfulfilledman.h"
+#include "hash.h"
+#include "init.h"
+#include "random.h"
 #include "util.h"
 
 /** Zeronode manager */
@@ -96,8 +99,50 @@ void CZeronodeIndex::RebuildIndex()
     }
 }
 
+CZeronodeLookupHasher::CZeronodeLookupHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
+size_t CZeronodeLookupHasher::operator()(const COutPoint& outpoint) const
+{
+    return CSipHasher(k0, k1).Write(outpoint.hash.begin(), outpoint.hash.size()).Write(outpoint.n).Finalize();
+}
+
+size_t CZeronodeLookupHasher::operator()(const CPubKey& pubKey) const
+{
+    return CSipHasher(k0, k1).Write(pubKey.begin(), pubKey.size()).Finalize();
+}
+
+size_t CZeronodeLookupHasher::operator()(const CScript& script) const
+{
+    return CSipHasher(k0, k1).Write(script.empty() ? NULL : &script[0], script.size()).Finalize();
+}
+
+/** Erase the entry of pmn under key from a lookup map */
+template<typename Map, typename Key>
+static void EraseLookup(Map& map, const Key& key, const CZeronode* pmn)
+{
+    std::pair<typename Map::iterator, typename Map::iterator> range = map.equal_range(key);
+    for(typename Map::iterator it = range.first; it != range.second; ++it) {
+        if(it->second == pmn) {
+            map.erase(it);
+            return;
+        }
+    }
+}
+
 CZeronodeMan::CZeronodeMan() : cs(),
-  vZeronodes(),
+  listZeronodes(),
+  mapByOutpoint(),
+  mapByPubKey(),
+  mapByPayee(),
+  listRankCache(),
+  setCheckSchedule(),
+  mapCheckTime(),
+  setCollateralCheck(),
+  fCheckAll(true),
+  nCheckedMinPaymentsProto(0),
+  fCheckedListSynced(false),
+  fCheckedSynced(false),
+  fCheckedWatchdogActive(false),
   mAskedUsForZeronodeList(),
   mWeAskedForZeronodeList(),
   mWeAskedForZeronodeListEntry(),
@@ -125,7 +170,8 @@ bool CZeronodeMan::Add(CZeronode &mn)
     CZeronode *pmn = Find(mn.vin);
     if (pmn == NULL) {
         LogPrint("zeronode", "CZeronodeMan::Add -- Adding new Zeronode: addr=%s, %i now\n", mn.addr.ToString(), size() + 1);
-        vZeronodes.push_back(mn);
+        listZeronodes.push_back(mn);
+        AddToLookups(listZeronodes.back());
         indexZeronodes.AddZeronodeVIN(mn.vin);
         fZeronodesAdded = true;
         return true;
@@ -169,11 +215,105 @@ void CZeronodeMan::Check()
 
 //    LogPrint("zeronode", "CZeronodeMan::Check -- nLastWatchdogVoteTime=%d, IsWatchdogActive()=%d\n", nLastWatchdogVoteTime, IsWatchdogActive());
 
-    BOOST_FOREACH(CZeronode& mn, vZeronodes) {
-        mn.Check();
+    if (ShutdownRequested()) return;
+
+    // the state of every zeronode depends on these
+    int nMinPaymentsProto = mnpayments.GetMinZeronodePaymentsProto();
+    bool fListSynced = zeronodeSync.IsZeronodeListSynced();
+    bool fSynced = zeronodeSync.IsSynced();
+    bool fWatchdogActive = IsWatchdogActive();
+    if (nMinPaymentsProto != nCheckedMinPaymentsProto || fListSynced != fCheckedListSynced ||
+            fSynced != fCheckedSynced || fWatchdogActive != fCheckedWatchdogActive) {
+        nCheckedMinPaymentsProto = nMinPaymentsProto;
+        fCheckedListSynced = fListSynced;
+        fCheckedSynced = fSynced;
+        fCheckedWatchdogActive = fWatchdogActive;
+        fCheckAll = true;
+    }
+
+    // collaterals need cs_main, try again on the next call if it's busy
+    if (!setCollateralCheck.empty()) {
+        TRY_LOCK(cs_main, lockMain);
+        if (lockMain) {
+            BOOST_FOREACH(const COutPoint& outpoint, setCollateralCheck) {
+                CZeronode* pmn = Find(CTxIn(outpoint));
+                if (pmn) pmn->Check(true);
+            }
+            setCollateralCheck.clear();
+        }
+    }
+
+    int nHeight = pCurrentBlockIndex ? pCurrentBlockIndex->nHeight : 0;
+    if (fCheckAll) {
+        BOOST_FOREACH(CZeronode& mn, listZeronodes) {
+            mn.CheckState(nHeight);
+            ScheduleCheckAt(mn.vin.prevout, mn.GetNextCheckTime());
+        }
+        fCheckAll = false;
+        return;
+    }
+
+    // GetNextCheckTime() is always in the future, so this ends
+    int64_t nNow = GetTime();
+    while (!setCheckSchedule.empty() && setCheckSchedule.begin()->first <= nNow) {
+        COutPoint outpoint = setCheckSchedule.begin()->second;
+        CZeronode* pmn = Find(CTxIn(outpoint));
+        if (!pmn) {
+            ScheduleCheckAt(outpoint, 0);
+            continue;
+        }
+        pmn->CheckState(nHeight);
+        ScheduleCheckAt(outpoint, pmn->GetNextCheckTime());
     }
 }
 
+void CZeronodeMan::ScheduleCheck(const COutPoint& outpoint)
+{
+    LOCK(cs);
+    // copies of list entries are not scheduled
+    if (!mapByOutpoint.count(outpoint)) return;
+    ScheduleCheckAt(outpoint, GetTime());
+}
+
+void CZeronodeMan::ScheduleCheckAt(const COutPoint& outpoint, int64_t nTime)
+{
+    boost::unordered_map<COutPoint, int64_t, CZeronodeLookupHasher>::iterator it = mapCheckTime.find(outpoint);
+    if (it != mapCheckTime.end()) {
+        setCheckSchedule.erase(std::make_pair(it->second, outpoint));
+        mapCheckTime.erase(it);
+    }
+    if (nTime == 0) return;
+    setCheckSchedule.insert(std::make_pair(nTime, outpoint));
+    mapCheckTime[outpoint] = nTime;
+}
+
+void CZeronodeMan::BlockConnected(const CBlock& block)
+{
+    LOCK(cs);
+    if (mapByOutpoint.empty()) return;
+
+    BOOST_FOREACH(const CTransaction& tx, block.vtx) {
+        if (tx.IsCoinBase()) continue;
+        BOOST_FOREACH(const CTxIn& txin, tx.vin) {
+            if (mapByOutpoint.count(txin.prevout))
+                setCollateralCheck.insert(txin.prevout);
+        }
+    }
+}
+
+int64_t CZeronodeMan::GetScheduledCheckTime(const COutPoint& outpoint)
+{
+    LOCK(cs);
+    boost::unordered_map<COutPoint, int64_t, CZeronodeLookupHasher>::const_iterator it = mapCheckTime.find(outpoint);
+    return it == mapCheckTime.end() ? 0 : it->second;
+}
+
+bool CZeronodeMan::IsCollateralCheckPending(const COutPoint& outpoint)
+{
+    LOCK(cs);
+    return setCollateralCheck.count(outpoint);
+}
+
 void CZeronodeMan::CheckAndRemove()
 {
     if(!zeronodeSync.IsZeronodeListSynced()) return;
@@ -185,14 +325,16 @@ void CZeronodeMan::CheckAndRemove()
         // in CheckMnbAndUpdateZeronodeList()
         LOCK2(cs_main, cs);
 
+        // go through everyone once in a while, for the changes that come without any event
+        fCheckAll = true;
         Check();
 
         // Remove spent zeronodes, prepare structures and make requests to reasure the state of inactive ones
-        std::vector<CZeronode>::iterator it = vZeronodes.begin();
+        std::list<CZeronode>::iterator it = listZeronodes.begin();
         std::vector<std::pair<int, CZeronode> > vecZeronodeRanks;
         // ask for up to MNB_RECOVERY_MAX_ASK_ENTRIES zeronode entries at a time
         int nAskForMnbRecovery = MNB_RECOVERY_MAX_ASK_ENTRIES;
-        while(it != vZeronodes.end()) {
+        while(it != listZeronodes.end()) {
             CZeronodeBroadcast mnb = CZeronodeBroadcast(*it);
             uint256 hash = mnb.GetHash();
             // If collateral was spent ...
@@ -205,7 +347,8 @@ void CZeronodeMan::CheckAndRemove()
 
                 // and finally remove it from the list
 //                it->FlagGovernanceItemsAsDirty();
-                it = vZeronodes.erase(it);
+                RemoveFromLookups(*it);
+                it = listZeronodes.erase(it);
                 fZeronodesRemoved = true;
             } else {
                 bool fAsk = pCurrentBlockIndex &&
@@ -365,7 +508,15 @@ void CZeronodeMan::CheckAndRemove()
 void CZeronodeMan::Clear()
 {
     LOCK(cs);
-    vZeronodes.clear();
+    listZeronodes.clear();
+    mapByOutpoint.clear();
+    mapByPubKey.clear();
+    mapByPayee.clear();
+    listRankCache.clear();
+    setCheckSchedule.clear();
+    mapCheckTime.clear();
+    setCollateralCheck.clear();
+    fCheckAll = true;
     mAskedUsForZeronodeList.clear();
     mWeAskedForZeronodeList.clear();
     mWeAskedForZeronodeListEntry.clear();
@@ -383,7 +534,7 @@ int CZeronodeMan::CountZeronodes(int nProtocolVersion)
     int nCount = 0;
     nProtocolVersion = nProtocolVersion == -1 ? mnpayments.GetMinZeronodePaymentsProto() : nProtocolVersion;
 
-    BOOST_FOREACH(CZeronode& mn, vZeronodes) {
+    BOOST_FOREACH(CZeronode& mn, listZeronodes) {
         if(mn.nProtocolVersion < nProtocolVersion) continue;
         nCount++;
     }
@@ -397,7 +548,7 @@ int CZeronodeMan::CountEnabled(int nProtocolVersion)
     int nCount = 0;
     nProtocolVersion = nProtocolVersion == -1 ? mnpayments.GetMinZeronodePaymentsProto() : nProtocolVersion;
 
-    BOOST_FOREACH(CZeronode& mn, vZeronodes) {
+    BOOST_FOREACH(CZeronode& mn, listZeronodes) {
         if(mn.nProtocolVersion < nProtocolVersion || !mn.IsEnabled()) continue;
         nCount++;
     }
@@ -411,7 +562,7 @@ int CZeronodeMan::CountByIP(int nNetworkType)
     LOCK(cs);
     int nNodeCount = 0;
 
-    BOOST_FOREACH(CZeronode& mn, vZeronodes)
+    BOOST_FOREACH(CZeronode& mn, listZeronodes)
         if ((nNetworkType == NET_IPV4 && mn.addr.IsIPv4()) ||
             (nNetworkType == NET_TOR  && mn.addr.IsTor())  ||
             (nNetworkType == NET_IPV6 && mn.addr.IsIPv6())) {
@@ -447,36 +598,24 @@ CZeronode* CZeronodeMan::Find(const CScript &payee)
 {
     LOCK(cs);
 
-    BOOST_FOREACH(CZeronode& mn, vZeronodes)
-    {
-        if(GetScriptForDestination(mn.pubKeyCollateralAddress.GetID()) == payee)
-            return &mn;
-    }
-    return NULL;
+    boost::unordered_multimap<CScript, CZeronode*, CZeronodeLookupHasher>::const_iterator it = mapByPayee.find(payee);
+    return it == mapByPayee.end() ? NULL : it->second;
 }
 
 CZeronode* CZeronodeMan::Find(const CTxIn &vin)
 {
     LOCK(cs);
 
-    BOOST_FOREACH(CZeronode& mn, vZeronodes)
-    {
-        if(mn.vin.prevout == vin.prevout)
-            return &mn;
-    }
-    return NULL;
+    boost::unordered_map<COutPoint, CZeronode*, CZeronodeLookupHasher>::const_iterator it = mapByOutpoint.find(vin.prevout);
+    return it == mapByOutpoint.end() ? NULL : it->second;
 }
 
 CZeronode* CZeronodeMan::Find(const CPubKey &pubKeyZeronode)
 {
     LOCK(cs);
 
-    BOOST_FOREACH(CZeronode& mn, vZeronodes)
-    {
-        if(mn.pubKeyZeronode == pubKeyZeronode)
-            return &mn;
-    }
-    return NULL;
+    boost::unordered_multimap<CPubKey, CZeronode*, CZeronodeLookupHasher>::const_iterator it = mapByPubKey.find(pubKeyZeronode);
+    return it == mapByPubKey.end() ? NULL : it->second;
 }
 
 bool CZeronodeMan::Get(const CPubKey& pubKeyZeronode, CZeronode& zeronode)
@@ -534,6 +673,18 @@ bool CZeronodeMan::Has(const CTxIn& vin)
     return (pMN != NULL);
 }
 
+bool CZeronodeMan::HasSeenBroadcast(const uint256& hash)
+{
+    LOCK(cs);
+    return mapSeenZeronodeBroadcast.count(hash);
+}
+
+bool CZeronodeMan::HasSeenPing(const uint256& hash)
+{
+    LOCK(cs);
+    return mapSeenZeronodePing.count(hash);
+}
+
 char* CZeronodeMan::GetNotQualifyReason(CZeronode& mn, int nBlockHeight, bool fFilterSigTime, int nMnCount)
 {
     if (!mn.IsValidForPayment()) {
@@ -601,7 +752,7 @@ CZeronode* CZeronodeMan::GetNextZeronodeInQueueForPayment(int nBlockHeight, bool
     */
     int nMnCount = CountEnabled();
     int index = 0;
-    BOOST_FOREACH(CZeronode &mn, vZeronodes)
+    BOOST_FOREACH(CZeronode &mn, listZeronodes)
     {
         index += 1;
         // LogPrintf("index=%s, mn=%s\n", index, mn.ToString());
@@ -673,8 +824,9 @@ CZeronode* CZeronodeMan::GetNextZeronodeInQueueForPayment(int nBlockHeight, bool
     int nTenthNetwork = nMnCount/10;
     int nCountTenth = 0;
     arith_uint256 nHighest = 0;
+    std::shared_ptr<const CZeronodeScores> pscores = GetZeronodeScores(blockHash);
     BOOST_FOREACH (PAIRTYPE(int, CZeronode*)& s, vecZeronodeLastPaid){
-        arith_uint256 nScore = s.second->CalculateScore(blockHash);
+        arith_uint256 nScore = pscores->mapScores.at(s.second);
         if(nScore > nHighest){
             nHighest = nScore;
             pBestZeronode = s.second;
@@ -699,7 +851,7 @@ CZeronode* CZeronodeMan::FindRandomNotInVec(const std::vector<CTxIn> &vecToExclu
 
     // fill a vector of pointers
     std::vector<CZeronode*> vpZeronodesShuffled;
-    BOOST_FOREACH(CZeronode &mn, vZeronodes) {
+    BOOST_FOREACH(CZeronode &mn, listZeronodes) {
         vpZeronodesShuffled.push_back(&mn);
     }
 
@@ -728,18 +880,48 @@ CZeronode* CZeronodeMan::FindRandomNotInVec(const std::vector<CTxIn> &vecToExclu
     return NULL;
 }
 
-int CZeronodeMan::GetZeronodeRank(const CTxIn& vin, int nBlockHeight, int nMinProtocol, bool fOnlyActive)
+std::shared_ptr<const CZeronodeScores> CZeronodeMan::GetZeronodeScores(const uint256& blockHash)
 {
-    std::vector<std::pair<int64_t, CZeronode*> > vecZeronodeScores;
+    LOCK(cs);
+
+    std::list<std::pair<uint256, std::shared_ptr<const CZeronodeScores> > >::iterator it = listRankCache.begin();
+    for(; it != listRankCache.end(); ++it) {
+        if(it->first == blockHash) {
+            listRankCache.splice(listRankCache.begin(), listRankCache, it);
+            return it->second;
+        }
+    }
+
+    std::shared_ptr<CZeronodeScores> pscores = std::make_shared<CZeronodeScores>();
+    pscores->vecScores.reserve(listZeronodes.size());
+    pscores->mapScores.reserve(listZeronodes.size());
+    BOOST_FOREACH(CZeronode& mn, listZeronodes) {
+        arith_uint256 nScore = mn.CalculateScore(blockHash);
+        pscores->vecScores.push_back(std::make_pair(nScore.GetCompact(false), &mn));
+        pscores->mapScores.insert(std::make_pair(&mn, nScore));
+    }
+    sort(pscores->vecScores.rbegin(), pscores->vecScores.rend(), CompareScoreMN());
+
+    listRankCache.push_front(std::make_pair(blockHash, std::shared_ptr<const CZeronodeScores>(pscores)));
+    if(listRankCache.size() > RANK_CACHE_SIZE) {
+        listRankCache.pop_back();
+    }
+    return pscores;
+}
 
+int CZeronodeMan::GetZeronodeRank(const CTxIn& vin, int nBlockHeight, int nMinProtocol, bool fOnlyActive)
+{
     //make sure we know about this block
     uint256 blockHash = uint256();
     if(!GetBlockHash(blockHash, nBlockHeight)) return -1;
 
     LOCK(cs);
 
-    // scan for winner
-    BOOST_FOREACH(CZeronode& mn, vZeronodes) {
+    std::shared_ptr<const CZeronodeScores> pscores = GetZeronodeScores(blockHash);
+
+    int nRank = 0;
+    BOOST_FOREACH (const CZeronodeScores::score_pair_t& scorePair, pscores->vecScores) {
+        CZeronode& mn = *scorePair.second;
         if(mn.nProtocolVersion < nMinProtocol) continue;
         if(fOnlyActive) {
             if(!mn.IsEnabled()) continue;
@@ -747,17 +929,8 @@ int CZeronodeMan::GetZeronodeRank(const CTxIn& vin, int nBlockHeight, int nMinPr
         else {
             if(!mn.IsValidForPayment()) continue;
         }
-        int64_t nScore = mn.CalculateScore(blockHash).GetCompact(false);
-
-        vecZeronodeScores.push_back(std::make_pair(nScore, &mn));
-    }
-
-    sort(vecZeronodeScores.rbegin(), vecZeronodeScores.rend(), CompareScoreMN());
-
-    int nRank = 0;
-    BOOST_FOREACH (PAIRTYPE(int64_t, CZeronode*)& scorePair, vecZeronodeScores) {
         nRank++;
-        if(scorePair.second->vin.prevout == vin.prevout) return nRank;
+        if(mn.vin.prevout == vin.prevout) return nRank;
     }
 
     return -1;
@@ -765,7 +938,6 @@ int CZeronodeMan::GetZeronodeRank(const CTxIn& vin, int nBlockHeight, int nMinPr
 
 std::vector<std::pair<int, CZeronode> > CZeronodeMan::GetZeronodeRanks(int nBlockHeight, int nMinProtocol)
 {
-    std::vector<std::pair<int64_t, CZeronode*> > vecZeronodeScores;
     std::vector<std::pair<int, CZeronode> > vecZeronodeRanks;
 
     //make sure we know about this block
@@ -774,20 +946,11 @@ std::vector<std::pair<int, CZeronode> > CZeronodeMan::GetZeronodeRanks(int nBloc
 
     LOCK(cs);
 
-    // scan for winner
-    BOOST_FOREACH(CZeronode& mn, vZeronodes) {
-
-        if(mn.nProtocolVersion < nMinProtocol || !mn.IsEnabled()) continue;
-
-        int64_t nScore = mn.CalculateScore(blockHash).GetCompact(false);
-
-        vecZeronodeScores.push_back(std::make_pair(nScore, &mn));
-    }
-
-    sort(vecZeronodeScores.rbegin(), vecZeronodeScores.rend(), CompareScoreMN());
+    std::shared_ptr<const CZeronodeScores> pscores = GetZeronodeScores(blockHash);
 
     int nRank = 0;
-    BOOST_FOREACH (PAIRTYPE(int64_t, CZeronode*)& s, vecZeronodeScores) {
+    BOOST_FOREACH (const CZeronodeScores::score_pair_t& s, pscores->vecScores) {
+        if(s.second->nProtocolVersion < nMinProtocol || !s.second->IsEnabled()) continue;
         nRank++;
         vecZeronodeRanks.push_back(std::make_pair(nRank, *s.second));
     }
@@ -797,8 +960,6 @@ std::vector<std::pair<int, CZeronode> > CZeronodeMan::GetZeronodeRanks(int nBloc
 
 CZeronode* CZeronodeMan::GetZeronodeByRank(int nRank, int nBlockHeight, int nMinProtocol, bool fOnlyActive)
 {
-    std::vector<std::pair<int64_t, CZeronode*> > vecZeronodeScores;
-
     LOCK(cs);
 
     uint256 blockHash;
@@ -807,21 +968,12 @@ CZeronode* CZeronodeMan::GetZeronodeByRank(int nRank, int nBlockHeight, int nMin
         return NULL;
     }
 
-    // Fill scores
-    BOOST_FOREACH(CZeronode& mn, vZeronodes) {
-
-        if(mn.nProtocolVersion < nMinProtocol) continue;
-        if(fOnlyActive && !mn.IsEnabled()) continue;
-
-        int64_t nScore = mn.CalculateScore(blockHash).GetCompact(false);
-
-        vecZeronodeScores.push_back(std::make_pair(nScore, &mn));
-    }
-
-    sort(vecZeronodeScores.rbegin(), vecZeronodeScores.rend(), CompareScoreMN());
+    std::shared_ptr<const CZeronodeScores> pscores = GetZeronodeScores(blockHash);
 
     int rank = 0;
-    BOOST_FOREACH (PAIRTYPE(int64_t, CZeronode*)& s, vecZeronodeScores){
+    BOOST_FOREACH (const CZeronodeScores::score_pair_t& s, pscores->vecScores){
+        if(s.second->nProtocolVersion < nMinProtocol) continue;
+        if(fOnlyActive && !s.second->IsEnabled()) continue;
         rank++;
         if(rank == nRank) {
             return s.second;
@@ -975,7 +1127,7 @@ void CZeronodeMan::ProcessMessage(CNode* pfrom, std::string& strCommand, CDataSt
 
         int nInvCount = 0;
 
-        BOOST_FOREACH(CZeronode& mn, vZeronodes) {
+        BOOST_FOREACH(CZeronode& mn, listZeronodes) {
             if (vin != CTxIn() && vin != mn.vin) continue; // asked for specific vin but we are not there yet
             if (mn.addr.IsRFC1918() || mn.addr.IsLocal()) continue; // do not send local network zeronode
             if (mn.IsUpdateRequired()) continue; // do not send outdated zeronodes
@@ -1070,7 +1222,7 @@ void CZeronodeMan::DoFullVerificationStep()
     if(nOffset >= (int)vecZeronodeRanks.size()) return;
 
     std::vector<CZeronode*> vSortedByAddr;
-    BOOST_FOREACH(CZeronode& mn, vZeronodes) {
+    BOOST_FOREACH(CZeronode& mn, listZeronodes) {
         vSortedByAddr.push_back(&mn);
     }
 
@@ -1110,7 +1262,7 @@ void CZeronodeMan::DoFullVerificationStep()
 
 void CZeronodeMan::CheckSameAddr()
 {
-    if(!zeronodeSync.IsSynced() || vZeronodes.empty()) return;
+    if(!zeronodeSync.IsSynced() || listZeronodes.empty()) return;
 
     std::vector<CZeronode*> vBan;
     std::vector<CZeronode*> vSortedByAddr;
@@ -1121,7 +1273,7 @@ void CZeronodeMan::CheckSameAddr()
         CZeronode* pprevZeronode = NULL;
         CZeronode* pverifiedZeronode = NULL;
 
-        BOOST_FOREACH(CZeronode& mn, vZeronodes) {
+        BOOST_FOREACH(CZeronode& mn, listZeronodes) {
             vSortedByAddr.push_back(&mn);
         }
 
@@ -1158,6 +1310,7 @@ void CZeronodeMan::CheckSameAddr()
     BOOST_FOREACH(CZeronode* pmn, vBan) {
         LogPrintf("CZeronodeMan::CheckSameAddr -- increasing PoSe ban score for zeronode %s\n", pmn->vin.prevout.ToStringShort());
         pmn->IncreasePoSeBanScore();
+        ScheduleCheck(pmn->vin.prevout);
     }
 }
 
@@ -1271,9 +1424,9 @@ void CZeronodeMan::ProcessVerifyReply(CNode* pnode, CZeronodeVerification& mnv)
 
         CZeronode* prealZeronode = NULL;
         std::vector<CZeronode*> vpZeronodesToBan;
-        std::vector<CZeronode>::iterator it = vZeronodes.begin();
+        std::list<CZeronode>::iterator it = listZeronodes.begin();
         std::string strMessage1 = strprintf("%s%d%s", pnode->addr.ToString(), mnv.nonce, blockHash.ToString());
-        while(it != vZeronodes.end()) {
+        while(it != listZeronodes.end()) {
             if(CAddress(it->addr, NODE_NETWORK) == pnode->addr) {
                 if(darkSendSigner.VerifyMessage(it->pubKeyZeronode, mnv.vchSig1, strMessage1, strError)) {
                     // found it!
@@ -1326,6 +1479,7 @@ void CZeronodeMan::ProcessVerifyReply(CNode* pnode, CZeronodeVerification& mnv)
         // increase ban score for everyone else
         BOOST_FOREACH(CZeronode* pmn, vpZeronodesToBan) {
             pmn->IncreasePoSeBanScore();
+            ScheduleCheck(pmn->vin.prevout);
             LogPrint("zeronode", "CZeronodeMan::ProcessVerifyBroadcast -- increased PoSe ban score for %s addr %s, new score %d\n",
                         prealZeronode->vin.prevout.ToStringShort(), pnode->addr.ToString(), pmn->nPoSeBanScore);
         }
@@ -1425,9 +1579,10 @@ void CZeronodeMan::ProcessVerifyBroadcast(CNode* pnode, const CZeronodeVerificat
 
         // increase ban score for everyone else with the same addr
         int nCount = 0;
-        BOOST_FOREACH(CZeronode& mn, vZeronodes) {
+        BOOST_FOREACH(CZeronode& mn, listZeronodes) {
             if(mn.addr != mnv.addr || mn.vin.prevout == mnv.vin1.prevout) continue;
             mn.IncreasePoSeBanScore();
+            ScheduleCheck(mn.vin.prevout);
             nCount++;
             LogPrint("zeronode", "CZeronodeMan::ProcessVerifyBroadcast -- increased PoSe ban score for %s addr %s, new score %d\n",
                         mn.vin.prevout.ToStringShort(), mn.addr.ToString(), mn.nPoSeBanScore);
@@ -1441,7 +1596,7 @@ std::string CZeronodeMan::ToString() const
 {
     std::ostringstream info;
 
-    info << "Zeronodes: " << (int)vZeronodes.size() <<
+    info << "Zeronodes: " << (int)listZeronodes.size() <<
             ", peers who asked us for Zeronode list: " << (int)mAskedUsForZeronodeList.size() <<
             ", peers we asked for Zeronode list: " << (int)mWeAskedForZeronodeList.size() <<
             ", entries in Zeronode list we asked for: " << (int)mWeAskedForZeronodeListEntry.size() <<
@@ -1588,14 +1743,86 @@ void CZeronodeMan::UpdateLastPaid()
     LogPrint("mnpayments", "CZeronodeMan::UpdateLastPaid -- nHeight=%d, nMaxBlocksToScanBack=%d, IsFirstRun=%s\n",
                              pCurrentBlockIndex->nHeight, nMaxBlocksToScanBack, IsFirstRun ? "true" : "false");
 
-    BOOST_FOREACH(CZeronode& mn, vZeronodes) {
-        mn.UpdateLastPaid(pCurrentBlockIndex, nMaxBlocksToScanBack);
+    // No zeronode can find a payment at or below the oldest last paid block
+    int nMinBlockLastPaid = INT_MAX;
+    BOOST_FOREACH(CZeronode& mn, listZeronodes) {
+        nMinBlockLastPaid = std::min(nMinBlockLastPaid, mn.GetLastPaidBlock());
+    }
+
+    // Collect the payments of the blocks with payment votes in one pass over the coinbase payee index
+    CZeronode::payments_map_t mapPayments;
+    const CBlockIndex *pindex = pCurrentBlockIndex;
+    for (int i = 0; pindex && pindex->nHeight > nMinBlockLastPaid && i < nMaxBlocksToScanBack; i++, pindex = pindex->pprev) {
+        {
+            LOCK(cs_mapZeronodeBlocks);
+            if (!mnpayments.mapZeronodeBlocks.count(pindex->nHeight))
+                continue;
+        }
+        CCoinbasePayees payees;
+        if (!coinbasePayeeIndex.Get(pindex, payees))
+            continue;
+        BOOST_FOREACH(const CTxOut& payee, payees.vecPayees) {
+            mapPayments[payee.scriptPubKey].push_back(pindex);
+        }
+    }
+
+    BOOST_FOREACH(CZeronode& mn, listZeronodes) {
+        mn.UpdateLastPaid(mapPayments);
     }
 
     // every time is like the first time if winners list is not synced
     IsFirstRun = !zeronodeSync.IsWinnersListSynced();
 }
 
+void CZeronodeMan::AddToLookups(CZeronode& mn)
+{
+    listRankCache.clear();
+    mapByOutpoint[mn.vin.prevout] = &mn;
+    mapByPubKey.insert(std::make_pair(mn.pubKeyZeronode, &mn));
+    mapByPayee.insert(std::make_pair(GetScriptForDestination(mn.pubKeyCollateralAddress.GetID()), &mn));
+    ScheduleCheckAt(mn.vin.prevout, GetTime());
+}
+
+void CZeronodeMan::RemoveFromLookups(const CZeronode& mn)
+{
+    listRankCache.clear();
+    boost::unordered_map<COutPoint, CZeronode*, CZeronodeLookupHasher>::iterator it = mapByOutpoint.find(mn.vin.prevout);
+    if(it != mapByOutpoint.end() && it->second == &mn) {
+        mapByOutpoint.erase(it);
+    }
+    EraseLookup(mapByPubKey, mn.pubKeyZeronode, &mn);
+    EraseLookup(mapByPayee, GetScriptForDestination(mn.pubKeyCollateralAddress.GetID()), &mn);
+    ScheduleCheckAt(mn.vin.prevout, 0);
+    setCollateralCheck.erase(mn.vin.prevout);
+}
+
+void CZeronodeMan::RebuildLookups()
+{
+    listRankCache.clear();
+    mapByOutpoint.clear();
+    mapByPubKey.clear();
+    mapByPayee.clear();
+    setCheckSchedule.clear();
+    mapCheckTime.clear();
+    BOOST_FOREACH(CZeronode& mn, listZeronodes) {
+        AddToLookups(mn);
+        // the collateral could have been spent while the list was on disk
+        setCollateralCheck.insert(mn.vin.prevout);
+    }
+    fCheckAll = true;
+}
+
+void CZeronodeMan::UpdatedPubKeyZeronode(const CZeronode& mn, const CPubKey& pubKeyZeronodeOld)
+{
+    LOCK(cs);
+    // copies of list entries have nothing to update
+    if(Find(mn.vin) != &mn) {
+        return;
+    }
+    EraseLookup(mapByPubKey, pubKeyZeronodeOld, &mn);
+    mapByPubKey.insert(std::make_pair(mn.pubKeyZeronode, const_cast<CZeronode*>(&mn)));
+}
+
 void CZeronodeMan::CheckAndRebuildZeronodeIndex()
 {
     LOCK(cs);
@@ -1608,14 +1835,14 @@ void CZeronodeMan::CheckAndRebuildZeronodeIndex()
         return;
     }
 
-    if(indexZeronodes.GetSize() <= int(vZeronodes.size())) {
+    if(indexZeronodes.GetSize() <= int(listZeronodes.size())) {
         return;
     }
 
     indexZeronodesOld = indexZeronodes;
     indexZeronodes.Clear();
-    for(size_t i = 0; i < vZeronodes.size(); ++i) {
-        indexZeronodes.AddZeronodeVIN(vZeronodes[i].vin);
+    BOOST_FOREACH(const CZeronode& mn, listZeronodes) {
+        indexZeronodes.AddZeronodeVIN(mn.vin);
     }
 
     fIndexRebuilt = true;
@@ -1630,6 +1857,7 @@ void CZeronodeMan::UpdateWatchdogVoteTime(const CTxIn& vin)
         return;
     }
     pMN->UpdateWatchdogVoteTime();
+    ScheduleCheck(vin.prevout);
     nLastWatchdogVoteTime = GetTime();
 }
 
@@ -1714,6 +1942,15 @@ void CZeronodeMan::UpdatedBlockTip(const CBlockIndex *pindex)
 
     CheckSameAddr();
 
+    {
+        LOCK(cs);
+        // PoSe bans end at a height, not at a time
+        BOOST_FOREACH(CZeronode& mn, listZeronodes) {
+            if (mn.IsPoSeBanned() && mn.nPoSeBanHeight <= pindex->nHeight)
+                ScheduleCheck(mn.vin.prevout);
+        }
+    }
+
     if(fZNode) {
         // normal wallet does not need to update this every block, doing update on rpc call should be enough
         UpdateLastPaid();
@@ -8,6 +8,11 @@
 #include "zeronode.h"
 #include "sync.h"
 
+#include <list>
+#include <memory>
+
+#include <boost/unordered_map.hpp>
+
 using namespace std;
 
 class CZeronodeMan;
@@ -78,6 +83,33 @@ private:
 
 };
 
+/** Salted hasher for the lookup maps of the zeronode list */
+class CZeronodeLookupHasher
+{
+private:
+    /** Salt */
+    const uint64_t k0, k1;
+
+public:
+    CZeronodeLookupHasher();
+
+    size_t operator()(const COutPoint& outpoint) const;
+    size_t operator()(const CPubKey& pubKey) const;
+    size_t operator()(const CScript& script) const;
+};
+
+/** Scores of all the zeronodes in the list for one block hash */
+class CZeronodeScores
+{
+public:
+    typedef std::pair<int64_t, CZeronode*> score_pair_t;
+
+    // compact scores in rank order, best first
+    std::vector<score_pair_t> vecScores;
+    // full scores
+    boost::unordered_map<const CZeronode*, arith_uint256> mapScores;
+};
+
 class CZeronodeMan
 {
 public:
@@ -99,6 +131,8 @@ private:
 
     static const int LAST_PAID_SCAN_BLOCKS      = 100;
 
+    static const size_t RANK_CACHE_SIZE         = 10;
+
     static const int MIN_POSE_PROTO_VERSION     = 70203;
     static const int MAX_POSE_CONNECTIONS       = 10;
     static const int MAX_POSE_RANK              = 10;
@@ -117,8 +151,25 @@ private:
     // Keep track of current block index
     const CBlockIndex *pCurrentBlockIndex;
 
-    // map to hold all MNs
-    std::vector<CZeronode> vZeronodes;
+    // list to hold all MNs, pointers to its entries stay valid until they are removed from it
+    std::list<CZeronode> listZeronodes;
+    // lookup maps into listZeronodes, kept in sync by Add, CheckAndRemove and UpdatedPubKeyZeronode
+    boost::unordered_map<COutPoint, CZeronode*, CZeronodeLookupHasher> mapByOutpoint;
+    boost::unordered_multimap<CPubKey, CZeronode*, CZeronodeLookupHasher> mapByPubKey;
+    boost::unordered_multimap<CScript, CZeronode*, CZeronodeLookupHasher> mapByPayee;
+    // scores for the recently ranked block hashes, most recently used first, cleared when the list changes
+    std::list<std::pair<uint256, std::shared_ptr<const CZeronodeScores> > > listRankCache;
+    // next time the state of each Zeronode can change by itself, ordered by time, see CZeronode::GetNextCheckTime()
+    std::set<std::pair<int64_t, COutPoint> > setCheckSchedule;
+    boost::unordered_map<COutPoint, int64_t, CZeronodeLookupHasher> mapCheckTime;
+    // collaterals to look up in the UTXO set on the next Check(), spent by a connected block or loaded from disk
+    std::set<COutPoint> setCollateralCheck;
+    // what the state of every Zeronode depends on as of the last Check(), all of them are checked again when it changes
+    bool fCheckAll;
+    int nCheckedMinPaymentsProto;
+    bool fCheckedListSynced;
+    bool fCheckedSynced;
+    bool fCheckedWatchdogActive;
     // who's asked for the Zeronode list and the last time
     std::map<CNetAddr, int64_t> mAskedUsForZeronodeList;
     // who we asked for the Zeronode list and the last time
@@ -154,6 +205,13 @@ private:
 
     friend class CZeronodeSync;
 
+    void AddToLookups(CZeronode& mn);
+    void RemoveFromLookups(const CZeronode& mn);
+    void RebuildLookups();
+
+    /// Check the Zeronode at the given time, replacing any earlier schedule, 0 unschedules it
+    void ScheduleCheckAt(const COutPoint& outpoint, int64_t nTime);
+
 public:
     // Keep track of all broadcasts I've seen
     std::map<uint256, std::pair<int64_t, CZeronodeBroadcast> > mapSeenZeronodeBroadcast;
@@ -179,7 +237,15 @@ public:
             READWRITE(strVersion);
         }
 
+        std::vector<CZeronode> vZeronodes;
+        if(!ser_action.ForRead()) {
+            vZeronodes.assign(listZeronodes.begin(), listZeronodes.end());
+        }
         READWRITE(vZeronodes);
+        if(ser_action.ForRead()) {
+            listZeronodes.assign(vZeronodes.begin(), vZeronodes.end());
+            RebuildLookups();
+        }
         READWRITE(mAskedUsForZeronodeList);
         READWRITE(mWeAskedForZeronodeList);
         READWRITE(mWeAskedForZeronodeListEntry);
@@ -205,13 +271,25 @@ public:
     void AskForMN(CNode *pnode, const CTxIn &vin);
     void AskForMnb(CNode *pnode, const uint256 &hash);
 
-    /// Check all Zeronodes
+    /// Check the Zeronodes whose state can have changed since the last time
     void Check();
 
+    /// Check the Zeronode on the next Check(), after a change no timer or block tells about
+    void ScheduleCheck(const COutPoint& outpoint);
+
+    /// Look up the collaterals spent by the block on the next Check()
+    void BlockConnected(const CBlock& block);
+
+    /// Time the Zeronode is checked next, 0 if it isn't scheduled
+    int64_t GetScheduledCheckTime(const COutPoint& outpoint);
+
+    /// Whether the collateral of the Zeronode is looked up on the next Check()
+    bool IsCollateralCheckPending(const COutPoint& outpoint);
+
     /// Check all Zeronodes and remove inactive
     void CheckAndRemove();
 
-    /// Clear Zeronode vector
+    /// Clear Zeronode list
     void Clear();
 
     /// Count Zeronodes filtered by nProtocolVersion.
@@ -279,6 +357,9 @@ public:
     }
 
     bool Has(const CTxIn& vin);
+    /// Broadcasts and pings already processed, see mapSeenZeronodeBroadcast and mapSeenZeronodePing
+    bool HasSeenBroadcast(const uint256& hash);
+    bool HasSeenPing(const uint256& hash);
 
     zeronode_info_t GetZeronodeInfo(const CTxIn& vin);
 
@@ -294,8 +375,11 @@ public:
     /// Find a random entry
     CZeronode* FindRandomNotInVec(const std::vector<CTxIn> &vecToExclude, int nProtocolVersion = -1);
 
-    std::vector<CZeronode> GetFullZeronodeVector() { return vZeronodes; }
+    std::vector<CZeronode> GetFullZeronodeVector() { return std::vector<CZeronode>(listZeronodes.begin(), listZeronodes.end()); }
 
+    /// Scores of all the zeronodes for a block hash, computed once until the list changes.
+    /// Rank queries filter them by protocol and state, which can change in the meantime.
+    std::shared_ptr<const CZeronodeScores> GetZeronodeScores(const uint256& blockHash);
     std::vector<std::pair<int, CZeronode> > GetZeronodeRanks(int nBlockHeight = -1, int nMinProtocol=0);
     int GetZeronodeRank(const CTxIn &vin, int nBlockHeight, int nMinProtocol=0, bool fOnlyActive=true);
     CZeronode* GetZeronodeByRank(int nRank, int nBlockHeight, int nMinProtocol=0, bool fOnlyActive=true);
@@ -313,7 +397,7 @@ public:
     void ProcessVerifyBroadcast(CNode* pnode, const CZeronodeVerification& mnv);
 
     /// Return the number of (unique) Zeronodes
-    int size() { return vZeronodes.size(); }
+    int size() { return listZeronodes.size(); }
 
     std::string ToString() const;
 
@@ -325,6 +409,9 @@ public:
 
     void UpdateLastPaid();
 
+    /// Keep the lookup maps in sync when a zeronode in the list changes its key
+    void UpdatedPubKeyZeronode(const CZeronode& mn, const CPubKey& pubKeyZeronodeOld);
+
     void CheckAndRebuildZeronodeIndex();
 
     void AddDirtyGovernanceObjectHash(const uint256& nHash)